@@ -0,0 +1,49 @@
+/***************************************************************************
+ *   Copyright (C) 2024 PCSX-Redux authors                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#include "cdrom/cdriso.h"
+#include "cdrom/chd.h"
+
+bool PCSX::CDRIso::handlechd(const char *isofile) {
+    if (!ChdFile::isChd(m_cdHandle)) return false;
+
+    IO<ChdFile> chd(new ChdFile(m_cdHandle));
+    if (chd->failed()) {
+        PCSX::g_system->printf("failed to open chd image\n");
+        return false;
+    }
+
+    auto &tracks = chd->tracks();
+    if (tracks.size() >= MAXTRACKS) return false;
+
+    m_cdHandle = chd;
+    m_numtracks = 0;
+    for (auto &track : tracks) {
+        unsigned i = ++m_numtracks;
+        m_ti[i].handle.setFile(new SubFile(m_cdHandle, track.start * 2352, track.length * 2352));
+        m_ti[i].type = track.type == ChdFile::Track::Type::AUDIO ? TrackType::CDDA : TrackType::DATA;
+        m_ti[i].cddatype = trackinfo::BIN;
+        m_ti[i].start = IEC60908b::MSF(track.start + 150);
+        m_ti[i].pregap = IEC60908b::MSF(track.pregap);
+        m_ti[i].length = IEC60908b::MSF(track.length);
+    }
+    m_multifile = true;
+
+    return true;
+}
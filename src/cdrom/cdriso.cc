@@ -238,9 +238,11 @@ ssize_t PCSX::CDRIso::cdread_2048(IO<File> f, unsigned int base, void *dest_, in
     return ret;
 }
 
-uint8_t *PCSX::CDRIso::getBuffer() {
+const uint8_t *PCSX::CDRIso::getBuffer() {
     if (m_useCompressed) {
         return m_compr_img->buff_raw[m_compr_img->sector_in_blk] + 12;
+    } else if (m_mappedSector) {
+        return m_mappedSector + 12;
     } else {
         return m_cdbuffer + 12;
     }
@@ -283,7 +285,9 @@ bool PCSX::CDRIso::open(IO<File> isoFile) {
         i = {};
     }
 
-    if (parsecue(reinterpret_cast<const char *>(m_isoPath.string().c_str()))) {
+    if (handlechd(reinterpret_cast<const char *>(m_isoPath.string().c_str()))) {
+        PCSX::g_system->printf("[chd]");
+    } else if (parsecue(reinterpret_cast<const char *>(m_isoPath.string().c_str()))) {
         PCSX::g_system->printf("[+cue]");
     } else if (parsetoc(reinterpret_cast<const char *>(m_isoPath.string().c_str()))) {
         PCSX::g_system->printf("[+toc]");
@@ -312,6 +316,8 @@ bool PCSX::CDRIso::open(IO<File> isoFile) {
         PCSX::g_system->printf("[+sbi]");
     }
 
+    if (!m_useCompressed && !m_ecm_file_detected) tryMapping();
+
     if (!m_ecm_file_detected) {
         // guess whether it is mode1/2048
         if (m_cdHandle->size() % 2048 == 0) {
@@ -358,9 +364,23 @@ bool PCSX::CDRIso::open(IO<File> isoFile) {
     return true;
 }
 
+void PCSX::CDRIso::tryMapping() {
+    // Only plain files on disk can be mapped; anything else already went through some other layer.
+    if (!m_cdHandle.isA<UvFile>()) return;
+    IO<MmapFile> mapped(new MmapFile(m_cdHandle->filename()));
+    if (mapped->failed()) return;
+    mapped->advise(MmapFile::Advice::Sequential);
+    if (g_emulator->settings.get<Emulator::SettingFullCaching>()) mapped->willNeed(0, mapped->size());
+    m_mapped = mapped;
+    m_cdHandle = mapped;
+}
+
 void PCSX::CDRIso::close() {
     m_cdHandle.reset();
     m_subHandle.reset();
+    m_mapped.reset();
+    m_mappedSector = nullptr;
+    m_mappedPrefetch = -1;
 
     if (m_compr_img) {
         free(m_compr_img->index_table);
@@ -453,8 +473,22 @@ bool PCSX::CDRIso::readTrack(const IEC60908b::MSF time) {
         }
     }
 
-    ret = (*this.*m_cdimg_read_func)(m_cdHandle, 0, m_cdbuffer, sector);
-    if (ret < 0) return false;
+    if (useMapping()) {
+        size_t offset = size_t(sector) * IEC60908b::FRAMESIZE_RAW;
+        if ((sector < 0) || ((offset + IEC60908b::FRAMESIZE_RAW) > m_mapped->size())) return false;
+        m_mappedSector = m_mapped->data() + offset;
+        // Have the next window paged in ahead of the drive getting there.
+        int window = sector / PREFETCH_SECTORS;
+        if (window != m_mappedPrefetch) {
+            m_mappedPrefetch = window;
+            m_mapped->willNeed(size_t(window + 1) * PREFETCH_SECTORS * IEC60908b::FRAMESIZE_RAW,
+                               PREFETCH_SECTORS * IEC60908b::FRAMESIZE_RAW);
+        }
+    } else {
+        m_mappedSector = nullptr;
+        ret = (*this.*m_cdimg_read_func)(m_cdHandle, 0, m_cdbuffer, sector);
+        if (ret < 0) return false;
+    }
 
     if (m_subHandle) {
         m_subHandle->rSeek(sector * IEC60908b::SUB_FRAMESIZE, SEEK_SET);
@@ -463,7 +497,12 @@ bool PCSX::CDRIso::readTrack(const IEC60908b::MSF time) {
         if (m_subChanRaw) decodeRawSubData();
     }
 
-    m_ppf.maybePatchSector(m_cdbuffer, time);
+    // The mapping is read-only, so patched sectors need to go through our own buffer.
+    if (m_mappedSector && m_ppf.hasPatch(time)) {
+        memcpy(m_cdbuffer, m_mappedSector, IEC60908b::FRAMESIZE_RAW);
+        m_mappedSector = nullptr;
+    }
+    if (!m_mappedSector) m_ppf.maybePatchSector(m_cdbuffer, time);
 
     return true;
 }
@@ -476,7 +515,20 @@ unsigned PCSX::CDRIso::readSectors(uint32_t lba, void *buffer_, unsigned count)
         return 0;
     }
 
-    for (unsigned i = 0; i < count; i++) {
+    if (useMapping()) {
+        uint32_t limit = std::min(m_ti[1].length.toLBA(), uint32_t(m_mapped->size() / IEC60908b::FRAMESIZE_RAW));
+        if (lba < limit) {
+            actual = std::min(count, limit - lba);
+            memcpy(buffer, m_mapped->data() + size_t(lba) * IEC60908b::FRAMESIZE_RAW,
+                   actual * IEC60908b::FRAMESIZE_RAW);
+            for (unsigned i = 0; i < actual; i++) {
+                m_ppf.maybePatchSector(buffer + i * IEC60908b::FRAMESIZE_RAW, IEC60908b::MSF(lba + i + 150));
+            }
+            lba += actual;
+        }
+    }
+
+    for (unsigned i = actual; i < count; i++) {
         auto ptr = buffer + actual * IEC60908b::FRAMESIZE_RAW;
         if (lba < m_ti[1].length.toLBA()) {
             IEC60908b::MSF time(lba + 150);
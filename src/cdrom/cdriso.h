@@ -26,6 +26,7 @@
 
 #include "cdrom/ppf.h"
 #include "core/psxemulator.h"
+#include "support/mmapfile.h"
 #include "support/uvfile.h"
 #include "supportpsx/iec-60908b.h"
 
@@ -54,7 +55,7 @@ class CDRIso {
     IEC60908b::MSF getPregap(uint8_t track);
     bool readTrack(const IEC60908b::MSF time);
     unsigned readSectors(uint32_t lba, void* buffer, unsigned count);
-    uint8_t* getBuffer();
+    const uint8_t* getBuffer();
     const IEC60908b::Sub* getBufferSub();
     bool readCDDA(const IEC60908b::MSF msf, unsigned char* buffer);
     PPF* getPPF() { return &m_ppf; }
@@ -80,6 +81,11 @@ class CDRIso {
     IO<File> m_cdHandle;
     IO<File> m_subHandle;
 
+    // Raw images get memory mapped, so sector reads are just a pointer into the mapping.
+    IO<MmapFile> m_mapped;
+    const uint8_t* m_mappedSector = nullptr;
+    int m_mappedPrefetch = -1;
+
     bool m_subChanMixed = false;
     bool m_subChanRaw = false;
     bool m_subChanMissing = false;
@@ -145,6 +151,7 @@ class CDRIso {
     };
 
     static constexpr unsigned MAXTRACKS = 100; /* How many tracks can a CD hold? */
+    static constexpr int PREFETCH_SECTORS = 64;
 
     int m_numtracks = 0;
     struct trackinfo m_ti[MAXTRACKS];
@@ -160,6 +167,7 @@ class CDRIso {
     bool parsemds(const char* isofile);
     bool handlepbp(const char* isofile);
     bool handlecbin(const char* isofile);
+    bool handlechd(const char* isofile);
     bool handleecm(const char* isoname, IO<File> cdh, int32_t* accurate_length);
     bool opensubfile(const char* isoname);
     bool opensbifile(const char* isoname);
@@ -172,6 +180,9 @@ class CDRIso {
     ssize_t cdread_2048(IO<File> f, unsigned int base, void* dest, int sector);
     ssize_t ecmDecode(IO<File> f, unsigned int base, void* dest, int sector);
 
+    void tryMapping();
+    bool useMapping() { return m_mapped && (m_cdimg_read_func == &CDRIso::cdread_normal); }
+
     void printTracks();
     void UnloadSBI();
 };
@@ -0,0 +1,863 @@
+/***************************************************************************
+ *   Copyright (C) 2024 PCSX-Redux authors                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#include "cdrom/chd.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <zlib.h>
+
+#include <algorithm>
+
+#include "core/system.h"
+#include "support/flac-decoder.h"
+#include "support/lzma-decoder.h"
+#include "support/mmapfile.h"
+#include "support/table-generator.h"
+#include "support/uvfile.h"
+
+namespace {
+
+constexpr uint32_t fourCC(const char tag[5]) {
+    return (uint32_t(uint8_t(tag[0])) << 24) | (uint32_t(uint8_t(tag[1])) << 16) | (uint32_t(uint8_t(tag[2])) << 8) |
+           uint32_t(uint8_t(tag[3]));
+}
+
+constexpr uint32_t CODEC_ZLIB = fourCC("zlib");
+constexpr uint32_t CODEC_LZMA = fourCC("lzma");
+constexpr uint32_t CODEC_FLAC = fourCC("flac");
+constexpr uint32_t CODEC_CDZL = fourCC("cdzl");
+constexpr uint32_t CODEC_CDLZ = fourCC("cdlz");
+constexpr uint32_t CODEC_CDFL = fourCC("cdfl");
+
+constexpr uint32_t META_TRACK = fourCC("CHTR");
+constexpr uint32_t META_TRACK2 = fourCC("CHT2");
+
+constexpr unsigned HEADER_SIZE = 124;
+constexpr unsigned SECTOR_SIZE = 2352;
+constexpr unsigned SUBCODE_SIZE = 96;
+constexpr unsigned FRAME_SIZE = SECTOR_SIZE + SUBCODE_SIZE;
+constexpr unsigned TRACK_PADDING = 4;
+
+// Hunk types, as stored in the compressed map. The first ones are what
+// the map ends up holding once decoded; the others are only used while
+// decoding it. The last two are ours, for hunks of uncompressed CHDs.
+enum : uint8_t {
+    HUNK_CODEC0 = 0,
+    HUNK_CODEC1 = 1,
+    HUNK_CODEC2 = 2,
+    HUNK_CODEC3 = 3,
+    HUNK_NONE = 4,
+    HUNK_SELF = 5,
+    HUNK_PARENT = 6,
+    HUNK_RLE_SMALL = 7,
+    HUNK_RLE_LARGE = 8,
+    HUNK_SELF_0 = 9,
+    HUNK_SELF_1 = 10,
+    HUNK_PARENT_SELF = 11,
+    HUNK_PARENT_0 = 12,
+    HUNK_PARENT_1 = 13,
+    HUNK_RAW = 14,
+    HUNK_ZERO = 15,
+};
+
+constexpr uint8_t c_syncHeader[12] = {0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00};
+
+uint16_t get16(const uint8_t* p) { return (p[0] << 8) | p[1]; }
+uint32_t get24(const uint8_t* p) { return (p[0] << 16) | (p[1] << 8) | p[2]; }
+uint32_t get32(const uint8_t* p) { return (uint32_t(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3]; }
+uint64_t get48(const uint8_t* p) { return (uint64_t(get16(p)) << 32) | get32(p + 2); }
+uint64_t get64(const uint8_t* p) { return (uint64_t(get32(p)) << 32) | get32(p + 4); }
+
+struct CRC16Generator {
+    static consteval uint16_t calculateValue(std::size_t i) {
+        uint16_t crc = i << 8;
+        for (unsigned j = 0; j < 8; j++) crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        return crc;
+    }
+};
+
+constexpr auto c_crc16 = PCSX::generateTable<256, CRC16Generator>();
+
+uint16_t crc16(const uint8_t* data, size_t size, uint16_t crc = 0xffff) {
+    for (size_t i = 0; i < size; i++) crc = (crc << 8) ^ c_crc16[(crc >> 8) ^ data[i]];
+    return crc;
+}
+
+// Galois field tables for the mode 1 ECC regeneration.
+struct ECCFGenerator {
+    static consteval uint8_t calculateValue(std::size_t i) { return (i << 1) ^ (i & 0x80 ? 0x11d : 0); }
+};
+
+struct ECCBGenerator {
+    static consteval uint8_t calculateValue(std::size_t i) {
+        for (unsigned j = 0; j < 256; j++) {
+            if ((j ^ ECCFGenerator::calculateValue(j)) == i) return j;
+        }
+        return 0;
+    }
+};
+
+constexpr auto c_eccF = PCSX::generateTable<256, ECCFGenerator>();
+constexpr auto c_eccB = PCSX::generateTable<256, ECCBGenerator>();
+
+void computeECCBlock(const uint8_t* src, unsigned majorCount, unsigned minorCount, unsigned majorMult,
+                     unsigned minorInc, uint8_t* dest) {
+    unsigned size = majorCount * minorCount;
+    for (unsigned major = 0; major < majorCount; major++) {
+        unsigned index = (major >> 1) * majorMult + (major & 1);
+        uint8_t eccA = 0;
+        uint8_t eccB = 0;
+        for (unsigned minor = 0; minor < minorCount; minor++) {
+            uint8_t temp = src[index];
+            index += minorInc;
+            if (index >= size) index -= size;
+            eccA ^= temp;
+            eccB ^= temp;
+            eccA = c_eccF[eccA];
+        }
+        eccA = c_eccB[c_eccF[eccA] ^ eccB];
+        dest[major] = eccA;
+        dest[major + majorCount] = eccA ^ eccB;
+    }
+}
+
+// The CD codecs strip the P and Q parity of sectors for which they can be
+// recomputed from the header and data, which is the case for mode 1 sectors.
+void generateECC(uint8_t* sector) {
+    computeECCBlock(sector + 0xc, 86, 24, 2, 86, sector + 0x81c);
+    computeECCBlock(sector + 0xc, 52, 43, 86, 88, sector + 0x8c8);
+}
+
+bool inflateRaw(const uint8_t* src, uint32_t srcSize, uint8_t* dest, uint32_t destSize) {
+    z_stream stream = {};
+    stream.next_in = const_cast<Bytef*>(src);
+    stream.avail_in = srcSize;
+    stream.next_out = dest;
+    stream.avail_out = destSize;
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) return false;
+    int ret = inflate(&stream, Z_FINISH);
+    bool success = (ret == Z_STREAM_END) && (stream.total_out == destSize);
+    inflateEnd(&stream);
+    return success;
+}
+
+class BitStream {
+  public:
+    BitStream(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+    uint32_t peek(unsigned bits) {
+        if (bits == 0) return 0;
+        while (m_bits < bits) {
+            uint64_t byte = m_pos < m_size ? m_data[m_pos] : 0;
+            m_pos++;
+            m_buffer |= byte << (56 - m_bits);
+            m_bits += 8;
+        }
+        return m_buffer >> (64 - bits);
+    }
+    void remove(unsigned bits) {
+        m_buffer <<= bits;
+        m_bits -= bits;
+    }
+    uint32_t read(unsigned bits) {
+        uint32_t ret = peek(bits);
+        remove(bits);
+        return ret;
+    }
+    bool overflow() const { return m_pos - m_bits / 8 > m_size; }
+
+  private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_pos = 0;
+    uint64_t m_buffer = 0;
+    unsigned m_bits = 0;
+};
+
+// The tiny canonical huffman decoder used for the map's hunk types.
+class Huffman {
+  public:
+    bool importTreeRLE(BitStream& bits) {
+        unsigned current = 0;
+        while (current < CODES) {
+            unsigned length = bits.read(4);
+            if (length != 1) {
+                m_lengths[current++] = length;
+                continue;
+            }
+            length = bits.read(4);
+            if (length == 1) {
+                m_lengths[current++] = length;
+                continue;
+            }
+            unsigned repeat = bits.read(4) + 3;
+            while (repeat--) {
+                if (current >= CODES) return false;
+                m_lengths[current++] = length;
+            }
+        }
+        return assignCodes() && !bits.overflow();
+    }
+    uint8_t decode(BitStream& bits) {
+        uint8_t entry = m_lookup[bits.peek(MAXBITS)];
+        bits.remove(entry & 0xf);
+        return entry >> 4;
+    }
+
+  private:
+    bool assignCodes() {
+        unsigned histogram[MAXBITS + 1] = {};
+        for (auto length : m_lengths) {
+            if (length > MAXBITS) return false;
+            histogram[length]++;
+        }
+        unsigned start = 0;
+        for (unsigned length = MAXBITS; length > 0; length--) {
+            unsigned next = (start + histogram[length]) >> 1;
+            if ((length != 1) && (next * 2 != (start + histogram[length]))) return false;
+            histogram[length] = start;
+            start = next;
+        }
+        for (unsigned code = 0; code < CODES; code++) {
+            unsigned length = m_lengths[code];
+            if (length == 0) continue;
+            unsigned bits = histogram[length]++;
+            unsigned shift = MAXBITS - length;
+            for (unsigned i = bits << shift; i < ((bits + 1) << shift); i++) m_lookup[i] = (code << 4) | length;
+        }
+        return true;
+    }
+
+    static constexpr unsigned CODES = 16;
+    static constexpr unsigned MAXBITS = 8;
+    uint8_t m_lengths[CODES] = {};
+    uint8_t m_lookup[1 << MAXBITS] = {};
+};
+
+}  // namespace
+
+PCSX::ChdFile::ChdFile(IO<File> file) : File(RO_SEEKABLE), m_file(file), m_filename(file->filename()) {
+    if (m_file.isA<UvFile>()) {
+        IO<MmapFile> mapped(new MmapFile(m_filename));
+        if (!mapped->failed()) {
+            m_file = mapped;
+            m_mappedData = mapped->data();
+            m_mappedSize = mapped->size();
+        }
+    }
+    if (!parseHeader() || !readMap() || !readMetadata()) return;
+    m_failed = false;
+
+    unsigned workers = std::thread::hardware_concurrency();
+    workers = std::clamp(workers > 1 ? workers - 1 : 1, 1u, MAX_WORKERS);
+    for (unsigned i = 0; i < workers; i++) m_workers.emplace_back([this]() { worker(); });
+}
+
+PCSX::ChdFile::~ChdFile() { stopWorkers(); }
+
+void PCSX::ChdFile::closeInternal() {
+    stopWorkers();
+    m_mappedData = nullptr;
+    m_mappedSize = 0;
+    m_file.reset();
+}
+
+void PCSX::ChdFile::stopWorkers() {
+    {
+        std::unique_lock<std::mutex> lock(m_cacheMutex);
+        m_exiting = true;
+    }
+    m_workCV.notify_all();
+    for (auto& worker : m_workers) worker.join();
+    m_workers.clear();
+}
+
+bool PCSX::ChdFile::isChd(IO<File> file) {
+    char magic[8];
+    if (file->readAt(magic, sizeof(magic), 0) != sizeof(magic)) return false;
+    return memcmp(magic, "MComprHD", sizeof(magic)) == 0;
+}
+
+ssize_t PCSX::ChdFile::readFile(void* dest, size_t size, size_t ptr) {
+    if (m_mappedData) {
+        if (ptr >= m_mappedSize) return -1;
+        size = std::min(m_mappedSize - ptr, size);
+        memcpy(dest, m_mappedData + ptr, size);
+        return size;
+    }
+    std::unique_lock<std::mutex> lock(m_fileMutex);
+    return m_file->readAt(dest, size, ptr);
+}
+
+bool PCSX::ChdFile::parseHeader() {
+    uint8_t header[HEADER_SIZE];
+    if (readFile(header, HEADER_SIZE, 0) != HEADER_SIZE) return false;
+    if (memcmp(header, "MComprHD", 8) != 0) return false;
+    uint32_t length = get32(header + 8);
+    uint32_t version = get32(header + 12);
+    if ((version != 5) || (length != HEADER_SIZE)) {
+        g_system->printf("CHD version %u isn't supported\n", version);
+        return false;
+    }
+    for (unsigned i = 0; i < 4; i++) {
+        uint32_t codec = m_compressors[i] = get32(header + 16 + i * 4);
+        switch (codec) {
+            case 0:
+            case CODEC_ZLIB:
+            case CODEC_LZMA:
+            case CODEC_FLAC:
+            case CODEC_CDZL:
+            case CODEC_CDLZ:
+            case CODEC_CDFL:
+                break;
+            default:
+                g_system->printf("CHD codec '%c%c%c%c' isn't supported\n", char(codec >> 24), char(codec >> 16),
+                                 char(codec >> 8), char(codec));
+                return false;
+        }
+    }
+    m_logicalBytes = get64(header + 32);
+    m_mapOffset = get64(header + 40);
+    m_metaOffset = get64(header + 48);
+    m_hunkBytes = get32(header + 56);
+    m_unitBytes = get32(header + 60);
+    for (unsigned i = 104; i < 124; i++) {
+        if (header[i] != 0) {
+            g_system->printf("CHD images with a parent aren't supported\n");
+            return false;
+        }
+    }
+    if ((m_unitBytes != FRAME_SIZE) || (m_hunkBytes == 0) || ((m_hunkBytes % m_unitBytes) != 0)) {
+        g_system->printf("CHD image isn't a CD image\n");
+        return false;
+    }
+    uint64_t hunkCount = (m_logicalBytes + m_hunkBytes - 1) / m_hunkBytes;
+    if (hunkCount > 0xffffffff) return false;
+    m_hunkCount = hunkCount;
+    return true;
+}
+
+bool PCSX::ChdFile::readMap() {
+    m_map.resize(m_hunkCount);
+
+    if (m_compressors[0] == 0) {
+        std::vector<uint8_t> raw(size_t(m_hunkCount) * 4);
+        if (readFile(raw.data(), raw.size(), m_mapOffset) != raw.size()) return false;
+        for (uint32_t hunk = 0; hunk < m_hunkCount; hunk++) {
+            uint64_t block = get32(raw.data() + hunk * 4);
+            m_map[hunk] = {block == 0 ? HUNK_ZERO : HUNK_RAW, m_hunkBytes, block * m_hunkBytes, 0};
+        }
+        return true;
+    }
+
+    uint8_t header[16];
+    if (readFile(header, sizeof(header), m_mapOffset) != sizeof(header)) return false;
+    uint32_t mapBytes = get32(header);
+    uint64_t offset = get48(header + 4);
+    uint16_t mapCRC = get16(header + 10);
+    unsigned lengthBits = header[12];
+    unsigned selfBits = header[13];
+    unsigned parentBits = header[14];
+    if ((lengthBits > 32) || (selfBits > 32) || (parentBits > 32)) return false;
+
+    std::vector<uint8_t> compressed(mapBytes);
+    if (readFile(compressed.data(), mapBytes, m_mapOffset + sizeof(header)) != mapBytes) return false;
+    BitStream bits(compressed.data(), mapBytes);
+    Huffman huffman;
+    if (!huffman.importTreeRLE(bits)) {
+        g_system->printf("CHD map is corrupted\n");
+        return false;
+    }
+
+    uint8_t last = 0;
+    unsigned repeat = 0;
+    for (auto& entry : m_map) {
+        if (repeat > 0) {
+            entry.type = last;
+            repeat--;
+            continue;
+        }
+        uint8_t type = huffman.decode(bits);
+        if (type == HUNK_RLE_SMALL) {
+            entry.type = last;
+            repeat = 2 + huffman.decode(bits);
+        } else if (type == HUNK_RLE_LARGE) {
+            entry.type = last;
+            repeat = 2 + 16 + (huffman.decode(bits) << 4);
+            repeat += huffman.decode(bits);
+        } else {
+            entry.type = last = type;
+        }
+    }
+
+    uint64_t lastSelf = 0;
+    uint64_t lastParent = 0;
+    uint16_t crc = 0xffff;
+    for (uint32_t hunk = 0; hunk < m_hunkCount; hunk++) {
+        auto& entry = m_map[hunk];
+        entry.offset = offset;
+        entry.length = 0;
+        entry.crc = 0;
+        switch (entry.type) {
+            case HUNK_CODEC0:
+            case HUNK_CODEC1:
+            case HUNK_CODEC2:
+            case HUNK_CODEC3:
+                entry.length = bits.read(lengthBits);
+                offset += entry.length;
+                entry.crc = bits.read(16);
+                break;
+            case HUNK_NONE:
+                entry.length = m_hunkBytes;
+                offset += entry.length;
+                entry.crc = bits.read(16);
+                break;
+            case HUNK_SELF:
+                entry.offset = lastSelf = bits.read(selfBits);
+                break;
+            case HUNK_PARENT:
+                entry.offset = lastParent = bits.read(parentBits);
+                break;
+            case HUNK_SELF_1:
+                lastSelf++;
+                [[fallthrough]];
+            case HUNK_SELF_0:
+                entry.type = HUNK_SELF;
+                entry.offset = lastSelf;
+                break;
+            case HUNK_PARENT_SELF:
+                entry.type = HUNK_PARENT;
+                entry.offset = lastParent = (uint64_t(hunk) * m_hunkBytes) / m_unitBytes;
+                break;
+            case HUNK_PARENT_1:
+                lastParent += m_hunkBytes / m_unitBytes;
+                [[fallthrough]];
+            case HUNK_PARENT_0:
+                entry.type = HUNK_PARENT;
+                entry.offset = lastParent;
+                break;
+            default:
+                g_system->printf("CHD map is corrupted\n");
+                return false;
+        }
+        uint8_t raw[12] = {
+            entry.type,
+            uint8_t(entry.length >> 16),
+            uint8_t(entry.length >> 8),
+            uint8_t(entry.length),
+            uint8_t(entry.offset >> 40),
+            uint8_t(entry.offset >> 32),
+            uint8_t(entry.offset >> 24),
+            uint8_t(entry.offset >> 16),
+            uint8_t(entry.offset >> 8),
+            uint8_t(entry.offset),
+            uint8_t(entry.crc >> 8),
+            uint8_t(entry.crc),
+        };
+        crc = crc16(raw, sizeof(raw), crc);
+    }
+    if (bits.overflow() || (crc != mapCRC)) {
+        g_system->printf("CHD map is corrupted\n");
+        return false;
+    }
+    return true;
+}
+
+bool PCSX::ChdFile::readMetadata() {
+    struct RawTrack {
+        unsigned number;
+        Track::Type type;
+        uint32_t frames;
+        uint32_t pregap;
+        bool pregapStored;
+        uint32_t postgap;
+    };
+    std::vector<RawTrack> rawTracks;
+
+    uint64_t offset = m_metaOffset;
+    // Guard against looping chains in corrupted files.
+    unsigned entries = 0;
+    while ((offset != 0) && (entries++ < 1024)) {
+        uint8_t header[16];
+        if (readFile(header, sizeof(header), offset) != sizeof(header)) return false;
+        uint32_t tag = get32(header);
+        uint32_t length = get24(header + 5);
+        uint64_t next = get64(header + 8);
+        if (((tag == META_TRACK) || (tag == META_TRACK2)) && (length < 256)) {
+            char text[256];
+            if (readFile(text, length, offset + sizeof(header)) != length) return false;
+            text[length] = 0;
+            char type[32] = "";
+            char subtype[32] = "";
+            char pgtype[32] = "";
+            char pgsub[32] = "";
+            int number = 0, frames = 0, pregap = 0, postgap = 0;
+            bool parsed;
+            if (tag == META_TRACK2) {
+                parsed = sscanf(text, "TRACK:%d TYPE:%31s SUBTYPE:%31s FRAMES:%d PREGAP:%d PGTYPE:%31s PGSUB:%31s POSTGAP:%d",
+                                &number, type, subtype, &frames, &pregap, pgtype, pgsub, &postgap) == 8;
+            } else {
+                parsed = sscanf(text, "TRACK:%d TYPE:%31s SUBTYPE:%31s FRAMES:%d", &number, type, subtype, &frames) == 4;
+            }
+            if (!parsed || (number < 1) || (number > 99) || (frames < 0) || (pregap < 0) || (postgap < 0)) {
+                g_system->printf("CHD track metadata is corrupted\n");
+                return false;
+            }
+            RawTrack track;
+            track.number = number;
+            if (strcmp(type, "MODE1_RAW") == 0) {
+                track.type = Track::Type::MODE1;
+            } else if (strcmp(type, "MODE2_RAW") == 0) {
+                track.type = Track::Type::MODE2;
+            } else if (strcmp(type, "AUDIO") == 0) {
+                track.type = Track::Type::AUDIO;
+            } else {
+                g_system->printf("CHD track type %s isn't supported\n", type);
+                return false;
+            }
+            track.frames = frames;
+            track.pregap = pregap;
+            // A 'V' prefix means the pregap's sectors are part of the track's data.
+            track.pregapStored = pgtype[0] == 'V';
+            track.postgap = postgap;
+            if (track.pregapStored && (track.pregap > track.frames)) return false;
+            rawTracks.push_back(track);
+        }
+        offset = next;
+    }
+    if (rawTracks.empty()) {
+        g_system->printf("CHD image has no track information\n");
+        return false;
+    }
+    std::sort(rawTracks.begin(), rawTracks.end(),
+              [](const RawTrack& a, const RawTrack& b) { return a.number < b.number; });
+
+    // Lay out the tracks the way the disc would, using the CHD's own logical
+    // frame numbering first, then rebasing it on track 1's index 1.
+    uint64_t chdFrame = 0;
+    uint32_t logical = 0;
+    for (auto& raw : rawTracks) {
+        if (!raw.pregapStored && raw.pregap) {
+            m_segments.push_back({logical, raw.pregap, -1, false});
+            logical += raw.pregap;
+        }
+        bool audio = raw.type == Track::Type::AUDIO;
+        if (raw.frames) m_segments.push_back({logical, raw.frames, int64_t(chdFrame), audio});
+        uint32_t storedPregap = raw.pregapStored ? raw.pregap : 0;
+        m_tracks.push_back({raw.type, raw.number, logical + storedPregap, raw.pregap, raw.frames - storedPregap});
+        logical += raw.frames;
+        if (raw.postgap) {
+            m_segments.push_back({logical, raw.postgap, -1, false});
+            logical += raw.postgap;
+        }
+        chdFrame += (raw.frames + TRACK_PADDING - 1) / TRACK_PADDING * TRACK_PADDING;
+    }
+    if (chdFrame * m_unitBytes > uint64_t(m_hunkCount) * m_hunkBytes) {
+        g_system->printf("CHD track metadata doesn't match its contents\n");
+        return false;
+    }
+
+    uint32_t base = m_tracks.front().start;
+    std::vector<Segment> segments;
+    for (auto segment : m_segments) {
+        if (segment.start + segment.count <= base) continue;
+        if (segment.start < base) {
+            uint32_t skip = base - segment.start;
+            segment.count -= skip;
+            if (segment.chdFrame >= 0) segment.chdFrame += skip;
+            segment.start = base;
+        }
+        segment.start -= base;
+        segments.push_back(segment);
+    }
+    m_segments = std::move(segments);
+    for (auto& track : m_tracks) track.start -= base;
+    m_size = size_t(logical - base) * SECTOR_SIZE;
+    return true;
+}
+
+ssize_t PCSX::ChdFile::rSeek(ssize_t pos, int wheel) {
+    switch (wheel) {
+        case SEEK_SET:
+            m_ptrR = pos;
+            break;
+        case SEEK_END:
+            m_ptrR = m_size - pos;
+            break;
+        case SEEK_CUR:
+            m_ptrR += pos;
+            break;
+    }
+    m_ptrR = std::max(std::min(m_ptrR, m_size), size_t(0));
+    return m_ptrR;
+}
+
+ssize_t PCSX::ChdFile::read(void* dest, size_t size) {
+    ssize_t ret = readAt(dest, size, m_ptrR);
+    if (ret > 0) m_ptrR += ret;
+    return ret;
+}
+
+ssize_t PCSX::ChdFile::readAt(void* dest_, size_t size, size_t ptr) {
+    if (m_failed || (ptr >= m_size)) return -1;
+    size = std::min(m_size - ptr, size);
+    uint8_t* dest = reinterpret_cast<uint8_t*>(dest_);
+    uint8_t sector[SECTOR_SIZE];
+    size_t done = 0;
+    while (done < size) {
+        uint32_t lba = ptr / SECTOR_SIZE;
+        size_t offset = ptr % SECTOR_SIZE;
+        size_t count = std::min(SECTOR_SIZE - offset, size - done);
+        // Full sectors go straight to the caller's buffer.
+        bool direct = (offset == 0) && (count == SECTOR_SIZE);
+        if (!readSector(lba, direct ? dest : sector)) return done ? done : -1;
+        if (!direct) memcpy(dest, sector + offset, count);
+        dest += count;
+        ptr += count;
+        done += count;
+    }
+    return done;
+}
+
+bool PCSX::ChdFile::readSector(uint32_t sector, uint8_t* dest) {
+    auto segment = std::upper_bound(m_segments.begin(), m_segments.end(), sector,
+                                    [](uint32_t sector, const Segment& segment) { return sector < segment.start; });
+    if (segment == m_segments.begin()) {
+        memset(dest, 0, SECTOR_SIZE);
+        return true;
+    }
+    --segment;
+    if ((sector >= segment->start + segment->count) || (segment->chdFrame < 0)) {
+        memset(dest, 0, SECTOR_SIZE);
+        return true;
+    }
+    uint64_t position = (segment->chdFrame + sector - segment->start) * m_unitBytes;
+    if (!copyFromHunk(position / m_hunkBytes, position % m_hunkBytes, dest, SECTOR_SIZE)) return false;
+    // CHDs store audio big endian.
+    if (segment->audio) {
+        for (unsigned i = 0; i < SECTOR_SIZE; i += 2) std::swap(dest[i], dest[i + 1]);
+    }
+    return true;
+}
+
+PCSX::ChdFile::CacheSlot* PCSX::ChdFile::findSlot(uint32_t hunk) {
+    for (auto& slot : m_cache) {
+        if ((slot.state != CacheSlot::State::EMPTY) && (slot.hunk == hunk)) return &slot;
+    }
+    return nullptr;
+}
+
+PCSX::ChdFile::CacheSlot* PCSX::ChdFile::claimSlot(uint32_t hunk) {
+    CacheSlot* victim = nullptr;
+    for (auto& slot : m_cache) {
+        if (slot.state == CacheSlot::State::EMPTY) {
+            victim = &slot;
+            break;
+        }
+        if (slot.state == CacheSlot::State::PENDING) continue;
+        if (!victim || (slot.lastUse < victim->lastUse)) victim = &slot;
+    }
+    if (!victim) return nullptr;
+    victim->state = CacheSlot::State::PENDING;
+    victim->hunk = hunk;
+    victim->data.resize(m_hunkBytes);
+    return victim;
+}
+
+// Decompresses a claimed slot with the lock released, so readers and the
+// other workers can carry on with whatever is already in the cache.
+void PCSX::ChdFile::fillSlot(std::unique_lock<std::mutex>& lock, CacheSlot* slot) {
+    uint32_t hunk = slot->hunk;
+    uint8_t* data = slot->data.data();
+    lock.unlock();
+    bool success = decodeHunk(hunk, data);
+    lock.lock();
+    slot->state = success ? CacheSlot::State::READY : CacheSlot::State::FAILED;
+    slot->lastUse = ++m_clock;
+    m_cacheCV.notify_all();
+}
+
+bool PCSX::ChdFile::copyFromHunk(uint32_t hunk, uint32_t offset, uint8_t* dest, uint32_t size) {
+    std::unique_lock<std::mutex> lock(m_cacheMutex);
+    while (true) {
+        CacheSlot* slot = findSlot(hunk);
+        if (!slot) {
+            slot = claimSlot(hunk);
+            if (!slot) {
+                m_cacheCV.wait(lock);
+                continue;
+            }
+            fillSlot(lock, slot);
+        } else if (slot->state == CacheSlot::State::PENDING) {
+            m_cacheCV.wait(lock);
+            continue;
+        }
+        if (slot->state == CacheSlot::State::FAILED) {
+            slot->state = CacheSlot::State::EMPTY;
+            g_system->printf("CHD hunk %u is corrupted\n", hunk);
+            return false;
+        }
+        memcpy(dest, slot->data.data() + offset, size);
+        slot->lastUse = ++m_clock;
+        break;
+    }
+    prefetch(hunk);
+    return true;
+}
+
+void PCSX::ChdFile::prefetch(uint32_t hunk) {
+    if (m_workers.empty()) return;
+    bool queued = false;
+    for (uint32_t next = hunk + 1; (next <= hunk + PREFETCH_HUNKS) && (next < m_hunkCount); next++) {
+        if (findSlot(next)) continue;
+        if (std::find(m_queue.begin(), m_queue.end(), next) != m_queue.end()) continue;
+        m_queue.push_back(next);
+        queued = true;
+    }
+    // Stale requests from an earlier position aren't worth decoding anymore.
+    while (m_queue.size() > PREFETCH_HUNKS * 2) m_queue.pop_front();
+    if (queued) m_workCV.notify_all();
+}
+
+void PCSX::ChdFile::worker() {
+    std::unique_lock<std::mutex> lock(m_cacheMutex);
+    while (true) {
+        m_workCV.wait(lock, [this]() { return m_exiting || !m_queue.empty(); });
+        if (m_exiting) return;
+        uint32_t hunk = m_queue.front();
+        m_queue.pop_front();
+        if (findSlot(hunk)) continue;
+        CacheSlot* slot = claimSlot(hunk);
+        if (slot) fillSlot(lock, slot);
+    }
+}
+
+bool PCSX::ChdFile::decodeHunk(uint32_t hunk, uint8_t* dest, unsigned depth) {
+    if (hunk >= m_hunkCount) return false;
+    const MapEntry& entry = m_map[hunk];
+    switch (entry.type) {
+        case HUNK_CODEC0:
+        case HUNK_CODEC1:
+        case HUNK_CODEC2:
+        case HUNK_CODEC3: {
+            uint32_t codec = m_compressors[entry.type];
+            if (codec == 0) return false;
+            if (m_mappedData) {
+                if ((entry.offset > m_mappedSize) || (entry.length > m_mappedSize - entry.offset)) return false;
+                if (!decompress(codec, m_mappedData + entry.offset, entry.length, dest, m_hunkBytes)) return false;
+            } else {
+                std::vector<uint8_t> compressed(entry.length);
+                if (readFile(compressed.data(), entry.length, entry.offset) != entry.length) return false;
+                if (!decompress(codec, compressed.data(), entry.length, dest, m_hunkBytes)) return false;
+            }
+            break;
+        }
+        case HUNK_NONE:
+        case HUNK_RAW:
+            if (readFile(dest, m_hunkBytes, entry.offset) != m_hunkBytes) return false;
+            if (entry.type == HUNK_RAW) return true;
+            break;
+        case HUNK_ZERO:
+            memset(dest, 0, m_hunkBytes);
+            return true;
+        case HUNK_SELF:
+            // Self references always point to a hunk holding actual data.
+            if (depth > 0) return false;
+            return decodeHunk(entry.offset, dest, depth + 1);
+        default:
+            return false;
+    }
+    return crc16(dest, m_hunkBytes) == entry.crc;
+}
+
+bool PCSX::ChdFile::decompress(uint32_t codec, const uint8_t* src, uint32_t srcSize, uint8_t* dest,
+                               uint32_t destSize) {
+    switch (codec) {
+        case CODEC_ZLIB:
+            return inflateRaw(src, srcSize, dest, destSize);
+        case CODEC_LZMA:
+            return LZMA::decode(src, srcSize, dest, destSize) >= 0;
+        case CODEC_FLAC: {
+            // The first byte tells the endianness of the samples.
+            if ((srcSize < 1) || ((src[0] != 'L') && (src[0] != 'B'))) return false;
+            bool bigEndian = src[0] == 'B';
+            std::vector<int16_t> samples(destSize / 2);
+            if (FLAC::decode(src + 1, srcSize - 1, samples.data(), destSize / 4) < 0) return false;
+            for (size_t i = 0; i < samples.size(); i++) {
+                uint16_t sample = samples[i];
+                dest[i * 2 + 0] = bigEndian ? sample >> 8 : sample;
+                dest[i * 2 + 1] = bigEndian ? sample : sample >> 8;
+            }
+            return true;
+        }
+        case CODEC_CDZL:
+        case CODEC_CDLZ:
+        case CODEC_CDFL:
+            return decompressCD(codec, src, srcSize, dest, destSize);
+    }
+    return false;
+}
+
+// The CD codecs compress the sector data and the subcode data separately,
+// the latter always with deflate, and store them back to back.
+bool PCSX::ChdFile::decompressCD(uint32_t codec, const uint8_t* src, uint32_t srcSize, uint8_t* dest,
+                                 uint32_t destSize) {
+    uint32_t frames = destSize / FRAME_SIZE;
+    std::vector<uint8_t> sectors(frames * SECTOR_SIZE);
+    std::vector<uint8_t> subcode(frames * SUBCODE_SIZE);
+    const uint8_t* ecc = nullptr;
+
+    if (codec == CODEC_CDFL) {
+        std::vector<int16_t> samples(frames * SECTOR_SIZE / 2);
+        ssize_t used = FLAC::decode(src, srcSize, samples.data(), frames * SECTOR_SIZE / 4);
+        if (used < 0) return false;
+        for (size_t i = 0; i < samples.size(); i++) {
+            uint16_t sample = samples[i];
+            sectors[i * 2 + 0] = sample >> 8;
+            sectors[i * 2 + 1] = sample;
+        }
+        if (!inflateRaw(src + used, srcSize - used, subcode.data(), subcode.size())) return false;
+    } else {
+        uint32_t eccBytes = (frames + 7) / 8;
+        uint32_t lengthBytes = destSize < 65536 ? 2 : 3;
+        uint32_t headerBytes = eccBytes + lengthBytes;
+        if (srcSize < headerBytes) return false;
+        uint32_t baseLength = get16(src + eccBytes);
+        if (lengthBytes > 2) baseLength = (baseLength << 8) | src[eccBytes + 2];
+        if (baseLength > srcSize - headerBytes) return false;
+        ecc = src;
+        const uint8_t* base = src + headerBytes;
+        bool success = codec == CODEC_CDZL ? inflateRaw(base, baseLength, sectors.data(), sectors.size())
+                                           : LZMA::decode(base, baseLength, sectors.data(), sectors.size()) >= 0;
+        if (!success) return false;
+        uint32_t used = headerBytes + baseLength;
+        if (!inflateRaw(src + used, srcSize - used, subcode.data(), subcode.size())) return false;
+    }
+
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        uint8_t* sector = dest + frame * FRAME_SIZE;
+        memcpy(sector, sectors.data() + frame * SECTOR_SIZE, SECTOR_SIZE);
+        memcpy(sector + SECTOR_SIZE, subcode.data() + frame * SUBCODE_SIZE, SUBCODE_SIZE);
+        if (ecc && (ecc[frame / 8] & (1 << (frame % 8)))) {
+            memcpy(sector, c_syncHeader, sizeof(c_syncHeader));
+            generateECC(sector);
+        }
+    }
+    return true;
+}
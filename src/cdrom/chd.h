@@ -0,0 +1,147 @@
+/***************************************************************************
+ *   Copyright (C) 2024 PCSX-Redux authors                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "support/file.h"
+
+namespace PCSX {
+
+// Read-only view of a CHD (MAME's "compressed hunks of data") CD image, as
+// a flat raw image of 2352 bytes sectors starting at the first track's
+// index 1, the same way a single bin file from a cue sheet would look.
+// Audio sectors are presented little endian, gaps that aren't stored in
+// the CHD read back as zeroes, and subchannel data is dropped.
+//
+// Hunks are decompressed on demand into a small LRU cache, and a few worker
+// threads decompress the hunks following the last one read ahead of time,
+// so that sequential reads rarely have to wait for the decompressor.
+class ChdFile : public File {
+  public:
+    struct Track {
+        enum class Type { MODE1, MODE2, AUDIO } type;
+        unsigned number;
+        // In sectors, relative to the start of the flat image.
+        uint32_t start;
+        uint32_t pregap;
+        uint32_t length;
+    };
+
+    ChdFile(IO<File> file);
+    virtual ~ChdFile();
+
+    virtual ssize_t rSeek(ssize_t pos, int wheel) final override;
+    virtual ssize_t rTell() final override { return m_ptrR; }
+    virtual size_t size() final override { return m_size; }
+    virtual ssize_t read(void* dest, size_t size) final override;
+    virtual ssize_t readAt(void* dest, size_t size, size_t ptr) final override;
+    virtual bool eof() final override { return m_ptrR == m_size; }
+    virtual std::filesystem::path filename() final override { return m_filename; }
+    virtual bool failed() final override { return m_failed; }
+
+    const std::vector<Track>& tracks() const { return m_tracks; }
+
+    static bool isChd(IO<File> file);
+
+  private:
+    virtual void closeInternal() final override;
+
+    struct MapEntry {
+        uint8_t type;
+        uint32_t length;
+        uint64_t offset;
+        uint16_t crc;
+    };
+    // A range of sectors in the flat image; chdFrame is -1 for gaps which
+    // aren't stored in the CHD.
+    struct Segment {
+        uint32_t start;
+        uint32_t count;
+        int64_t chdFrame;
+        bool audio;
+    };
+    struct CacheSlot {
+        enum class State { EMPTY, PENDING, READY, FAILED } state = State::EMPTY;
+        uint32_t hunk = 0;
+        uint64_t lastUse = 0;
+        std::vector<uint8_t> data;
+    };
+
+    bool parseHeader();
+    bool readMap();
+    bool readMetadata();
+    bool readSector(uint32_t sector, uint8_t* dest);
+    bool copyFromHunk(uint32_t hunk, uint32_t offset, uint8_t* dest, uint32_t size);
+    CacheSlot* findSlot(uint32_t hunk);
+    CacheSlot* claimSlot(uint32_t hunk);
+    void fillSlot(std::unique_lock<std::mutex>& lock, CacheSlot* slot);
+    void prefetch(uint32_t hunk);
+    void worker();
+    bool decodeHunk(uint32_t hunk, uint8_t* dest, unsigned depth = 0);
+    bool decompress(uint32_t codec, const uint8_t* src, uint32_t srcSize, uint8_t* dest, uint32_t destSize);
+    bool decompressCD(uint32_t codec, const uint8_t* src, uint32_t srcSize, uint8_t* dest, uint32_t destSize);
+    ssize_t readFile(void* dest, size_t size, size_t ptr);
+    void stopWorkers();
+
+    static constexpr unsigned CACHE_SLOTS = 64;
+    static constexpr unsigned PREFETCH_HUNKS = 4;
+    static constexpr unsigned MAX_WORKERS = 3;
+
+    IO<File> m_file;
+    std::filesystem::path m_filename;
+    // Set when the underlying file could be memory mapped, in which case
+    // compressed hunks are decoded straight out of the mapping.
+    const uint8_t* m_mappedData = nullptr;
+    size_t m_mappedSize = 0;
+    std::mutex m_fileMutex;
+    bool m_failed = true;
+    size_t m_size = 0;
+    size_t m_ptrR = 0;
+
+    uint32_t m_compressors[4] = {};
+    uint64_t m_logicalBytes = 0;
+    uint64_t m_mapOffset = 0;
+    uint64_t m_metaOffset = 0;
+    uint32_t m_hunkBytes = 0;
+    uint32_t m_unitBytes = 0;
+    uint32_t m_hunkCount = 0;
+    std::vector<MapEntry> m_map;
+    std::vector<Track> m_tracks;
+    std::vector<Segment> m_segments;
+
+    std::mutex m_cacheMutex;
+    std::condition_variable m_cacheCV;
+    std::condition_variable m_workCV;
+    CacheSlot m_cache[CACHE_SLOTS];
+    uint64_t m_clock = 0;
+    std::deque<uint32_t> m_queue;
+    std::vector<std::thread> m_workers;
+    bool m_exiting = false;
+};
+
+}  // namespace PCSX
@@ -19,9 +19,38 @@
 
 #include "cdrom/iso9660-builder.h"
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
 
-#include "iec-60908b/edcecc.h"
+#include "support/mmapfile.h"
+
+namespace {
+
+constexpr uint8_t c_sync[12] = {0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00};
+
+// Work unit size when writing a layout; large enough to amortize the
+// source reads and output writes, small enough to balance across threads.
+constexpr uint32_t c_chunkSectors = 256;
+
+size_t payloadSize(PCSX::SectorMode mode) {
+    switch (mode) {
+        case PCSX::SectorMode::RAW:
+            return PCSX::IEC60908b::FRAMESIZE_RAW;
+        case PCSX::SectorMode::M2_RAW:
+            return 2336;
+        case PCSX::SectorMode::M2_FORM1:
+            return 2048;
+        case PCSX::SectorMode::M2_FORM2:
+            return 2324;
+        default:
+            return 0;
+    }
+}
+
+}  // namespace
 
 void PCSX::ISO9660Builder::writeLicense(IO<File> licenseFile) {
     if (licenseFile && !licenseFile->failed()) {
@@ -50,59 +79,176 @@ void PCSX::ISO9660Builder::writeLicense(IO<File> licenseFile) {
     }
 }
 
-PCSX::IEC60908b::MSF PCSX::ISO9660Builder::writeSectorAt(const uint8_t* sectorData, PCSX::IEC60908b::MSF msf,
-                                                         SectorMode mode) {
-    if (failed()) return {0, 0, 0};
-    Slice slice;
-    uint8_t* ptr;
-    static const uint8_t c_sync[12] = {0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00};
-    uint32_t lba = msf.toLBA() - 150;
+bool PCSX::ISO9660Builder::buildSector(uint8_t* dest, const uint8_t* sectorData, IEC60908b::MSF msf,
+                                       SectorMode mode) {
     switch (mode) {
         case SectorMode::RAW:
-            m_out->writeAt(sectorData, IEC60908b::FRAMESIZE_RAW, lba * IEC60908b::FRAMESIZE_RAW);
-            break;
+            memcpy(dest, sectorData, IEC60908b::FRAMESIZE_RAW);
+            return true;
         case SectorMode::M2_RAW:
-            slice.resize(IEC60908b::FRAMESIZE_RAW);
-            ptr = slice.mutableData<uint8_t>();
-            memcpy(ptr, c_sync, sizeof(c_sync));
-            msf.toBCD(ptr + 12);
-            ptr[15] = 2;
-            memcpy(ptr + 16, sectorData, 2336);
-            m_out->writeAt(std::move(slice), lba * IEC60908b::FRAMESIZE_RAW);
-            break;
+            memcpy(dest, c_sync, sizeof(c_sync));
+            msf.toBCD(dest + 12);
+            dest[15] = 2;
+            memcpy(dest + 16, sectorData, 2336);
+            return true;
         case SectorMode::M2_FORM1:
-            slice.resize(IEC60908b::FRAMESIZE_RAW);
-            ptr = slice.mutableData<uint8_t>();
-            memcpy(ptr, c_sync, sizeof(c_sync));
-            msf.toBCD(ptr + 12);
-            ptr[15] = 2;
-            ptr[16] = ptr[20] = 0;
-            ptr[17] = ptr[21] = 0;
-            ptr[18] = ptr[22] = 8;
-            ptr[19] = ptr[23] = 0;
-            memcpy(ptr + 24, sectorData, 2048);
-            compute_edcecc(ptr);
-            m_out->writeAt(std::move(slice), lba * IEC60908b::FRAMESIZE_RAW);
-            break;
+            memcpy(dest, c_sync, sizeof(c_sync));
+            msf.toBCD(dest + 12);
+            dest[15] = 2;
+            dest[16] = dest[20] = 0;
+            dest[17] = dest[21] = 0;
+            dest[18] = dest[22] = 8;
+            dest[19] = dest[23] = 0;
+            memcpy(dest + 24, sectorData, 2048);
+            IEC60908b::computeEDCECC(dest);
+            return true;
         case SectorMode::M2_FORM2:
-            slice.resize(IEC60908b::FRAMESIZE_RAW);
-            ptr = slice.mutableData<uint8_t>();
-            memcpy(ptr, c_sync, sizeof(c_sync));
-            msf.toBCD(ptr + 12);
-            ptr[15] = 2;
-            ptr[16] = ptr[20] = 0;
-            ptr[17] = ptr[21] = 0;
-            ptr[18] = ptr[22] = 8;
-            ptr[19] = ptr[23] = 0;
-            memcpy(ptr + 24, sectorData, 2324);
-            compute_edcecc(ptr);
-            m_out->writeAt(std::move(slice), lba * IEC60908b::FRAMESIZE_RAW);
-            break;
+            memcpy(dest, c_sync, sizeof(c_sync));
+            msf.toBCD(dest + 12);
+            dest[15] = 2;
+            dest[16] = dest[20] = 0;
+            dest[17] = dest[21] = 0;
+            // The form 2 bit is what tells the EDC computation to leave the last 4 bytes
+            // as the only trailer, instead of clobbering the payload with form 1 ECC.
+            dest[18] = dest[22] = 0x28;
+            dest[19] = dest[23] = 0;
+            memcpy(dest + 24, sectorData, 2324);
+            IEC60908b::computeEDCECC(dest);
+            return true;
         default:
-            return {0, 0, 0};
+            return false;
     }
+}
+
+PCSX::IEC60908b::MSF PCSX::ISO9660Builder::writeSectorAt(const uint8_t* sectorData, PCSX::IEC60908b::MSF msf,
+                                                         SectorMode mode) {
+    if (failed()) return {0, 0, 0};
+    Slice slice;
+    slice.resize(IEC60908b::FRAMESIZE_RAW);
+    if (!buildSector(slice.mutableData<uint8_t>(), sectorData, msf, mode)) return {0, 0, 0};
+    uint32_t lba = msf.toLBA() - 150;
+    m_out->writeAt(std::move(slice), lba * IEC60908b::FRAMESIZE_RAW);
     auto ret = msf;
     msf++;
     if (msf > m_location) m_location = msf;
     return ret;
 }
+
+void PCSX::ISO9660Builder::addExtent(IO<File> source, IEC60908b::MSF location, uint32_t sectors, SectorMode mode,
+                                     size_t offset, uint32_t stride) {
+    size_t size = payloadSize(mode);
+    if (!source || source->failed() || (size == 0)) return;
+    if (sectors == 0) {
+        size_t sourceSize = source->size();
+        if (sourceSize > offset) sectors = (sourceSize - offset + size - 1) / size;
+    }
+    if (sectors == 0) return;
+    if (stride == 0) stride = 1;
+    m_layout.push_back({source, location, sectors, mode, offset, stride});
+}
+
+void PCSX::ISO9660Builder::writeLayout() {
+    std::vector<Extent> layout = std::move(m_layout);
+    m_layout.clear();
+    if (failed() || layout.empty()) return;
+
+    // Place every sector of every extent on the disc, then slice that into work units,
+    // which are runs of contiguous sectors, possibly spanning several extents, as with
+    // XA interleaving. Each unit is made of pieces, which are runs of sectors contiguous
+    // both on the disc and in their source.
+    struct Placement {
+        uint32_t lba;
+        Extent* extent;
+        uint32_t index;
+    };
+    std::vector<Placement> placements;
+    for (auto& extent : layout) {
+        uint32_t lba = extent.location.toLBA() - 150;
+        for (uint32_t i = 0; i < extent.sectors; i++) placements.push_back({lba + i * extent.stride, &extent, i});
+    }
+    std::stable_sort(placements.begin(), placements.end(),
+                     [](const Placement& a, const Placement& b) { return a.lba < b.lba; });
+
+    struct Piece {
+        Extent* extent;
+        uint32_t first;
+        uint32_t count;
+    };
+    struct Unit {
+        uint32_t lba;
+        uint32_t count;
+        std::vector<Piece> pieces;
+    };
+    std::vector<Unit> units;
+    for (auto& placement : placements) {
+        if (units.empty() || (units.back().lba + units.back().count != placement.lba) ||
+            (units.back().count == c_chunkSectors)) {
+            units.push_back({placement.lba, 0, {}});
+        }
+        auto& unit = units.back();
+        if (!unit.pieces.empty() && (unit.pieces.back().extent == placement.extent) &&
+            (unit.pieces.back().first + unit.pieces.back().count == placement.index)) {
+            unit.pieces.back().count++;
+        } else {
+            unit.pieces.push_back({placement.extent, placement.index, 1});
+        }
+        unit.count++;
+    }
+    uint32_t end = placements.back().lba + 1;
+
+    uint8_t* direct = nullptr;
+    if (m_out.isA<MmapFile>()) {
+        auto mmap = m_out.asA<MmapFile>();
+        if (mmap->size() >= size_t(end) * IEC60908b::FRAMESIZE_RAW) direct = mmap->mutableData();
+    }
+
+    std::atomic<size_t> next = 0;
+    std::mutex sourceMutex;
+    std::mutex outMutex;
+    auto worker = [&]() {
+        std::vector<uint8_t> payload;
+        std::vector<uint8_t> buffer;
+        while (true) {
+            size_t index = next.fetch_add(1);
+            if (index >= units.size()) break;
+            auto& unit = units[index];
+            uint8_t* dest;
+            if (direct) {
+                dest = direct + size_t(unit.lba) * IEC60908b::FRAMESIZE_RAW;
+            } else {
+                buffer.resize(size_t(unit.count) * IEC60908b::FRAMESIZE_RAW);
+                dest = buffer.data();
+            }
+            uint8_t* sector = dest;
+            IEC60908b::MSF msf(unit.lba + 150);
+            for (auto& piece : unit.pieces) {
+                size_t size = payloadSize(piece.extent->mode);
+                // Short sources get padded with zeroes.
+                payload.assign(size * piece.count, 0);
+                {
+                    // Sources may be shared between extents, and aren't necessarily thread safe.
+                    std::lock_guard lock(sourceMutex);
+                    piece.extent->source->readAt(payload.data(), payload.size(),
+                                                 piece.extent->offset + size * piece.first);
+                }
+                for (uint32_t i = 0; i < piece.count; i++) {
+                    buildSector(sector, payload.data() + size * i, msf++, piece.extent->mode);
+                    sector += IEC60908b::FRAMESIZE_RAW;
+                }
+            }
+            if (!direct) {
+                std::lock_guard lock(outMutex);
+                m_out->writeAt(dest, buffer.size(), size_t(unit.lba) * IEC60908b::FRAMESIZE_RAW);
+            }
+        }
+    };
+
+    unsigned threadCount = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), units.size());
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < threadCount; i++) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+
+    IEC60908b::MSF location(end + 150);
+    if (location > m_location) m_location = location;
+}
@@ -19,6 +19,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "cdrom/common.h"
 #include "support/file.h"
 #include "supportpsx/iec-60908b.h"
@@ -35,13 +37,41 @@ class ISO9660Builder {
         return writeSectorAt(sectorData, m_location, mode);
     }
     IEC60908b::MSF writeSectorAt(const uint8_t* sectorData, IEC60908b::MSF msf, SectorMode mode);
+
+    // Layout mode: instead of pushing sectors one by one, describe the whole
+    // disc as a list of extents, each one being a run of sectors whose payload
+    // is read sequentially from the source file, starting at the given offset,
+    // in the size dictated by its mode. Consecutive sectors of an extent are
+    // placed stride sectors apart on the disc. Data files are M2_FORM1 extents,
+    // XA streams are interleaved as one strided extent per channel (M2_RAW when
+    // the caller provides its own subheaders), and CDDA tracks are RAW extents.
+    // A sector count of 0 means the rest of the source. Extents must not overlap.
+    void addExtent(IO<File> source, IEC60908b::MSF location, uint32_t sectors, SectorMode mode, size_t offset = 0,
+                   uint32_t stride = 1);
+    // Writes all the queued extents. The sectors are assembled and their EDC/ECC
+    // computed on a pool of threads, and written out in large contiguous chunks.
+    // If the output is a writable MmapFile large enough to hold the whole layout,
+    // the sectors are assembled directly into its mapping.
+    void writeLayout();
+
     void close() {
         m_out->close();
         m_out = nullptr;
     }
 
   private:
+    struct Extent {
+        IO<File> source;
+        IEC60908b::MSF location;
+        uint32_t sectors;
+        SectorMode mode;
+        size_t offset;
+        uint32_t stride;
+    };
+    static bool buildSector(uint8_t* dest, const uint8_t* sectorData, IEC60908b::MSF msf, SectorMode mode);
+
     IO<File> m_out;
+    std::vector<Extent> m_layout;
     IEC60908b::MSF m_location = {0, 2, 0};
 };
 
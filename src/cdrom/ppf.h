@@ -42,6 +42,8 @@ class PPF {
     void save(std::filesystem::path iso);
     // apply ppf patches to a sector
     void maybePatchSector(uint8_t *sector, IEC60908b::MSF) const;
+    // returns true if there are patches for this sector
+    bool hasPatch(IEC60908b::MSF msf) const { return m_patches.find(msf) != m_patches.end(); }
     // inject a new patch in memory based on the difference between two sectors
     void calculatePatch(const uint8_t *in, const uint8_t *out, IEC60908b::MSF);
     // inject a new patch in memory using an offset - this is allowed to straddle across sectors
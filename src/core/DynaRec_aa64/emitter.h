@@ -107,6 +107,10 @@ class Emitter : public MacroAssembler {
         file.write(getCode<const char*>(), getSize());               // Write the code buffer to the dump
     }
 
+    // Reads the virtual counter (CNTVCT_EL0) into dest, as a 64-bit timestamp for the profiler
+    // vixl doesn't know about this system register, so the MRS is encoded by hand
+    void readTimestamp(Register dest) { dc32(0xD53BE040 | dest.GetCode()); }
+
     // Returns a signed integer that shows how many bytes of free space are left in the code buffer
     int64_t getRemainingSize() { return (int64_t)codeCacheSize - (int64_t)getSize(); }
 
@@ -0,0 +1,95 @@
+/***************************************************************************
+ *   Copyright (C) 2024 PCSX-Redux authors                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#include <algorithm>
+#include <functional>
+
+#include "recompiler.h"
+
+#if defined(DYNAREC_AA64)
+// Starts a profiling session for this block using the virtual counter of the generic timer
+// Returns whether or not the profiler data overflowed. If it did, the recompiler should uncompile all blocks
+// And compile them again, otherwise profiling data will be off
+bool DynaRecCPU::startProfiling(uint32_t pc) {
+    bool overflowed = false;
+
+    if (!m_profiler.hasSpace()) {  // Flush data if we can't store any more
+        dumpProfileData();
+        m_profiler.reset();
+        overflowed = true;
+    }
+
+    ProfilerEntry entry(0, 0, pc);  // Create and queue profiler entry
+    m_profiler.add(entry);
+
+    const ProfilerEntry& entryRef = m_profiler.back();
+    const uintptr_t iterationOffset = (uintptr_t)&entryRef.timesInvoked - (uintptr_t)&entryRef;
+
+    gen.Mov(x0, (uintptr_t)&entryRef);             // x0 = pointer to entry object
+    gen.Ldr(x1, MemOperand(x0, iterationOffset));  // Increment "times invoked" variable
+    gen.Add(x1, x1, 1);
+    gen.Str(x1, MemOperand(x0, iterationOffset));
+
+    gen.readTimestamp(x1);                                              // x1 = 64-bit timestamp
+    gen.Str(x1, MemOperand(contextPointer, HOST_REG_CACHE_OFFSET(1)));  // Cache timestamp
+
+    return overflowed;
+}
+
+void DynaRecCPU::endProfiling() {
+    const ProfilerEntry& entryRef = m_profiler.back();
+    const uintptr_t cycleOffset = (uintptr_t)&entryRef.cyclesSpent - (uintptr_t)&entryRef;
+
+    gen.readTimestamp(x1);              // x1 = 64-bit timestamp
+    gen.Mov(x0, (uintptr_t)&entryRef);  // x0 = pointer to entry object
+
+    // Subtract cached timestamp from current timestamp to get delta
+    gen.Ldr(x2, MemOperand(contextPointer, HOST_REG_CACHE_OFFSET(1)));
+    gen.Sub(x1, x1, x2);
+    gen.Ldr(x2, MemOperand(x0, cycleOffset));  // Add delta to elapsed cycles
+    gen.Add(x2, x2, x1);
+    gen.Str(x2, MemOperand(x0, cycleOffset));
+
+    gen.Mov(x0, (uintptr_t)&m_profiler.totalCycles());
+    gen.Ldr(x2, MemOperand(x0));  // Add delta to total cycles
+    gen.Add(x2, x2, x1);
+    gen.Str(x2, MemOperand(x0));
+}
+
+void DynaRecCPU::dumpProfileData() {
+    std::string data = "Program Counter        Cycles Spent            Times Invoked\n";
+
+    // Sort blocks based on cycles spent in descending order
+    m_profiler.sort();
+    const int numberOfBlocks = std::min<int>(500, m_profiler.size());
+    const uint64_t totalCycles = m_profiler.totalCycles();
+
+    for (int i = 0; i < numberOfBlocks; i++) {
+        const ProfilerEntry& entry = m_profiler[i];
+        const double percentage = (double)entry.cyclesSpent / (double)totalCycles * 100.0;
+        data += fmt::format("{:08X}               {}({:.2f}%)                      {}\n", entry.pc, entry.cyclesSpent,
+                            percentage, entry.timesInvoked);
+    }
+
+    std::ofstream out("DynarecProfileData.txt");
+    out << data;
+
+    m_profiler.reset();
+}
+#endif  // DYNAREC_AA64
@@ -22,6 +22,9 @@
 #if defined(DYNAREC_AA64)
 
 bool DynaRecCPU::Init() {
+    const auto& args = PCSX::g_system->getArgs();
+    m_jitSymbols.open(args.isPerfMapEnabled(), args.isJitDumpEnabled());
+
     // Initialize recompiler memory
     // Check for 8MB RAM expansion
     const bool ramExpansion = PCSX::g_emulator->settings.get<PCSX::Emulator::Setting8MB>();
@@ -78,6 +81,14 @@ bool DynaRecCPU::Init() {
         m_dummyBlocks[i] = m_invalidBlock;
     }
 
+    if constexpr (ENABLE_SYMBOLS) {
+        makeSymbols();
+    }
+
+    if constexpr (ENABLE_PROFILER) {
+        m_profiler.init();
+    }
+
     m_gprs[0].markConst(0);  // $zero is always zero
 
 #if defined(__APPLE__)
@@ -104,6 +115,16 @@ void DynaRecCPU::Shutdown() {
     delete[] m_dummyBlocks;
 
     gen.dumpBuffer();  // dump buffer on shutdown/hard-reset for diagnostics
+
+    if constexpr (ENABLE_SYMBOLS) {
+        std::ofstream out("DynarecOutput.map");
+        out << m_symbols;
+        m_symbols.clear();
+    }
+
+    if constexpr (ENABLE_PROFILER) {
+        dumpProfileData();
+    }
 }
 
 /// Params: A program counter value
@@ -230,6 +251,11 @@ void DynaRecCPU::emitDispatcher() {
     call(recErrorWrapper);
     gen.B(&done);  // Exit
     gen.ready();   // Ready code buffer before emulator jumps into dispatcher for the first time
+
+    if (m_jitSymbols.enabled()) {
+        m_jitSymbols.addCode((void*)m_dispatcher, gen.getCurr<uint8_t*>() - (uint8_t*)m_dispatcher,
+                             "dynarec_dispatcher");
+    }
 }
 
 // Compile a block, write address of compiled code to *callback
@@ -259,8 +285,17 @@ DynarecCallback DynaRecCPU::recompile(DynarecCallback* callback, uint32_t pc, bo
         flushCache();
     }
 
+    if constexpr (ENABLE_SYMBOLS) {
+        m_symbols += fmt::format("{} recompile_{:08X}\n", gen.getCurr<void*>(), m_pc);
+    }
+
     const auto blockStart = gen.getCurr<DynarecCallback>();
     *callback = blockStart;
+    if constexpr (ENABLE_PROFILER) {
+        if (startProfiling(m_pc)) {  // Uncompile all blocks if the profiler data overflowed
+            uncompileAll();
+        }
+    }
     handleKernelCall();  // Check if this is a kernel call vector, emit some extra code in that case.
 
     auto shouldContinue = [&]() {
@@ -303,6 +338,9 @@ DynarecCallback DynaRecCPU::recompile(DynarecCallback* callback, uint32_t pc, bo
     if (startingPC == 0x80030000) {
         m_linkedPC = std::nullopt;
     }
+    if constexpr (ENABLE_PROFILER) {
+        endProfiling();
+    }
 
     gen.Ldr(x0, MemOperand(contextPointer, CYCLE_OFFSET));  // Fetch cycle count from memory
     gen.Add(x0, x0, count * PCSX::Emulator::BIAS);          // Add block cycles
@@ -318,6 +356,9 @@ DynarecCallback DynaRecCPU::recompile(DynarecCallback* callback, uint32_t pc, bo
     // Clear stale instruction cache contents.
     __builtin___clear_cache(reinterpret_cast<char*>(blockStart), gen.getCurr<char*>());
     gen.ready();
+    if (m_jitSymbols.enabled()) {
+        m_jitSymbols.addBlock((void*)blockStart, gen.getCurr<uint8_t*>() - (uint8_t*)blockStart, startingPC);
+    }
 #if defined(__APPLE__)
     gen.setRX();  // Mark code cache as readable/executable before returning to dispatcher
 #endif
@@ -27,6 +27,8 @@
 #include <stdexcept>
 #include <string>
 
+#include "core/DynaRec_x64/profiler.h"
+#include "core/jitsymbols.h"
 #include "emitter.h"
 #include "fmt/format.h"
 #include "regAllocation.h"
@@ -194,6 +196,15 @@ class DynaRecCPU final : public PCSX::R3000Acpu {
     void emitBlockLookup();
     void uncompileAll();
 
+    std::string m_symbols;
+    RecompilerProfiler<10000000> m_profiler;
+    PCSX::JitSymbols m_jitSymbols;
+
+    void makeSymbols();
+    bool startProfiling(uint32_t pc);
+    void endProfiling();
+    void dumpProfileData();
+
     // Class Wrapper Functions
     static void exceptionWrapper(DynaRecCPU* that, int32_t e, int32_t bd) { that->exception(e, bd); }
     static void recClearWrapper(DynaRecCPU* that, uint32_t address) { that->Clear(address, 1); }
@@ -498,6 +509,8 @@ class DynaRecCPU final : public PCSX::R3000Acpu {
     };
 
     static constexpr bool ENABLE_BLOCK_LINKING = false;
+    static constexpr bool ENABLE_PROFILER = false;
+    static constexpr bool ENABLE_SYMBOLS = false;
 };
 
 #endif  // DYNAREC_AA64
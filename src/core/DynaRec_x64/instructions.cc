@@ -683,39 +683,143 @@ void DynaRecCPU::recMULTU(uint32_t code) {
     gen.mov(dword[contextPointer + HI_OFFSET], edx);
 }
 
+// Reads guest memory from the address in arg2, and leaves the sign or zero extended value in eax.
+// With fastmem, the page is looked up inline in the memory read LUT, and we only call into
+// PCSX::Memory for pages that aren't directly backed by host memory, like hardware registers.
+// Callers pass fastmem = false when the address is a constant already known not to be in the LUT.
 template <int size, bool signExtend>
-void DynaRecCPU::recompileLoadWithDelay(uint32_t code, LoadDelayDependencyType type) {
-    if (m_gprs[_Rs_].isConst()) {
-        gen.mov(arg2, m_gprs[_Rs_].val + _Imm_);
-    } else {
-        allocateReg(_Rs_);
-        gen.moveAndAdd(arg2, m_gprs[_Rs_].allocatedReg, _Imm_);
+void DynaRecCPU::emitMemoryRead(bool fastmem) {
+    Label slowPath, done;
+    fastmem = fastmem && ENABLE_FASTMEM;
+
+    if (fastmem) {
+        // Flush volatiles before branching, so that both paths agree on the register allocation state
+        prepareForCall();
+        gen.mov(eax, arg2);
+        gen.shr(eax, 16);
+        loadAddress(rcx, PCSX::g_emulator->m_mem->m_readLUT);
+        gen.mov(rcx, qword[rcx + rax * 8]);  // rcx = host pointer to the page, or nullptr
+        gen.test(rcx, rcx);
+        gen.jz(slowPath, CodeGenerator::T_NEAR);
+
+        gen.movzx(eax, arg2.cvt16());
+        gen.add(qword[contextPointer + CYCLE_OFFSET], 1);  // Match the cycle penalty of the memory functions
+        switch (size) {
+            case 8:
+                signExtend ? gen.movsx(eax, Xbyak::util::byte[rcx + rax])
+                           : gen.movzx(eax, Xbyak::util::byte[rcx + rax]);
+                break;
+            case 16:
+                signExtend ? gen.movsx(eax, word[rcx + rax]) : gen.movzx(eax, word[rcx + rax]);
+                break;
+            case 32:
+                gen.mov(eax, dword[rcx + rax]);
+                break;
+        }
+        gen.jmp(done, CodeGenerator::T_NEAR);
+        gen.L(slowPath);
     }
 
     switch (size) {
         case 8:
             callMemoryFunc(&PCSX::Memory::read8);
+            signExtend ? gen.movsx(eax, al) : gen.movzx(eax, al);
             break;
         case 16:
             callMemoryFunc(&PCSX::Memory::read16);
+            signExtend ? gen.movsx(eax, ax) : gen.movzx(eax, ax);
             break;
         case 32:
             callMemoryFunc(&PCSX::Memory::read32);
             break;
     }
 
-    if (_Rt_) {
-        m_delayedLoadInfo[m_currentDelayedLoad].active = true;
+    if (fastmem) {
+        gen.L(done);
+    }
+}
 
+// Writes the value in arg3 to guest memory at the address in arg2. With fastmem, writes to
+// pages backed by host memory are done inline, and the block at the written address is
+// marked as uncompiled in case it held code, just like PCSX::Memory would through Clear().
+// Pages holding code copied into a trace take the slow path, so that Clear() takes the trace down.
+template <int size>
+void DynaRecCPU::emitMemoryWrite(bool fastmem) {
+    Label slowPath, done;
+    fastmem = fastmem && ENABLE_FASTMEM;
+
+    if (fastmem) {
+        prepareForCall();
+        gen.mov(eax, arg2);
+        gen.shr(eax, 16);
+        loadAddress(rcx, m_tracedPages);
+        gen.cmp(Xbyak::util::byte[rcx + rax], 0);
+        gen.jne(slowPath, CodeGenerator::T_NEAR);
+        loadAddress(rcx, PCSX::g_emulator->m_mem->m_writeLUT);
+        gen.mov(rcx, qword[rcx + rax * 8]);  // rcx = host pointer to the page, or nullptr
+        gen.test(rcx, rcx);
+        gen.jz(slowPath, CodeGenerator::T_NEAR);
+
+        gen.movzx(eax, arg2.cvt16());
+        gen.add(qword[contextPointer + CYCLE_OFFSET], 1);
         switch (size) {
             case 8:
-                signExtend ? gen.movsx(eax, al) : gen.movzx(eax, al);
+                gen.mov(Xbyak::util::byte[rcx + rax], arg3.cvt8());
                 break;
             case 16:
-                signExtend ? gen.movsx(eax, ax) : gen.movzx(eax, ax);
+                gen.mov(word[rcx + rax], arg3.cvt16());
+                break;
+            case 32:
+                gen.mov(dword[rcx + rax], arg3);
                 break;
         }
 
+        // Invalidate the block starting at the written word
+        const auto uncompiledBlockOffset = (uintptr_t)&m_uncompiledBlock - (uintptr_t)this;
+        gen.mov(eax, arg2);
+        gen.shr(eax, 16);
+        loadAddress(rcx, m_recompilerLUT);
+        gen.mov(rax, qword[rcx + rax * 8]);
+        gen.movzx(ecx, arg2.cvt16());
+        gen.and_(ecx, 0xfffc);
+        gen.lea(rax, qword[rax + rcx * 2]);
+        gen.mov(rcx, qword[contextPointer + uncompiledBlockOffset]);
+        gen.mov(qword[rax], rcx);
+        gen.jmp(done, CodeGenerator::T_NEAR);
+        gen.L(slowPath);
+    }
+
+    switch (size) {
+        case 8:
+            callMemoryFunc(&PCSX::Memory::write8);
+            break;
+        case 16:
+            callMemoryFunc(&PCSX::Memory::write16);
+            break;
+        case 32:
+            callMemoryFunc(&PCSX::Memory::write32);
+            break;
+    }
+
+    if (fastmem) {
+        gen.L(done);
+    }
+}
+
+template <int size, bool signExtend>
+void DynaRecCPU::recompileLoadWithDelay(uint32_t code, LoadDelayDependencyType type) {
+    if (m_gprs[_Rs_].isConst()) {
+        gen.mov(arg2, m_gprs[_Rs_].val + _Imm_);
+    } else {
+        allocateReg(_Rs_);
+        gen.moveAndAdd(arg2, m_gprs[_Rs_].allocatedReg, _Imm_);
+    }
+
+    emitMemoryRead<size, signExtend>(!m_gprs[_Rs_].isConst());
+
+    if (_Rt_) {
+        m_delayedLoadInfo[m_currentDelayedLoad].active = true;
+
         if (type == LoadDelayDependencyType::DependencyAcrossBlocks) {
             const auto delayedLoadValueOffset = (uintptr_t)&m_runtimeLoadDelay.value - (uintptr_t)this;
             const auto isActiveOffset = (uintptr_t)&m_runtimeLoadDelay.active - (uintptr_t)this;
@@ -762,33 +866,12 @@ void DynaRecCPU::recompileLoad(uint32_t code) {
         gen.moveAndAdd(arg2, m_gprs[_Rs_].allocatedReg, _Imm_);
     }
 
-    switch (size) {
-        case 8:
-            callMemoryFunc(&PCSX::Memory::read8);
-            break;
-        case 16:
-            callMemoryFunc(&PCSX::Memory::read16);
-            break;
-        case 32:
-            callMemoryFunc(&PCSX::Memory::read32);
-            break;
-    }
+    emitMemoryRead<size, signExtend>(!m_gprs[_Rs_].isConst());
 
     if (_Rt_) {
         allocateRegWithoutLoad(_Rt_);  // Allocate $rt after calling the read function, otherwise call() might flush it.
         m_gprs[_Rt_].setWriteback(true);
-
-        switch (size) {
-            case 8:
-                signExtend ? gen.movsx(m_gprs[_Rt_].allocatedReg, al) : gen.movzx(m_gprs[_Rt_].allocatedReg, al);
-                break;
-            case 16:
-                signExtend ? gen.movsx(m_gprs[_Rt_].allocatedReg, ax) : gen.movzx(m_gprs[_Rt_].allocatedReg, ax);
-                break;
-            case 32:
-                gen.mov(m_gprs[_Rt_].allocatedReg, eax);
-                break;
-        }
+        gen.mov(m_gprs[_Rt_].allocatedReg, eax);
     }
 }
 
@@ -1020,8 +1103,8 @@ void DynaRecCPU::recSB(uint32_t code) {
         }
 
         allocateReg(_Rs_);
-        gen.moveAndAdd(arg2, m_gprs[_Rs_].allocatedReg, _Imm_);  // Address to write to in arg2   TODO: Optimize
-        callMemoryFunc(&PCSX::Memory::write8);
+        gen.moveAndAdd(arg2, m_gprs[_Rs_].allocatedReg, _Imm_);  // Address to write to in arg2
+        emitMemoryWrite<8>(true);
     }
 }
 
@@ -1088,8 +1171,8 @@ void DynaRecCPU::recSH(uint32_t code) {
         }
 
         allocateReg(_Rs_);
-        gen.moveAndAdd(arg2, m_gprs[_Rs_].allocatedReg, _Imm_);  // Address to write to in arg2   TODO: Optimize
-        callMemoryFunc(&PCSX::Memory::write16);
+        gen.moveAndAdd(arg2, m_gprs[_Rs_].allocatedReg, _Imm_);  // Address to write to in arg2
+        emitMemoryWrite<16>(true);
     }
 }
 
@@ -1128,8 +1211,8 @@ void DynaRecCPU::recSW(uint32_t code) {
         }
 
         allocateReg(_Rs_);
-        gen.moveAndAdd(arg2, m_gprs[_Rs_].allocatedReg, _Imm_);  // Address to write to in arg2   TODO: Optimize
-        callMemoryFunc(&PCSX::Memory::write32);
+        gen.moveAndAdd(arg2, m_gprs[_Rs_].allocatedReg, _Imm_);  // Address to write to in arg2
+        emitMemoryWrite<32>(true);
     }
 }
 
@@ -1421,6 +1504,7 @@ void DynaRecCPU::testSoftwareInterrupt() {
     }
 
     m_stopCompiling = true;
+    m_linkedPC = std::nullopt;  // The interrupt may redirect execution, so we can't link or trace past this
 
     if constexpr (loadSR) {
         gen.mov(eax, dword[contextPointer + COP0_OFFSET(12)]);  // eax = SR
@@ -1873,6 +1957,7 @@ void DynaRecCPU::recMTHI(uint32_t code) {
 void DynaRecCPU::recException(Exception e) {
     m_pcWrittenBack = true;
     m_stopCompiling = true;
+    m_linkedPC = std::nullopt;  // Execution resumes in the exception handler, not at the jump target
 
     loadThisPointer(arg1.cvt64());                                                  // Pointer to this object in arg1
     gen.moveImm(arg2, static_cast<std::underlying_type<Exception>::type>(e) << 2);  // Exception type in arg2
@@ -20,7 +20,7 @@
 #pragma once
 
 #include "core/r3000a.h"
-#if defined(DYNAREC_X86_64)
+#if defined(DYNAREC_X86_64) || defined(DYNAREC_AA64)
 #include <algorithm>
 #include <cassert>
 #include <fstream>
@@ -80,4 +80,4 @@ class RecompilerProfiler {
     uint64_t& totalCycles() { return m_totalCycles; }
     ProfilerEntry& operator[](int i) { return m_entries[i]; }
 };
-#endif  // DYNAREC_X86_64
+#endif  // DYNAREC_X86_64 || DYNAREC_AA64
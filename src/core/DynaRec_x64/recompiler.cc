@@ -20,9 +20,14 @@
 #include "recompiler.h"
 
 #if defined(DYNAREC_X86_64)
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 
 bool DynaRecCPU::Init() {
+    const auto& args = PCSX::g_system->getArgs();
+    m_jitSymbols.open(args.isPerfMapEnabled(), args.isJitDumpEnabled());
+
     // Initialize recompiler memory
     // Check for 8MB RAM expansion
     const bool ramExpansion = PCSX::g_emulator->settings.get<PCSX::Emulator::Setting8MB>();
@@ -40,6 +45,12 @@ bool DynaRecCPU::Init() {
     m_ramBlocks = new DynarecCallback[m_ramSize / 4];
     m_biosBlocks = new DynarecCallback[biosSize / 4];
     m_dummyBlocks = new DynarecCallback[0x10000 / 4];  // Allocate one page worth of dummy blocks
+    m_ramBlockCounters = new uint64_t[m_ramSize / 4]();
+    m_biosBlockCounters = new uint64_t[biosSize / 4]();
+    m_ramBlockHeat = new uint32_t[m_ramSize / 4]();
+    m_biosBlockHeat = new uint32_t[biosSize / 4]();
+    m_tracedPages = new bool[0x10000]();
+    m_traces.clear();
 
     gen.reset();
 
@@ -93,6 +104,11 @@ void DynaRecCPU::Shutdown() {
     delete[] m_ramBlocks;
     delete[] m_biosBlocks;
     delete[] m_dummyBlocks;
+    delete[] m_ramBlockCounters;
+    delete[] m_biosBlockCounters;
+    delete[] m_ramBlockHeat;
+    delete[] m_biosBlockHeat;
+    delete[] m_tracedPages;
 
     if constexpr (ENABLE_SYMBOLS) {
         std::ofstream out("DynarecOutput.map");
@@ -123,6 +139,174 @@ DynarecCallback* DynaRecCPU::getBlockPointer(uint32_t pc) {
     return &base[offset];
 }
 
+/// Params: A pointer to a block entry, as returned by getBlockPointer
+/// Returns: A pointer to the execution counter of the block, or nullptr for invalid blocks
+uint64_t* DynaRecCPU::getBlockCounter(DynarecCallback* callback) {
+    constexpr size_t biosSize = 0x80000;
+    if (callback >= m_ramBlocks && callback < m_ramBlocks + m_ramSize / 4) {
+        return &m_ramBlockCounters[callback - m_ramBlocks];
+    }
+    if (callback >= m_biosBlocks && callback < m_biosBlocks + biosSize / 4) {
+        return &m_biosBlockCounters[callback - m_biosBlocks];
+    }
+    return nullptr;
+}
+
+// Emits the counter increment for the block being compiled. The enable flag is tested at runtime,
+// so that counting can be toggled at will without having to flush the code cache.
+void DynaRecCPU::emitBlockCounter(DynarecCallback* callback) {
+    const auto counter = getBlockCounter(callback);
+    if (counter == nullptr) return;
+
+    Xbyak::Label skip;
+    const auto enabledOffset = (uintptr_t)&m_blockCountersEnabled - (uintptr_t)this;
+    gen.cmp(Xbyak::util::byte[contextPointer + enabledOffset], 0);
+    gen.je(skip);
+    loadAddress(rax, counter);
+    gen.inc(qword[rax]);
+    gen.L(skip);
+}
+
+void DynaRecCPU::resetBlockCounters() {
+    constexpr size_t biosSize = 0x80000;
+    std::fill_n(m_ramBlockCounters, m_ramSize / 4, 0);
+    std::fill_n(m_biosBlockCounters, biosSize / 4, 0);
+}
+
+void DynaRecCPU::forEachBlockCounter(std::function<void(uint32_t pc, uint64_t count)> callback) {
+    constexpr size_t biosSize = 0x80000;
+    for (uint32_t i = 0; i < m_ramSize / 4; i++) {
+        if (m_ramBlockCounters[i] != 0) callback(0x80000000 + i * 4, m_ramBlockCounters[i]);
+    }
+    for (uint32_t i = 0; i < biosSize / 4; i++) {
+        if (m_biosBlockCounters[i] != 0) callback(0xbfc00000 + i * 4, m_biosBlockCounters[i]);
+    }
+}
+
+/// Params: A pointer to a block entry, as returned by getBlockPointer
+/// Returns: A pointer to the countdown until the block gets recompiled as a trace, or nullptr for invalid blocks
+uint32_t* DynaRecCPU::getBlockHeat(DynarecCallback* callback) {
+    constexpr size_t biosSize = 0x80000;
+    if (callback >= m_ramBlocks && callback < m_ramBlocks + m_ramSize / 4) {
+        return &m_ramBlockHeat[callback - m_ramBlocks];
+    }
+    if (callback >= m_biosBlocks && callback < m_biosBlocks + biosSize / 4) {
+        return &m_biosBlockHeat[callback - m_biosBlocks];
+    }
+    return nullptr;
+}
+
+// Emits the countdown which will get the block recompiled as a trace when it reaches 0.
+// Traces don't emit one, so they don't get recompiled over and over again.
+void DynaRecCPU::emitBlockHeat(DynarecCallback* callback) {
+    const auto heat = getBlockHeat(callback);
+    if (heat == nullptr) return;
+
+    *heat = m_promotionThreshold;
+    loadAddress(rax, heat);
+    gen.sub(dword[rax], 1);
+    gen.jz((void*)m_promoteBlock);
+}
+
+// Recompiles the block at the current PC as a trace. The blocks linked to this one check that the
+// block pointer still holds the address they jump to, so replacing it would send all of them back
+// through the dispatcher. Instead, the entry of the old block gets patched into a jump to the trace,
+// and the block pointer keeps pointing to it: existing links keep working, for the price of a jump.
+// The old block's heat countdown is gone with it, so a trace never gets promoted again, unless it
+// gets invalidated and recompiled from scratch.
+DynarecCallback DynaRecCPU::promoteToTrace() {
+    const auto callback = getBlockPointer(m_regs.pc);
+    const auto oldBlock = *callback;
+    const auto flushes = m_cacheFlushes;
+
+    m_compileTrace = true;
+    const auto trace = recompile(m_regs.pc, false);
+    // Flushing the code cache got rid of the old block, and any link to it
+    if (trace == m_invalidBlock || *callback != trace || flushes != m_cacheFlushes) return trace;
+
+    const auto entry = reinterpret_cast<uint8_t*>(oldBlock);
+    Trace record{callback, entry, {}, std::move(m_traceRanges)};
+    std::memcpy(record.originalEntry, entry, sizeof(record.originalEntry));
+
+    const auto displacement = reinterpret_cast<intptr_t>(trace) - reinterpret_cast<intptr_t>(entry + 5);
+    assert(Xbyak::inner::IsInInt32(displacement));
+    const int32_t rel32 = static_cast<int32_t>(displacement);
+    entry[0] = 0xe9;  // jmp rel32
+    std::memcpy(entry + 1, &rel32, sizeof(rel32));
+    *callback = oldBlock;
+
+    markTracedPages(record);
+    m_traces.push_back(std::move(record));
+    return trace;
+}
+
+// Flags the pages holding code copied into the trace, in all 3 segments RAM and BIOS are mirrored in.
+// Writes to flagged pages skip the inlined fastmem path, so that Clear() gets to see them.
+void DynaRecCPU::markTracedPages(const Trace& trace) {
+    for (const auto& [start, end] : trace.ranges) {
+        for (uint32_t page = start >> 16; page <= (end - 1) >> 16; page++) {
+            m_tracedPages[page] = true;
+            m_tracedPages[page | 0x8000] = true;
+            m_tracedPages[page | 0xa000] = true;
+        }
+    }
+}
+
+// Takes down every trace holding a copy of the code in [addr, addr + size * 4). The first block of the
+// trace gets uncompiled, and the block that got patched into a jump to the trace gets its entry back,
+// so that neither the dispatcher nor the blocks linked to it can reach the stale copy anymore.
+void DynaRecCPU::invalidateTraces(uint32_t addr, uint32_t size) {
+    if (size == 0) return;
+    bool traced = false;
+    for (uint32_t page = addr >> 16; page <= (addr + size * 4 - 1) >> 16; page++) {
+        traced |= m_tracedPages[page];
+    }
+    if (!traced) return;
+
+    const uint32_t start = addr & 0x1fffffff;
+    const uint32_t end = start + size * 4;
+    const auto overlaps = [start, end](const Trace& trace) {
+        return std::any_of(trace.ranges.begin(), trace.ranges.end(),
+                           [start, end](const auto& range) { return range.first < end && start < range.second; });
+    };
+
+    bool invalidated = false;
+    for (auto it = m_traces.begin(); it != m_traces.end();) {
+        if (!overlaps(*it)) {
+            ++it;
+            continue;
+        }
+        *it->callback = m_uncompiledBlock;
+        std::memcpy(it->patchedEntry, it->originalEntry, sizeof(it->originalEntry));
+        it = m_traces.erase(it);
+        m_jitStats.invalidations++;
+        invalidated = true;
+    }
+    if (!invalidated) return;
+
+    std::fill_n(m_tracedPages, 0x10000, false);
+    for (const auto& trace : m_traces) markTracedPages(trace);
+}
+
+// Checks if we can keep compiling past the end of the current block, into the block it jumps to.
+// This is only possible if the jump target is known at compile time, and nothing is left pending
+// for the start of the next block, as the trace won't go through a block prologue there.
+bool DynaRecCPU::canExtendTrace(uint32_t startingPC, unsigned count, const std::vector<uint32_t>& traceBlocks) {
+    if (!m_linkedPC || count >= MAX_TRACE_SIZE || int(traceBlocks.size()) >= MAX_TRACE_BLOCKS) return false;
+    if (m_delayedLoadInfo[0].active || m_delayedLoadInfo[1].active) return false;
+
+    const uint32_t target = m_linkedPC.value() & ~3;
+    if (!isPcValid(target) || target == 0x80030000) return false;
+    // Kernel call vectors need their prologue, for the debugger features, fastboot and HLE
+    const uint32_t pc = target & PCSX::g_emulator->getRamMask();
+    const uint32_t base = (target >> 20) & 0xffc;
+    const bool kernelSegment = (base == 0x000) || (base == 0x800) || (base == 0xa00);
+    if (kernelSegment && (pc == 0xA0 || pc == 0xB0 || pc == 0xC0)) return false;
+    // Loops go through the block prologue, so that interrupts get a chance to fire
+    if (target == startingPC) return false;
+    return std::find(traceBlocks.begin(), traceBlocks.end(), target) == traceBlocks.end();
+}
+
 void DynaRecCPU::signalShellReached(DynaRecCPU* that) {
     if (!that->m_shellStarted) {
         that->m_shellStarted = true;
@@ -147,9 +331,13 @@ void DynaRecCPU::uncompileAll() {
 }
 
 void DynaRecCPU::flushCache() {
+    TracyMessageL("Dynarec code cache flushed");
+    m_cacheFlushes++;
     gen.reset();       // Reset the emitter's code pointer and code size variables
     emitDispatcher();  // Re-emit dispatcher
     uncompileAll();    // Mark all blocks as uncompiled
+    m_traces.clear();  // The traces and the blocks they patched are gone with the code cache
+    std::fill_n(m_tracedPages, 0x10000, false);
 }
 
 void DynaRecCPU::emitBlockLookup() {
@@ -309,6 +497,17 @@ void DynaRecCPU::emitDispatcher() {
     gen.mov(arg2, 1);                   // Fully emulate load delays
     gen.callFunc(recRecompileWrapper);  // Call recompilation function. Returns pointer to emitted code
     gen.jmp(rax);
+
+    // Code to recompile the current block as a trace once it got hot
+    gen.align(16);
+    m_promoteBlock = gen.getCurr<DynarecCallback>();
+    loadThisPointer(arg1.cvt64());
+    gen.callFunc(recRecompileTraceWrapper);  // Returns pointer to emitted code
+    gen.jmp(rax);
+
+    if (m_jitSymbols.enabled()) {
+        m_jitSymbols.addCode(m_dispatcher, gen.getCurr<uint8_t*>() - (uint8_t*)m_dispatcher, "dynarec_dispatcher");
+    }
 }
 
 // Compile a block, write address of compiled code to *callback
@@ -324,6 +523,8 @@ DynarecCallback DynaRecCPU::recompile(uint32_t pc, bool fullLoadDelayEmulation,
     m_pc = pc & ~3;
     m_firstInstruction = true;
     m_fullLoadDelayEmulation = fullLoadDelayEmulation;
+    const bool compilingTrace = ENABLE_TRACES && m_compileTrace && !fullLoadDelayEmulation;
+    m_compileTrace = false;
     auto& memory = PCSX::g_emulator->m_mem;
 
     // If we somehow ended up compiling a block at an invalid PC, throw an error.
@@ -340,6 +541,8 @@ DynarecCallback DynaRecCPU::recompile(uint32_t pc, bool fullLoadDelayEmulation,
     if (gen.getSize() > codeCacheSize) {  // Flush JIT cache if we've gone above the acceptable size
         flushCache();
     }
+    const auto compileStart = std::chrono::steady_clock::now();
+    const size_t codeStart = gen.getSize();
 
     if constexpr (ENABLE_SYMBOLS) {
         m_symbols += fmt::format("{} recompile_{:08X}\n", gen.getCurr<void*>(), m_pc);
@@ -348,6 +551,8 @@ DynarecCallback DynaRecCPU::recompile(uint32_t pc, bool fullLoadDelayEmulation,
     }
 
     *callback = gen.getCurr<DynarecCallback>();  // Pointer to emitted code
+    TracyPlot("Dynarec blocks compiled", int64_t(++m_blocksCompiled));
+    TracyPlot("Dynarec code cache size", int64_t(gen.getSize()));
     if constexpr (ENABLE_PROFILER) {
         if (startProfiling(m_pc)) {  // Uncompile all blocks if the profiler data overflower
             uncompileAll();
@@ -362,16 +567,23 @@ DynarecCallback DynaRecCPU::recompile(uint32_t pc, bool fullLoadDelayEmulation,
         gen.cmp(Xbyak::util::byte[contextPointer + isActiveOffset], 0);
         gen.jne((void*)m_needFullLoadDelays);
     }
+    emitBlockCounter(callback);
+    if (ENABLE_TRACES && !compilingTrace && !fullLoadDelayEmulation) {
+        emitBlockHeat(callback);
+    }
+    // The setting is only checked at compile time; toggling it invalidates the code cache.
+    const bool idleLoop = PCSX::g_emulator->settings.get<PCSX::Emulator::SettingIdleSkip>() && isIdleLoop(startingPC);
     handleKernelCall();  // Check if this is a kernel call vector, emit some extra code in that case.
 
-    const auto shouldContinue = [this, &count]() {
+    const auto shouldContinue = [this, &count, compilingTrace]() {
         if (m_nextIsDelaySlot) {
             return true;
         }
         if (m_stopCompiling) {
             return false;
         }
-        if (count >= MAX_BLOCK_SIZE && !m_delayedLoadInfo[0].active && !m_delayedLoadInfo[1].active) {
+        if (count >= (compilingTrace ? MAX_TRACE_SIZE : MAX_BLOCK_SIZE) && !m_delayedLoadInfo[0].active &&
+            !m_delayedLoadInfo[1].active) {
             return false;
         }
         return true;
@@ -430,11 +642,32 @@ DynarecCallback DynaRecCPU::recompile(uint32_t pc, bool fullLoadDelayEmulation,
     processDelayedLoad();
     m_firstInstruction = false;
 
-    while (shouldContinue()) {
-        if (!compileInstruction()) {
-            return m_invalidBlock;
+    std::vector<uint32_t> traceBlocks;
+    std::vector<std::pair<uint32_t, uint32_t>> traceRanges;
+    uint32_t segmentStart = startingPC;
+    while (true) {
+        while (shouldContinue()) {
+            if (!compileInstruction()) {
+                return m_invalidBlock;
+            }
+            processDelayedLoad();
         }
-        processDelayedLoad();
+        if (!compilingTrace || !canExtendTrace(startingPC, count, traceBlocks)) break;
+
+        // Keep compiling the jump target as part of this trace. Register allocations and constants
+        // stay alive across the jump, instead of being flushed and reloaded by the next block.
+        traceRanges.emplace_back(segmentStart & 0x1fffffff, (segmentStart & 0x1fffffff) + (m_pc - segmentStart));
+        m_pc = segmentStart = m_linkedPC.value() & ~3;
+        traceBlocks.push_back(m_pc);
+        m_linkedPC = std::nullopt;
+        m_stopCompiling = false;
+        m_pcWrittenBack = false;
+    }
+
+    if (compilingTrace) {
+        // Handed over to promoteToTrace, before linking gets a chance to compile anything else
+        traceRanges.emplace_back(segmentStart & 0x1fffffff, (segmentStart & 0x1fffffff) + (m_pc - segmentStart));
+        m_traceRanges = std::move(traceRanges);
     }
 
     flushRegs();
@@ -442,6 +675,16 @@ DynarecCallback DynaRecCPU::recompile(uint32_t pc, bool fullLoadDelayEmulation,
         gen.mov(dword[contextPointer + PC_OFFSET], m_pc);
     }
 
+    // If this block is an idle loop and we're about to run it again, fast forward to the next event
+    if (idleLoop) {
+        Label notLooping;
+        gen.cmp(dword[contextPointer + PC_OFFSET], startingPC);
+        gen.jne(notLooping);
+        loadThisPointer(arg1.cvt64());
+        gen.callFunc(recIdleSkipWrapper);
+        gen.L(notLooping);
+    }
+
     // If this was the block at 0x8003'0000 (Start of shell), don't link the PC in case we fastboot
     if (startingPC == 0x80030000) {
         m_linkedPC = std::nullopt;
@@ -451,6 +694,17 @@ DynarecCallback DynaRecCPU::recompile(uint32_t pc, bool fullLoadDelayEmulation,
     }
 
     gen.add(qword[contextPointer + CYCLE_OFFSET], count * PCSX::Emulator::BIAS);  // Add block cycles;
+
+    // Linking may compile the next block, so account for this one before that
+    auto& compileStats = compilingTrace ? m_jitStats.traces : m_jitStats.blocks;
+    compileStats.blocks++;
+    compileStats.codeBytes += gen.getSize() - codeStart;
+    compileStats.compileTimeNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                      std::chrono::steady_clock::now() - compileStart)
+                                      .count();
+    if (m_jitSymbols.enabled()) {
+        m_jitSymbols.addBlock(gen.getCode<const uint8_t*>() + codeStart, gen.getSize() - codeStart, startingPC);
+    }
     if (m_linkedPC && ENABLE_BLOCK_LINKING && m_linkedPC.value() != startingPC) {
         handleLinking();
     } else {
@@ -484,6 +738,14 @@ void DynaRecCPU::handleKernelCall() {
     if (pc == 0xA0 || pc == 0xB0 || pc == 0xC0) {
         gen.mov(arg2, m_pc);
         emitMemberFunctionCall(&PCSX::R3000Acpu::InterceptBIOS<false>, this);
+
+        // Blocks with full load delay emulation may have a load in flight, so they always take the LLE path
+        if (pc == 0xA0 && !m_fullLoadDelayEmulation) {
+            gen.mov(arg2, m_pc);
+            emitMemberFunctionCall(&PCSX::R3000Acpu::HLEKernelCall<false>, this);
+            gen.test(al, al);
+            gen.jnz((void*)m_returnFromBlock);  // The call was emulated, and pc now points to $ra
+        }
     }
 }
 
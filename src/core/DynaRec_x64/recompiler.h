@@ -21,14 +21,18 @@
 #include "core/r3000a.h"
 
 #if defined(DYNAREC_X86_64)
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <fstream>
 #include <optional>
 #include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "core/gpu.h"
+#include "core/jitsymbols.h"
 #include "emitter.h"
 #include "fmt/format.h"
 #include "profiler.h"
@@ -103,6 +107,11 @@ class DynaRecCPU final : public PCSX::R3000Acpu {
     DynarecCallback* m_ramBlocks;   // Pointers to compiled RAM blocks (If nullptr then this block needs to be compiled)
     DynarecCallback* m_biosBlocks;  // Pointers to compiled BIOS blocks
     DynarecCallback* m_dummyBlocks;  // This is where invalid pages will point
+    uint64_t* m_ramBlockCounters;    // Execution counters for RAM blocks, indexed like m_ramBlocks
+    uint64_t* m_biosBlockCounters;   // Execution counters for BIOS blocks, indexed like m_biosBlocks
+    bool m_blockCountersEnabled = false;  // Checked at runtime by every block prologue
+    uint32_t* m_ramBlockHeat;   // Executions left before a RAM block gets recompiled as a trace
+    uint32_t* m_biosBlockHeat;  // Executions left before a BIOS block gets recompiled as a trace
 
     // Functions written in raw assembly
     DynarecCallback m_dispatcher;       // Pointer to our assembly dispatcher
@@ -113,6 +122,7 @@ class DynaRecCPU final : public PCSX::R3000Acpu {
     DynarecCallback m_loadDelayHandler;  // Pointer to the code that will handle load delays at the start of a block
     // Pointer to the code that will be executed when a block needs to be recompiled with full load delay support
     DynarecCallback m_needFullLoadDelays;
+    DynarecCallback m_promoteBlock;  // Pointer to the code that will recompile a hot block as a trace
 
     Emitter gen;
     uint32_t m_pc;  // Recompiler PC
@@ -121,7 +131,22 @@ class DynaRecCPU final : public PCSX::R3000Acpu {
     bool m_pcWrittenBack;  // Has the PC been written back already by a jump?
     bool m_firstInstruction;
     bool m_fullLoadDelayEmulation;
+    bool m_compileTrace = false;  // Should the next block be compiled as a trace?
     uint32_t m_ramSize;  // RAM is 2MB on retail units, 8MB on some DTL units (Can be toggled in GUI)
+    uint64_t m_blocksCompiled = 0;  // Only used for the Tracy plots
+    uint64_t m_cacheFlushes = 0;    // Lets a promotion notice that the block it started from is gone
+
+    // Traces hold a copy of the code of every block they go through, so writing to any of them has to
+    // take down the whole trace, and not only the block starting at the written address.
+    struct Trace {
+        DynarecCallback* callback;  // Block pointer of the trace's first block
+        uint8_t* patchedEntry;      // Entry of the block that got patched into a jump to the trace
+        uint8_t originalEntry[5];   // What the jump overwrote
+        std::vector<std::pair<uint32_t, uint32_t>> ranges;  // Physical addresses of the code it holds, as [start, end)
+    };
+    std::vector<Trace> m_traces;
+    std::vector<std::pair<uint32_t, uint32_t>> m_traceRanges;  // Ranges of the trace compiled last
+    bool* m_tracedPages;  // Which 64KB pages of the address space hold code copied into a trace
 
     // Used to hold info when we've got a load delay between the end of a block and the start of another
     // For example, when there's an lw instruction in the delay slot of a branch
@@ -132,6 +157,11 @@ class DynaRecCPU final : public PCSX::R3000Acpu {
     } m_runtimeLoadDelay;
 
     const int MAX_BLOCK_SIZE = 50;
+    const int MAX_TRACE_SIZE = 200;  // Max instructions in a trace, across all of its blocks
+    const int MAX_TRACE_BLOCKS = 8;  // Max blocks chained into a single trace
+
+    uint32_t m_promotionThreshold = 64;  // How many times a block runs before getting recompiled as a trace
+    JitStats m_jitStats;
 
     enum class RegState { Unknown, Constant };
     enum class LoadingMode { DoNotLoad, Load };
@@ -207,6 +237,19 @@ class DynaRecCPU final : public PCSX::R3000Acpu {
     virtual void Reset() final;
     virtual void Shutdown() final;
     virtual bool isDynarec() final { return true; }
+    virtual bool supportsBlockCounters() final { return true; }
+    virtual bool blockCountersEnabled() final { return m_blockCountersEnabled; }
+    virtual void enableBlockCounters(bool enabled) final { m_blockCountersEnabled = enabled; }
+    virtual void resetBlockCounters() final;
+    virtual void forEachBlockCounter(std::function<void(uint32_t pc, uint64_t count)> callback) final;
+    virtual bool supportsJitStats() final { return ENABLE_TRACES; }
+    virtual JitStats getJitStats() final {
+        JitStats stats = m_jitStats;
+        stats.promotionThreshold = m_promotionThreshold;
+        return stats;
+    }
+    virtual void resetJitStats() final { m_jitStats = {}; }
+    virtual void setPromotionThreshold(uint32_t threshold) final { m_promotionThreshold = std::max(threshold, 1u); }
     virtual void Execute() final {
         ZoneScoped;         // Tell the Tracy profiler to do its thing
         (*m_dispatcher)();  // Jump to assembly dispatcher
@@ -219,6 +262,7 @@ class DynaRecCPU final : public PCSX::R3000Acpu {
     // Possibly clear blocks more aggressively
     // Note: This relies on the behavior in psxmem.cc which calls Clear after force-aligning the address
     virtual void Clear(uint32_t addr, uint32_t size) final {
+        if (!m_traces.empty()) invalidateTraces(addr, size);
         auto pointer = getBlockPointer(addr);
         for (auto i = 0; i < size; i++) {
             *pointer++ = m_uncompiledBlock;
@@ -363,16 +407,29 @@ class DynaRecCPU final : public PCSX::R3000Acpu {
 
     static void exceptionWrapper(DynaRecCPU* that, int32_t e, int32_t bd) { that->exception(e, bd); }
     static void recErrorWrapper(DynaRecCPU* that) { that->error(); }
+    static void recIdleSkipWrapper(DynaRecCPU* that) { that->skipIdleCycles(); }
 
     static void signalShellReached(DynaRecCPU* that);
     static DynarecCallback recRecompileWrapper(DynaRecCPU* that, bool fullLoadDelayEmulation) {
         return that->recompile(that->m_regs.pc, fullLoadDelayEmulation);
     }
+    static DynarecCallback recRecompileTraceWrapper(DynaRecCPU* that) {
+        TracyPlot("Dynarec promotions", int64_t(++that->m_jitStats.promotions));
+        return that->promoteToTrace();
+    }
 
     // Check if we're executing from valid memory
     inline bool isPcValid(uint32_t addr) { return m_recompilerLUT[addr >> 16] != m_dummyBlocks; }
 
     DynarecCallback* getBlockPointer(uint32_t pc);
+    uint64_t* getBlockCounter(DynarecCallback* callback);
+    void emitBlockCounter(DynarecCallback* callback);
+    uint32_t* getBlockHeat(DynarecCallback* callback);
+    void emitBlockHeat(DynarecCallback* callback);
+    DynarecCallback promoteToTrace();
+    void markTracedPages(const Trace& trace);
+    void invalidateTraces(uint32_t addr, uint32_t size);
+    bool canExtendTrace(uint32_t startingPC, unsigned count, const std::vector<uint32_t>& traceBlocks);
     DynarecCallback recompile(uint32_t pc, bool fullLoadDelayEmulation, bool align = true);
     void error();
     void flushCache();
@@ -382,6 +439,7 @@ class DynaRecCPU final : public PCSX::R3000Acpu {
 
     std::string m_symbols;
     RecompilerProfiler<10000000> m_profiler;
+    PCSX::JitSymbols m_jitSymbols;
 
     void makeSymbols();
     bool startProfiling(uint32_t pc);
@@ -524,6 +582,10 @@ class DynaRecCPU final : public PCSX::R3000Acpu {
     template <int size, bool signExtend>
     void recompileLoad(uint32_t code);
     template <int size, bool signExtend>
+    void emitMemoryRead(bool fastmem);
+    template <int size>
+    void emitMemoryWrite(bool fastmem);
+    template <int size, bool signExtend>
     void recompileLoadWithDelay(uint32_t code, LoadDelayDependencyType dependencyType);
 
     const recompilationFunc m_recBSC[64] = {
@@ -584,6 +646,8 @@ class DynaRecCPU final : public PCSX::R3000Acpu {
     };
 
     static constexpr bool ENABLE_BLOCK_LINKING = true;
+    static constexpr bool ENABLE_FASTMEM = true;
+    static constexpr bool ENABLE_TRACES = true;
     static constexpr bool ENABLE_PROFILER = false;
     static constexpr bool ENABLE_SYMBOLS = false;
 };
@@ -41,4 +41,10 @@ PCSX::Arguments::Arguments(const CommandLine::args& args) {
     if (args.get<bool>("noupdate")) m_updateDisabled = true;
     if (args.get<bool>("viewports")) m_viewportsEnabled = true;
     if (args.get<bool>("no-viewports")) m_viewportsEnabled = false;
+    if (args.get<bool>("fastboot")) m_bootCacheEnabled = true;
+    if (args.get<bool>("no-bootcache")) m_bootCacheEnabled = false;
+    if (args.get<bool>("perfmap")) m_perfMapEnabled = true;
+    if (args.get<bool>("jitdump")) m_jitDumpEnabled = true;
+    auto stateTracePath = args.get<std::string_view>("statetrace");
+    if (stateTracePath.has_value()) m_stateTracePath = stateTracePath.value();
 }
@@ -77,12 +77,30 @@ class Arguments {
     // Toggled with the flags -viewports / -no-viewports.
     bool isViewportsEnabled() const { return m_viewportsEnabled; }
 
+    // Returns true if booting should go through the post-boot snapshot cache, which is
+    // stored in the bootcache folder of the persistent directory.
+    // Enabled with the flag -fastboot, and disabled again with the flag -no-bootcache.
+    bool isBootCacheEnabled() const { return m_bootCacheEnabled; }
+
+    // Returns true if the recompiler should export its code to /tmp/perf-<pid>.map.
+    // Enabled with the flag -perfmap.
+    bool isPerfMapEnabled() const { return m_perfMapEnabled; }
+
+    // Returns true if the recompiler should export its code to a jit-<pid>.dump file.
+    // Enabled with the flag -jitdump.
+    bool isJitDumpEnabled() const { return m_jitDumpEnabled; }
+
     // Returns the path to the portable directory.
     // Set with the flag -portable.
     std::string_view getPortablePath() const { return m_portablePath; }
 
+    // Returns the path to the CPU state trace file, or an empty string if none was requested.
+    // Set with the flag -statetrace.
+    std::string_view getStateTracePath() const { return m_stateTracePath; }
+
   private:
     std::string m_portablePath = "";
+    std::string m_stateTracePath = "";
     bool m_luaStdoutEnabled = false;
     bool m_stdoutEnabled = false;
     bool m_guiLogsEnabled = true;
@@ -92,6 +110,9 @@ class Arguments {
     bool m_uiResetRequested = false;
     bool m_shadersDisabled = false;
     bool m_updateDisabled = false;
+    bool m_bootCacheEnabled = false;
+    bool m_perfMapEnabled = false;
+    bool m_jitDumpEnabled = false;
 #ifdef __linux__
     bool m_viewportsEnabled = false;
 #else
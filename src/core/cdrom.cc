@@ -30,6 +30,7 @@
 #include "magic_enum/include/magic_enum/magic_enum_all.hpp"
 #include "spu/interface.h"
 #include "support/strings-helpers.h"
+#include "tracy/public/tracy/Tracy.hpp"
 
 namespace {
 
@@ -980,7 +981,7 @@ class CDRomImpl : public PCSX::CDRom {
                 // Crusaders of Might and Magic - update getlocl now
                 // - fixes cutscene speech
                 {
-                    uint8_t *buf = m_iso->getBuffer();
+                    const uint8_t *buf = m_iso->getBuffer();
                     if (buf != NULL) memcpy(m_transfer, buf, 8);
                 }
 
@@ -1104,7 +1105,8 @@ class CDRomImpl : public PCSX::CDRom {
     }
 
     void readInterrupt() final {
-        uint8_t *buf;
+        ZoneScoped;
+        const uint8_t *buf;
 
         if (!m_reading) return;
 
@@ -17,9 +17,16 @@
  *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
  ***************************************************************************/
 
-#include "recompiler.h"
+// The symbol map is the same for both recompilers, which expose the same members for it.
+#include "core/r3000a.h"
 
 #if defined(DYNAREC_X86_64)
+#include "core/DynaRec_x64/recompiler.h"
+#elif defined(DYNAREC_AA64)
+#include "core/DynaRec_aa64/recompiler.h"
+#endif
+
+#if defined(DYNAREC_X86_64) || defined(DYNAREC_AA64)
 #include <array>
 #include <cstring>
 
@@ -117,4 +124,4 @@ void DynaRecCPU::makeSymbols() {
 
 #undef REGISTER_VARIABLE
 #undef REGISTER_FUNCTION
-#endif  // DYNAREC_X86_64
+#endif  // DYNAREC_X86_64 || DYNAREC_AA64
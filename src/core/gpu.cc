@@ -29,6 +29,7 @@
 #include "imgui/imgui.h"
 #include "imgui/imgui_internal.h"
 #include "magic_enum/include/magic_enum/magic_enum_all.hpp"
+#include "tracy/public/tracy/Tracy.hpp"
 
 #define GPUSTATUS_READYFORVRAM 0x08000000
 #define GPUSTATUS_IDLE 0x04000000  // CMD ready
@@ -88,6 +89,48 @@ void GPU::Poly<shading, shape, textured, blend, modulation>::processWrite(Buffer
     }
     m_count = 0;
     m_state = READ_COLOR;
+    dispatch(origin, origvalue, length);
+}
+
+template <GPU::Shading shading, GPU::Shape shape, GPU::Textured textured, GPU::Blend blend, GPU::Modulation modulation>
+void GPU::Poly<shading, shape, textured, blend, modulation>::processPacket(const uint32_t *packet,
+                                                                           Logged::Origin origin, uint32_t origvalue,
+                                                                           uint32_t length) {
+    uint32_t value = SWAP_LE32(*packet++);
+    for (unsigned i = 0; i < count; i++) {
+        if ((shading == Shading::Gouraud) || (i == 0)) {
+            if (i != 0) value = SWAP_LE32(*packet++);
+            if constexpr ((textured == Textured::Yes) && (modulation == Modulation::Off)) {
+                colors[i] = 0x808080;
+            } else {
+                colors[i] = value & 0xffffff;
+            }
+        } else {
+            colors[i] = colors[0];
+        }
+        value = SWAP_LE32(*packet++);
+        x[i] = GPU::signExtend<int, 11>(value & 0xffff);
+        y[i] = GPU::signExtend<int, 11>(value >> 16);
+        if constexpr (textured == Textured::Yes) {
+            value = SWAP_LE32(*packet++);
+            u[i] = value & 0xff;
+            v[i] = (value >> 8) & 0xff;
+            value >>= 16;
+            if (i == 0) {
+                clutraw = value;
+            } else if (i == 1) {
+                value &= 0b0000100111111111;
+                tpage = TPage(value);
+                uint32_t lastTPage = m_gpu->m_lastTPage.raw & ~0b0000100111111111;
+                m_gpu->m_lastTPage = TPage(lastTPage | value);
+            }
+        }
+    }
+    dispatch(origin, origvalue, length);
+}
+
+template <GPU::Shading shading, GPU::Shape shape, GPU::Textured textured, GPU::Blend blend, GPU::Modulation modulation>
+void GPU::Poly<shading, shape, textured, blend, modulation>::dispatch(Logged::Origin origin, uint32_t origvalue, uint32_t length) {
     if constexpr (textured == Textured::Yes) {
         twindow = TWindow(m_gpu->m_lastTWindow.raw);
     }
@@ -148,6 +191,33 @@ void GPU::Line<shading, lineType, blend>::processWrite(Buffer & buf, Logged::Ori
         m_count = 0;
     }
     m_state = READ_COLOR;
+    dispatch(origin, origvalue, length);
+}
+
+template <GPU::Shading shading, GPU::LineType lineType, GPU::Blend blend>
+void GPU::Line<shading, lineType, blend>::processPacket(const uint32_t *packet, Logged::Origin origin,
+                                                        uint32_t origvalue, uint32_t length) {
+    // Polylines are terminated by a marker word, so their length is never known upfront,
+    // and they never get decoded here.
+    if constexpr (lineType == LineType::Simple) {
+        uint32_t value = SWAP_LE32(*packet++);
+        for (unsigned i = 0; i < 2; i++) {
+            if ((shading == Shading::Gouraud) || (i == 0)) {
+                if (i != 0) value = SWAP_LE32(*packet++);
+                colors[i] = value & 0xffffff;
+            } else {
+                colors[i] = colors[0];
+            }
+            value = SWAP_LE32(*packet++);
+            x[i] = GPU::signExtend<int, 11>(value & 0xffff);
+            y[i] = GPU::signExtend<int, 11>(value >> 16);
+        }
+        dispatch(origin, origvalue, length);
+    }
+}
+
+template <GPU::Shading shading, GPU::LineType lineType, GPU::Blend blend>
+void GPU::Line<shading, lineType, blend>::dispatch(Logged::Origin origin, uint32_t origvalue, uint32_t length) {
     offset = m_gpu->m_lastOffset;
     m_gpu->m_defaultProcessor.setActive();
     if ((colors.size() >= 2) && ((colors.size() == x.size()))) {
@@ -213,6 +283,44 @@ void GPU::Rect<size, textured, blend, modulation>::processWrite(Buffer & buf, Lo
             }
     }
     m_state = READ_COLOR;
+    dispatch(origin, origvalue, length);
+}
+
+template <GPU::Size size, GPU::Textured textured, GPU::Blend blend, GPU::Modulation modulation>
+void GPU::Rect<size, textured, blend, modulation>::processPacket(const uint32_t *packet, Logged::Origin origin,
+                                                                 uint32_t origvalue, uint32_t length) {
+    uint32_t value = SWAP_LE32(*packet++);
+    if constexpr ((textured == Textured::No) || (modulation == Modulation::On)) {
+        color = value & 0xffffff;
+    }
+    value = SWAP_LE32(*packet++);
+    x = GPU::signExtend<int, 11>(value & 0xffff);
+    y = GPU::signExtend<int, 11>(value >> 16);
+    if constexpr (textured == Textured::Yes) {
+        value = SWAP_LE32(*packet++);
+        u = value & 0xff;
+        v = (value >> 8) & 0xff;
+        clutraw = value >> 16;
+    }
+    if constexpr (size == Size::Variable) {
+        value = SWAP_LE32(*packet++);
+        w = value & 0xffff;
+        h = value >> 16;
+    } else if constexpr (size == Size::S1) {
+        h = 1;
+        w = 1;
+    } else if constexpr (size == Size::S8) {
+        h = 8;
+        w = 8;
+    } else if constexpr (size == Size::S16) {
+        h = 16;
+        w = 16;
+    }
+    dispatch(origin, origvalue, length);
+}
+
+template <GPU::Size size, GPU::Textured textured, GPU::Blend blend, GPU::Modulation modulation>
+void GPU::Rect<size, textured, blend, modulation>::dispatch(Logged::Origin origin, uint32_t origvalue, uint32_t length) {
     if constexpr (textured == Textured::Yes) {
         tpage = TPage(m_gpu->m_lastTPage.raw);
         twindow = TWindow(m_gpu->m_lastTWindow.raw);
@@ -489,6 +597,7 @@ void PCSX::GPU::dma(uint32_t madr, uint32_t bcr, uint32_t chcr) {  // GPU
             }
             // BA blocks * BS words (word = 32-bits)
             size = (bcr >> 16) * (bcr & 0xffff);
+            TracyPlot("GPU DMA bytes", int64_t(size * 4));
             directDMARead(ptr, size, madr);
             g_emulator->m_cpu->Clear(madr, size);
             if (g_emulator->settings.get<Emulator::SettingDebugSettings>().get<Emulator::DebugSettings::Debug>()) {
@@ -517,6 +626,7 @@ void PCSX::GPU::dma(uint32_t madr, uint32_t bcr, uint32_t chcr) {  // GPU
                 g_emulator->m_debug->checkDMAread(2, madr, size * 4);
             }
             pgxpMemory(PGXP_ConvertAddress(madr), PGXP_GetMem());
+            TracyPlot("GPU DMA bytes", int64_t(size * 4));
             directDMAWrite(ptr, size, madr);
 
 #if 0
@@ -533,6 +643,7 @@ void PCSX::GPU::dma(uint32_t madr, uint32_t bcr, uint32_t chcr) {  // GPU
             PSXDMA_LOG("*** DMA 2 - GPU dma chain *** %8.8lx addr = %lx size = %lx\n", chcr, madr, bcr);
 
             size = gpuDmaChainSize(madr);
+            TracyPlot("GPU DMA bytes", int64_t(size * 4));
             chainedDMAWrite((uint32_t *)PCSX::g_emulator->m_mem->m_wram, madr);
 
             // Tekken 3 = use 1.0 only (not 1.5x)
@@ -680,6 +791,7 @@ void PCSX::GPU::directDMARead(uint32_t *dest, int transferSize, uint32_t hwAddr)
 }
 
 void PCSX::GPU::chainedDMAWrite(const uint32_t *memory, uint32_t hwAddr) {
+    ZoneScoped;
     uint32_t addr = hwAddr;
     uint32_t DMACommandCounter = 0;
 
@@ -707,6 +819,19 @@ void PCSX::GPU::chainedDMAWrite(const uint32_t *memory, uint32_t hwAddr) {
                                    // 0xFF'FFFF any pointer with bit 23 set will do.
 }
 
+// DMA transfers usually carry whole packets, which can then be decoded in one go. Otherwise,
+// such as with GP0 writes, the primitive's state machine gets fed as the words come in.
+void PCSX::GPU::Command::startPrimitive(Buffer &buf, Primitive *primitive, unsigned words, Logged::Origin origin,
+                                        uint32_t originValue, uint32_t length) {
+    if ((words != 0) && (buf.size() >= words)) {
+        primitive->processPacket(buf.data(), origin, originValue, length);
+        buf.consume(words);
+    } else {
+        primitive->setActive();
+        m_gpu->m_processor->processWrite(buf, origin, originValue, length);
+    }
+}
+
 void PCSX::GPU::Command::processWrite(Buffer &buf, Logged::Origin origin, uint32_t originValue, uint32_t length) {
     while (!buf.isEmpty()) {
         uint32_t value = buf.get();
@@ -736,18 +861,15 @@ void PCSX::GPU::Command::processWrite(Buffer &buf, Logged::Origin origin, uint32
                 break;
             case 1: {  // Polygon primitive
                 buf.rewind();
-                m_gpu->m_polygons[command]->setActive();
-                m_gpu->m_processor->processWrite(buf, origin, originValue, length);
+                startPrimitive(buf, m_gpu->m_polygons[command], polyPacketWords(command), origin, originValue, length);
             } break;
             case 2: {  // Line primitive
                 buf.rewind();
-                m_gpu->m_lines[command]->setActive();
-                m_gpu->m_processor->processWrite(buf, origin, originValue, length);
+                startPrimitive(buf, m_gpu->m_lines[command], linePacketWords(command), origin, originValue, length);
             } break;
             case 3: {  // Rectangle primitive
                 buf.rewind();
-                m_gpu->m_rects[command]->setActive();
-                m_gpu->m_processor->processWrite(buf, origin, originValue, length);
+                startPrimitive(buf, m_gpu->m_rects[command], rectPacketWords(command), origin, originValue, length);
             } break;
             case 4: {  // Move data in VRAM
                 m_gpu->m_blitVramVram.setActive();
@@ -53,6 +53,25 @@ class GPU {
         return t.value = value;
     }
 
+    // Packet lengths in words, header included, from the command bits of a primitive's header.
+    // A zero means the length isn't known from the header alone.
+    static constexpr unsigned polyPacketWords(uint8_t command) {
+        const bool gouraud = command & 0x10;
+        const unsigned vertices = (command & 0x08) ? 4 : 3;
+        const bool textured = command & 0x04;
+        return 1 + vertices + (textured ? vertices : 0) + (gouraud ? vertices - 1 : 0);
+    }
+    static constexpr unsigned linePacketWords(uint8_t command) {
+        const bool gouraud = command & 0x10;
+        const bool poly = command & 0x08;
+        return poly ? 0 : (gouraud ? 4 : 3);
+    }
+    static constexpr unsigned rectPacketWords(uint8_t command) {
+        const bool variable = (command & 0x18) == 0;
+        const bool textured = command & 0x04;
+        return 2 + (textured ? 1 : 0) + (variable ? 1 : 0);
+    }
+
     uint32_t readStatus();
     void dma(uint32_t madr, uint32_t bcr, uint32_t chcr);
     static void gpuInterrupt();
@@ -225,6 +244,8 @@ class GPU {
         const uint32_t *m_data;
     };
 
+    class Primitive;
+
     class Command {
       public:
         Command() : m_gpu(nullptr) {}
@@ -235,6 +256,8 @@ class GPU {
         void setActive() { m_gpu->m_processor = this; }
 
       protected:
+        void startPrimitive(Buffer &, Primitive *primitive, unsigned words, Logged::Origin, uint32_t value,
+                            uint32_t length);
         GPU *m_gpu;
 
       private:
@@ -243,6 +266,13 @@ class GPU {
         friend class GPU;
     };
 
+    class Primitive : public Command {
+      public:
+        // Decodes a whole packet at once, when the caller knows all of its words are available,
+        // skipping the resumable state machine of processWrite.
+        virtual void processPacket(const uint32_t *packet, Logged::Origin, uint32_t value, uint32_t length) = 0;
+    };
+
   public:
     template <typename T, T wMax = 1024, T hMax = 512>
     static bool clip(T &x, T &y, T &w, T &h) {
@@ -524,7 +554,7 @@ class GPU {
     };
 
     template <Shading shading, Shape shape, Textured textured, Blend blend, Modulation modulation>
-    struct Poly final : public Command, public Logged {
+    struct Poly final : public Primitive, public Logged {
         static constexpr unsigned count = shape == Shape::Tri ? 3 : 4;
 
         std::string_view getName() override { return "Polygon"; }
@@ -535,6 +565,7 @@ class GPU {
         void getVertices(AddTri &&, PixelOp) override;
         Poly() {}
         void processWrite(Buffer &, Logged::Origin, uint32_t value, uint32_t length) override;
+        void processPacket(const uint32_t *packet, Logged::Origin, uint32_t value, uint32_t length) override;
         void reset() override {
             m_state = READ_COLOR;
             m_count = 0;
@@ -585,13 +616,14 @@ class GPU {
         }
 
       private:
+        void dispatch(Logged::Origin, uint32_t value, uint32_t length);
         GPUStats stats;
         unsigned m_count = 0;
         enum { READ_COLOR, READ_XY, READ_UV } m_state = READ_COLOR;
     };
 
     template <Shading shading, LineType lineType, Blend blend>
-    struct Line final : public Command, public Logged {
+    struct Line final : public Primitive, public Logged {
         std::string_view getName() override { return "Line"; }
         void drawLogNode(unsigned itemIndex, const DrawLogSettings &) override;
         void execute(GPU *gpu) override { gpu->write0(this); }
@@ -602,6 +634,7 @@ class GPU {
             if constexpr (lineType == LineType::Simple) m_count = 0;
         }
         void processWrite(Buffer &, Logged::Origin, uint32_t value, uint32_t length) override;
+        void processPacket(const uint32_t *packet, Logged::Origin, uint32_t value, uint32_t length) override;
         void reset() override {
             m_state = READ_COLOR;
             if constexpr (lineType == LineType::Simple) {
@@ -635,6 +668,7 @@ class GPU {
         DrawingOffset offset;
 
       private:
+        void dispatch(Logged::Origin, uint32_t value, uint32_t length);
         GPUStats stats;
         struct Empty {};
         POLYFILL_NO_UNIQUE_ADDRESS
@@ -643,7 +677,7 @@ class GPU {
     };
 
     template <Size size, Textured textured, Blend blend, Modulation modulation>
-    struct Rect final : public Command, public Logged {
+    struct Rect final : public Primitive, public Logged {
         std::string_view getName() override { return "Rectangle"; }
         void drawLogNode(unsigned itemIndex, const DrawLogSettings &) override;
         void execute(GPU *gpu) override { gpu->write0(this); }
@@ -652,6 +686,7 @@ class GPU {
         void getVertices(AddTri &&, PixelOp) override;
         Rect() {}
         void processWrite(Buffer &, Logged::Origin, uint32_t value, uint32_t length) override;
+        void processPacket(const uint32_t *packet, Logged::Origin, uint32_t value, uint32_t length) override;
         void reset() override { m_state = READ_COLOR; }
         bool isInside(unsigned x, unsigned y) override {
             return (x >= (this->x + offset.x)) && (y >= (this->y + offset.y)) && (x < (this->x + offset.x) + this->w) &&
@@ -695,6 +730,7 @@ class GPU {
         }
 
       private:
+        void dispatch(Logged::Origin, uint32_t value, uint32_t length);
         enum { READ_COLOR, READ_XY, READ_UV, READ_HW } m_state = READ_COLOR;
     };
 
@@ -858,9 +894,9 @@ class GPU {
     Command m_defaultProcessor = {this};
 
     FastFill m_fastFill = {this};
-    Command *m_polygons[32];
-    Command *m_lines[32];
-    Command *m_rects[32];
+    Primitive *m_polygons[32];
+    Primitive *m_lines[32];
+    Primitive *m_rects[32];
     BlitVramVram m_blitVramVram = {this};
     BlitRamVram m_blitRamVram = {this};
     BlitVramRam m_blitVramRam = {this};
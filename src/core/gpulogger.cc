@@ -24,6 +24,7 @@
 #include "core/r3000a.h"
 #include "core/system.h"
 #include "imgui/imgui.h"
+#include "tracy/public/tracy/Tracy.hpp"
 
 static const char* const c_vtx = R"(
 #version 330 core
@@ -63,6 +64,15 @@ void main() {
 PCSX::GPULogger::GPULogger() : m_listener(g_system->m_eventBus) {
     m_listener.listen<Events::GPU::VSync>([this](auto event) {
         m_frameCounter++;
+        // The stats are only gathered while the logger is enabled.
+        if (m_enabled) {
+            TracyPlot("GPU triangles", int64_t(m_frameStats.triangles));
+            TracyPlot("GPU textured triangles", int64_t(m_frameStats.texturedTriangles));
+            TracyPlot("GPU rectangles", int64_t(m_frameStats.rectangles));
+            TracyPlot("GPU sprites", int64_t(m_frameStats.sprites));
+            TracyPlot("GPU pixel writes", int64_t(m_frameStats.pixelWrites));
+        }
+        m_frameStats = {};
         if (m_breakOnVSync) {
             g_system->pause();
         }
@@ -151,6 +161,7 @@ void PCSX::GPULogger::addNodeInternal(GPU::Logged* node, GPU::Logged::Origin ori
     node->pc = g_emulator->m_cpu->m_regs.pc;
     node->frame = frame;
     node->generateStatsInfo();
+    node->cumulateStats(&m_frameStats);
     m_list.push_back(node);
 
     if (!m_hasFramebuffers) return;
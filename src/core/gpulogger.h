@@ -62,6 +62,7 @@ class GPULogger {
     bool m_breakOnVSync = false;
     bool m_hasFramebuffers = false;
     uint64_t m_frameCounter = 0;
+    GPU::GPUStats m_frameStats;
     GPU::LoggedList m_list;
     Slice m_vram;
     float m_impact = 1.0f / 256.0f;
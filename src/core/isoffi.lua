@@ -48,6 +48,9 @@ ISO9660Builder* createIsoBuilder(LuaFile* out);
 void deleteIsoBuilder(ISO9660Builder* builder);
 void isoBuilderWriteLicense(ISO9660Builder* builder, LuaFile*);
 void isoBuilderWriteSector(ISO9660Builder* builder, const uint8_t* sectorData, enum SectorMode mode);
+void isoBuilderAddExtent(ISO9660Builder* builder, LuaFile* source, uint32_t lba, uint32_t sectors,
+                         enum SectorMode mode, uint64_t offset, uint32_t stride);
+void isoBuilderWriteLayout(ISO9660Builder* builder);
 void isoBuilderClose(ISO9660Builder* builder);
 
 ]]
@@ -97,6 +100,14 @@ local function createIsoBuilderWrapper(wrapper)
             if Support.isLuaBuffer(sectorData) then sectorData = sectorData.data end
             C.isoBuilderWriteSector(self._wrapper, sectorData, mode)
         end,
+        addExtent = function(self, file, lba, sectors, mode, offset, stride)
+            if not sectors then sectors = 0 end
+            if not mode then mode = 'M2_FORM1' end
+            if not offset then offset = 0 end
+            if not stride then stride = 1 end
+            C.isoBuilderAddExtent(self._wrapper, file._wrapper, lba, sectors, mode, offset, stride)
+        end,
+        writeLayout = function(self) C.isoBuilderWriteLayout(self._wrapper) end,
         close = function(self) C.isoBuilderClose(self._wrapper) end,
     }
     return iso
@@ -0,0 +1,142 @@
+/***************************************************************************
+ *   Copyright (C) 2024 PCSX-Redux authors                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#include "core/jitsymbols.h"
+
+#include "core/psxemulator.h"
+#include "core/r3000a.h"
+#include "fmt/format.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+// See tools/perf/Documentation/jitdump-specification.txt in the Linux sources.
+struct JitDumpHeader {
+    uint32_t magic = 0x4a695444;  // "JiTD"
+    uint32_t version = 1;
+    uint32_t totalSize = sizeof(JitDumpHeader);
+    uint32_t elfMach;
+    uint32_t pad1 = 0;
+    uint32_t pid;
+    uint64_t timestamp;
+    uint64_t flags = 0;
+};
+
+struct JitDumpCodeLoad {
+    uint32_t id = 0;  // JIT_CODE_LOAD
+    uint32_t totalSize;
+    uint64_t timestamp;
+    uint32_t pid;
+    uint32_t tid;
+    uint64_t vma;
+    uint64_t codeAddr;
+    uint64_t codeSize;
+    uint64_t codeIndex;
+};
+
+// perf record -k mono is required to correlate these with the samples.
+uint64_t monotonicTimestamp() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+}  // namespace
+
+void PCSX::JitSymbols::open(bool perfMap, bool jitDump) {
+    if (perfMap && !m_perfMap) {
+        m_perfMap = fopen(fmt::format("/tmp/perf-{}.map", getpid()).c_str(), "w");
+    }
+    if (jitDump && !m_jitDump) {
+        m_jitDump = fopen(fmt::format("jit-{}.dump", getpid()).c_str(), "w+");
+        if (!m_jitDump) return;
+        JitDumpHeader header;
+#if defined(__x86_64__)
+        header.elfMach = 62;  // EM_X86_64
+#elif defined(__aarch64__)
+        header.elfMach = 183;  // EM_AARCH64
+#else
+        header.elfMach = 0;
+#endif
+        header.pid = getpid();
+        header.timestamp = monotonicTimestamp();
+        fwrite(&header, sizeof(header), 1, m_jitDump);
+        fflush(m_jitDump);
+        // perf finds the dump file through this executable mapping of it.
+        m_jitDumpMarkerSize = sysconf(_SC_PAGESIZE);
+        m_jitDumpMarker = mmap(nullptr, m_jitDumpMarkerSize, PROT_READ | PROT_EXEC, MAP_PRIVATE, fileno(m_jitDump), 0);
+        if (m_jitDumpMarker == MAP_FAILED) m_jitDumpMarker = nullptr;
+    }
+}
+
+void PCSX::JitSymbols::close() {
+    if (m_perfMap) fclose(m_perfMap);
+    if (m_jitDumpMarker) munmap(m_jitDumpMarker, m_jitDumpMarkerSize);
+    if (m_jitDump) fclose(m_jitDump);
+    m_perfMap = nullptr;
+    m_jitDump = nullptr;
+    m_jitDumpMarker = nullptr;
+}
+
+void PCSX::JitSymbols::addCode(const void* code, size_t size, const std::string& name) {
+    if (size == 0) return;
+    if (m_perfMap) {
+        fmt::print(m_perfMap, "{:x} {:x} {}\n", uintptr_t(code), size, name);
+        fflush(m_perfMap);
+    }
+    if (m_jitDump) {
+        JitDumpCodeLoad record;
+        record.totalSize = sizeof(record) + name.size() + 1 + size;
+        record.timestamp = monotonicTimestamp();
+        record.pid = getpid();
+        record.tid = syscall(SYS_gettid);
+        record.vma = record.codeAddr = uintptr_t(code);
+        record.codeSize = size;
+        record.codeIndex = m_codeIndex++;
+        fwrite(&record, sizeof(record), 1, m_jitDump);
+        fwrite(name.c_str(), name.size() + 1, 1, m_jitDump);
+        fwrite(code, size, 1, m_jitDump);
+        fflush(m_jitDump);
+    }
+}
+#else
+void PCSX::JitSymbols::open(bool perfMap, bool jitDump) {}
+void PCSX::JitSymbols::close() {}
+void PCSX::JitSymbols::addCode(const void* code, size_t size, const std::string& name) {}
+#endif
+
+void PCSX::JitSymbols::addBlock(const void* code, size_t size, uint32_t pc) {
+    std::string name = fmt::format("recompile_{:08X}", pc);
+    auto& symbols = g_emulator->m_cpu->m_symbols;
+    auto symbol = symbols.upper_bound(pc);
+    if (symbol != symbols.begin()) {
+        --symbol;
+        if (symbol->first == pc) {
+            name += fmt::format(" {}", symbol->second);
+        } else {
+            name += fmt::format(" {}+0x{:x}", symbol->second, pc - symbol->first);
+        }
+    }
+    addCode(code, size, name);
+}
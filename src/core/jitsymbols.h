@@ -0,0 +1,57 @@
+/***************************************************************************
+ *   Copyright (C) 2024 PCSX-Redux authors                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <string>
+
+namespace PCSX {
+
+// Exports the host code emitted by the recompilers to Linux profilers, so JIT frames
+// don't show up as anonymous memory. Two formats are supported, each one opt-in:
+//  - /tmp/perf-<pid>.map, the plain text map read by perf report and VTune,
+//  - jit-<pid>.dump in the current directory, the jitdump format consumed by
+//    perf inject --jit, which also carries the code bytes for annotation.
+// Entries are appended as blocks get compiled; when the code cache gets flushed and
+// its addresses reused, the newer entries take precedence. On other hosts this is a no-op.
+class JitSymbols {
+  public:
+    ~JitSymbols() { close(); }
+
+    // Can be called again on recompiler resets; files already open are kept.
+    void open(bool perfMap, bool jitDump);
+    void close();
+    bool enabled() const { return m_perfMap || m_jitDump; }
+
+    void addCode(const void* code, size_t size, const std::string& name);
+    // Names the block after its guest PC, and the closest guest symbol preceding it, if any.
+    void addBlock(const void* code, size_t size, uint32_t pc);
+
+  private:
+    FILE* m_perfMap = nullptr;
+    FILE* m_jitDump = nullptr;
+    void* m_jitDumpMarker = nullptr;
+    size_t m_jitDumpMarkerSize = 0;
+    uint64_t m_codeIndex = 0;
+};
+
+}  // namespace PCSX
@@ -67,6 +67,11 @@ void isoBuilderWriteLicense(PCSX::ISO9660Builder* builder, PCSX::LuaFFI::LuaFile
 void isoBuilderWriteSector(PCSX::ISO9660Builder* builder, const uint8_t* sectorData, PCSX::SectorMode mode) {
     builder->writeSector(sectorData, mode);
 }
+void isoBuilderAddExtent(PCSX::ISO9660Builder* builder, PCSX::LuaFFI::LuaFile* sourceWrapper, uint32_t lba,
+                         uint32_t sectors, PCSX::SectorMode mode, uint64_t offset, uint32_t stride) {
+    builder->addExtent(sourceWrapper->file, PCSX::IEC60908b::MSF(lba + 150), sectors, mode, offset, stride);
+}
+void isoBuilderWriteLayout(PCSX::ISO9660Builder* builder) { builder->writeLayout(); }
 void isoBuilderClose(PCSX::ISO9660Builder* builder) { builder->close(); }
 
 }  // namespace
@@ -102,6 +107,8 @@ static void registerAllSymbols(PCSX::Lua L) {
     REGISTER(L, deleteIsoBuilder);
     REGISTER(L, isoBuilderWriteLicense);
     REGISTER(L, isoBuilderWriteSector);
+    REGISTER(L, isoBuilderAddExtent);
+    REGISTER(L, isoBuilderWriteLayout);
     REGISTER(L, isoBuilderClose);
 
     L.settable();
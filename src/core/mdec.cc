@@ -22,6 +22,7 @@
 
 #include "core/debug.h"
 #include "core/psxemulator.h"
+#include "tracy/public/tracy/Tracy.hpp"
 
 #define AAN_CONST_BITS 12
 #define AAN_PRESCALE_BITS 16
@@ -468,6 +469,7 @@ void PCSX::MDEC::mdec0Interrupt() {
 #define SIZE_OF_16B_BLOCK (16 * 16 * 2)
 
 void PCSX::MDEC::dma1(uint32_t adr, uint32_t bcr, uint32_t chcr) {
+    ZoneScoped;
     int blk[DSIZE2 * 6];
     uint8_t *image;
     int size;
@@ -478,6 +480,7 @@ void PCSX::MDEC::dma1(uint32_t adr, uint32_t bcr, uint32_t chcr) {
     size = (bcr >> 16) * (bcr & 0xffff);
     /* size in byte */
     size *= 4;
+    TracyPlot("MDEC DMA bytes", int64_t(size));
     /* I guess the memory speed is limitating */
     dmacnt = size;
     if (g_emulator->settings.get<Emulator::SettingDebugSettings>().get<Emulator::DebugSettings::Debug>()) {
@@ -19,8 +19,12 @@
 
 #include "core/memorycard.h"
 
+#include <condition_variable>
+#include <mutex>
+
 #include "core/sio.h"
 #include "support/sjis_conv.h"
+#include "support/uvfile.h"
 
 void PCSX::MemoryCard::acknowledge() { m_sio->acknowledge(); }
 
@@ -245,7 +249,8 @@ uint8_t PCSX::MemoryCard::tickWriteCommand(uint8_t value) {
             m_directoryFlag = Flags::DirectoryRead;
             data_out = Responses::GoodReadWrite;
             memcpy(&m_mcdData[m_sector * 128], &m_tempBuffer, c_sectorSize);
-            m_savedToDisk = false;
+            m_dirtySectors.set(m_sector);
+            m_flushPending = true;
             break;
     }
 
@@ -341,6 +346,15 @@ void PCSX::MemoryCard::loadMcd(PCSX::u8string mcd) {
     const char *fname = reinterpret_cast<const char *>(mcd.c_str());
     size_t bytesRead;
 
+    // Don't let a pending write of the previous card land after we've read this one.
+    waitForFlush();
+    if (m_flushState) {
+        std::unique_lock lock(m_flushState->mutex);
+        m_flushState->path.clear();
+        m_flushState->dirty = false;
+    }
+    m_dirtySectors.reset();
+    m_flushPending = false;
     m_directoryFlag = Flags::DirectoryUnread;
 
     FILE *f = fopen(fname, "rb");
@@ -351,16 +365,18 @@ void PCSX::MemoryCard::loadMcd(PCSX::u8string mcd) {
         if (f != nullptr) {
             struct stat buf;
 
+            m_header.clear();
             if (stat(fname, &buf) != -1) {
                 // Check if the file is a VGS memory card, skip the header if it is
                 if (buf.st_size == c_cardSize + 64) {
-                    fseek(f, 64, SEEK_SET);
+                    m_header.resize(64);
                 }
                 // Check if the file is a Dexdrive memory card, skip the header if it is
                 else if (buf.st_size == c_cardSize + 3904) {
-                    fseek(f, 3904, SEEK_SET);
+                    m_header.resize(3904);
                 }
             }
+            if (fread(m_header.data(), 1, m_header.size(), f) != m_header.size()) m_header.clear();
             bytesRead = fread(data, 1, c_cardSize, f);
             fclose(f);
             if (bytesRead != c_cardSize) {
@@ -372,57 +388,208 @@ void PCSX::MemoryCard::loadMcd(PCSX::u8string mcd) {
     } else {
         struct stat buf;
         PCSX::g_system->printf(_("Loading memory card %s\n"), fname);
+        m_header.clear();
         if (stat(fname, &buf) != -1) {
             if (buf.st_size == c_cardSize + 64) {
-                fseek(f, 64, SEEK_SET);
+                m_header.resize(64);
             } else if (buf.st_size == c_cardSize + 3904) {
-                fseek(f, 3904, SEEK_SET);
+                m_header.resize(3904);
             }
         }
+        if (fread(m_header.data(), 1, m_header.size(), f) != m_header.size()) m_header.clear();
         bytesRead = fread(data, 1, c_cardSize, f);
         fclose(f);
         if (bytesRead != c_cardSize) {
             throw std::runtime_error(_("Error reading memory card."));
-        } else {
-            m_savedToDisk = true;
         }
     }
 }
 
-void PCSX::MemoryCard::saveMcd(PCSX::u8string mcd, const char *data, uint32_t adr, size_t size) {
-    if (std::filesystem::path(mcd).is_relative()) {
-        mcd = (g_system->getPersistentDir() / mcd).u8string();
+struct PCSX::MemoryCard::FlushState {
+    std::mutex mutex;
+    std::condition_variable cv;
+    // Latest contents handed over by the emulation thread. The data always holds the full card,
+    // so that a snapshot which failed to be written can simply be marked dirty again.
+    PCSX::u8string path;
+    std::string header;
+    char data[c_cardSize];
+    bool dirty = false;
+    bool running = false;
+};
+
+// Runs on the UV loop: writes the latest snapshot into a temporary file, syncs it, and renames
+// it over the card file, then loops for as long as the emulation thread handed over newer data.
+// Bursts of sector writes from a game saving thus end up as a handful of file replacements.
+// A failing step is logged and the snapshot is retried a few times with a delay; if it still
+// can't be written, it stays dirty and goes out with the next change, save, or shutdown.
+class PCSX::MemoryCard::Writer final : public UvThreadOp {
+  public:
+    static void start(std::shared_ptr<FlushState> state) {
+        request([state = std::move(state)](uv_loop_t *loop) mutable { (new Writer(std::move(state), loop))->next(); });
     }
-    const char *fname = reinterpret_cast<const char *>(mcd.c_str());
-    FILE *f = fopen(fname, "r+b");
 
-    if (f != nullptr) {
-        struct stat buf;
+  private:
+    static constexpr unsigned c_maxAttempts = 3;
+    static constexpr uint64_t c_retryDelayMs = 500;
 
-        if (stat(fname, &buf) != -1) {
-            if (buf.st_size == c_cardSize + 64) {
-                fseek(f, adr + 64, SEEK_SET);
-            } else if (buf.st_size == c_cardSize + 3904) {
-                fseek(f, adr + 3904, SEEK_SET);
-            } else {
-                fseek(f, adr, SEEK_SET);
-            }
-        } else {
-            fseek(f, adr, SEEK_SET);
+    Writer(std::shared_ptr<FlushState> &&state, uv_loop_t *loop) : m_state(std::move(state)), m_loop(loop) {
+        m_req.data = this;
+        uv_timer_init(m_loop, &m_retryTimer);
+        m_retryTimer.data = this;
+    }
+    virtual bool canCache() const override { return false; }
+
+    static Writer *fromReq(uv_fs_t *req) {
+        auto writer = reinterpret_cast<Writer *>(req->data);
+        writer->m_result = req->result;
+        uv_fs_req_cleanup(req);
+        return writer;
+    }
+
+    void next() {
+        {
+            std::unique_lock lock(m_state->mutex);
+            if (!m_state->dirty) return finish(lock);
+            m_path = m_state->path;
+            m_tmpPath = m_path + MAKEU8(".tmp");
+            m_header = m_state->header;
+            memcpy(m_data, m_state->data, c_cardSize);
+            m_state->dirty = false;
         }
+        int ret = uv_fs_open(m_loop, &m_req, reinterpret_cast<const char *>(m_tmpPath.c_str()),
+                             UV_FS_O_WRONLY | UV_FS_O_CREAT | UV_FS_O_TRUNC, 0644,
+                             [](uv_fs_t *req) { fromReq(req)->opened(); });
+        if (ret < 0) failed("open", ret);
+    }
 
-        fwrite(data + adr, 1, size, f);
-        fclose(f);
-        m_savedToDisk = true;
-        PCSX::g_system->printf(_("Saving memory card %s\n"), fname);
-    } else {
-        // try to create it again if we can't open it
-        f = fopen(fname, "wb");
-        if (f != NULL) {
-            fwrite(data, 1, c_cardSize, f);
-            fclose(f);
+    void opened() {
+        if (m_result < 0) return failed("open", m_result);
+        m_handle = m_result;
+        uv_buf_t bufs[2];
+        bufs[0].base = m_header.data();
+        bufs[0].len = m_header.size();
+        bufs[1].base = m_data;
+        bufs[1].len = c_cardSize;
+        int ret = uv_fs_write(m_loop, &m_req, m_handle, bufs, 2, 0, [](uv_fs_t *req) { fromReq(req)->written(); });
+        if (ret < 0) close("write", ret);
+    }
+
+    void written() {
+        if (m_result < 0) return close("write", m_result);
+        if (size_t(m_result) != m_header.size() + c_cardSize) return close("write", UV_EIO);
+        int ret = uv_fs_fsync(m_loop, &m_req, m_handle, [](uv_fs_t *req) { fromReq(req)->synced(); });
+        if (ret < 0) close("fsync", ret);
+    }
+
+    void synced() {
+        if (m_result < 0) return close("fsync", m_result);
+        close(nullptr, 0);
+    }
+
+    // Closes the temporary file in all cases; errorStep is the step that failed before, if any.
+    void close(const char *errorStep, ssize_t error) {
+        m_errorStep = errorStep;
+        m_error = error;
+        int ret = uv_fs_close(m_loop, &m_req, m_handle, [](uv_fs_t *req) { fromReq(req)->closed(); });
+        if (ret < 0) {
+            m_result = ret;
+            closed();
+        }
+    }
+
+    void closed() {
+        m_handle = -1;
+        if (m_errorStep) return failed(m_errorStep, m_error);
+        if (m_result < 0) return failed("close", m_result);
+        int ret = uv_fs_rename(m_loop, &m_req, reinterpret_cast<const char *>(m_tmpPath.c_str()),
+                               reinterpret_cast<const char *>(m_path.c_str()),
+                               [](uv_fs_t *req) { fromReq(req)->renamed(); });
+        if (ret < 0) failed("rename", ret);
+    }
+
+    void renamed() {
+        if (m_result < 0) return failed("rename", m_result);
+        s_dataWrittenTotal += m_header.size() + c_cardSize;
+        m_attempts = 0;
+        next();
+    }
+
+    void failed(const char *step, ssize_t error) {
+        g_system->printf(_("Failed to save memory card %s (%s: %s)\n"), reinterpret_cast<const char *>(m_path.c_str()),
+                         step, uv_strerror(int(error)));
+        std::unique_lock lock(m_state->mutex);
+        // The state's data is at least as recent as the snapshot we just failed to write.
+        m_state->dirty = true;
+        if (++m_attempts >= c_maxAttempts) {
+            g_system->printf(_("Giving up on saving memory card %s for now\n"),
+                             reinterpret_cast<const char *>(m_path.c_str()));
+            return finish(lock);
         }
+        lock.unlock();
+        uv_timer_start(
+            &m_retryTimer, [](uv_timer_t *timer) { reinterpret_cast<Writer *>(timer->data)->next(); }, c_retryDelayMs,
+            0);
+    }
+
+    void finish(std::unique_lock<std::mutex> &lock) {
+        m_state->running = false;
+        m_state->cv.notify_all();
+        lock.unlock();
+        uv_close(reinterpret_cast<uv_handle_t *>(&m_retryTimer),
+                 [](uv_handle_t *handle) { delete reinterpret_cast<Writer *>(handle->data); });
+    }
+
+    std::shared_ptr<FlushState> m_state;
+    uv_loop_t *m_loop;
+    uv_fs_t m_req;
+    uv_timer_t m_retryTimer;
+    uv_file m_handle = -1;
+    ssize_t m_result = 0;
+    const char *m_errorStep = nullptr;
+    ssize_t m_error = 0;
+    unsigned m_attempts = 0;
+    PCSX::u8string m_path;
+    PCSX::u8string m_tmpPath;
+    std::string m_header;
+    char m_data[c_cardSize];
+};
+
+void PCSX::MemoryCard::scheduleFlush(PCSX::u8string mcd) {
+    if (std::filesystem::path(mcd).is_relative()) {
+        mcd = (g_system->getPersistentDir() / mcd).u8string();
+    }
+    if (!m_flushState) m_flushState = std::make_shared<FlushState>();
+
+    bool start = false;
+    {
+        std::unique_lock lock(m_flushState->mutex);
+        if (m_flushState->path != mcd) {
+            m_flushState->path = mcd;
+            m_dirtySectors.set();
+        }
+        m_flushState->header = m_header;
+        for (size_t sector = 0; sector < c_sectorCount; sector++) {
+            if (!m_dirtySectors.test(sector)) continue;
+            memcpy(m_flushState->data + sector * c_sectorSize, m_mcdData + sector * c_sectorSize, c_sectorSize);
+        }
+        m_flushState->dirty = true;
+        start = !m_flushState->running;
+        m_flushState->running = true;
+    }
+    // Only handed over at this point; the writer decides when it's actually on the disk.
+    m_dirtySectors.reset();
+    m_flushPending = false;
+    if (start) Writer::start(m_flushState);
+}
+
+void PCSX::MemoryCard::waitForFlush() {
+    if (!m_flushState) return;
+    std::unique_lock lock(m_flushState->mutex);
+    if (m_flushState->dirty && !m_flushState->running && !m_flushState->path.empty()) {
+        m_flushState->running = true;
+        Writer::start(m_flushState);
     }
+    m_flushState->cv.wait(lock, [this]() { return !m_flushState->running; });
 }
 
 void PCSX::MemoryCard::createMcd(PCSX::u8string mcd) {
@@ -21,6 +21,10 @@
 
 #include <stdint.h>
 
+#include <bitset>
+#include <memory>
+#include <string>
+
 #include "core/sstate.h"
 
 namespace PCSX {
@@ -43,19 +47,27 @@ class MemoryCard {
     }
 
     // File system / data manipulation
+    // Writes are handed over to the UV thread, which coalesces them and atomically
+    // replaces the card file, so that saving never stalls the emulation thread.
     void commit(const PCSX::u8string path) {
-        if (!m_savedToDisk) {
-            saveMcd(path);
+        if (m_flushPending) {
+            scheduleFlush(path);
         }
     }
     void createMcd(PCSX::u8string mcd);
-    bool dataChanged() { return !m_savedToDisk; }
+    // True when sectors were written since the last time the card was handed over to the writer.
+    bool dataChanged() { return m_flushPending; }
     void disablePocketstation() { m_pocketstationEnabled = false; };
     void enablePocketstation() { m_pocketstationEnabled = true; };
     char *getMcdData() { return m_mcdData; }
     void loadMcd(PCSX::u8string mcd);
-    void saveMcd(PCSX::u8string mcd, const char *data, uint32_t adr, size_t size);
-    void saveMcd(PCSX::u8string mcd) { saveMcd(mcd, m_mcdData, 0, c_cardSize); }
+    void saveMcd(PCSX::u8string mcd) {
+        m_dirtySectors.set();
+        scheduleFlush(mcd);
+    }
+    // Blocks until every write handed over to the UV thread has reached the disk. If the writer
+    // gave up on a previous snapshot because of errors, it gets another round of attempts first.
+    void waitForFlush();
 
   private:
     enum Commands : uint8_t {
@@ -100,6 +112,7 @@ class MemoryCard {
     static constexpr size_t c_sectorSize = 8 * 16;
     static constexpr size_t c_blockSize = 8192;
     static constexpr size_t c_cardSize = 1024 * c_sectorSize;
+    static constexpr size_t c_sectorCount = c_cardSize / c_sectorSize;
 
     // State machine / handlers
     uint8_t transceive(uint8_t value);
@@ -110,9 +123,18 @@ class MemoryCard {
     uint8_t tickPS_PrepFileExec(uint8_t value);  // 59h
     uint8_t tickPS_ExecCustom(uint8_t value);    // 5Dh
 
+    // Asynchronous persistence
+    struct FlushState;
+    class Writer;
+    void scheduleFlush(PCSX::u8string mcd);
+
     char m_mcdData[c_cardSize];
     uint8_t m_tempBuffer[c_sectorSize];
-    bool m_savedToDisk = false;
+    bool m_flushPending = false;
+    std::bitset<c_sectorCount> m_dirtySectors;
+    // VGS and DexDrive images have a header in front of the card data, which we need to preserve.
+    std::string m_header;
+    std::shared_ptr<FlushState> m_flushState;
 
     uint8_t m_checksumIn = 0, m_checksumOut = 0;
     uint16_t m_commandTicks = 0;
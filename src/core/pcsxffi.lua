@@ -90,6 +90,29 @@ void loadSaveStateFromFile(LuaFile*);
 LuaFile* getMemoryAsFile();
 
 void quit(int code);
+
+typedef bool (*LuaMemoryReader)(uint32_t address, unsigned size, uint32_t* value);
+typedef bool (*LuaMemoryWriter)(uint32_t address, unsigned size, uint32_t value);
+unsigned addMemoryHandler(uint32_t address, uint32_t length, LuaMemoryReader reader, LuaMemoryWriter writer);
+void removeMemoryHandler(unsigned id);
+void setFallbackMemoryHandler(LuaMemoryReader reader, LuaMemoryWriter writer);
+uint32_t readMemory(uint32_t address, unsigned size);
+void writeMemory(uint32_t address, unsigned size, uint32_t value);
+
+bool blockCountersSupported();
+bool blockCountersEnabled();
+void enableBlockCounters(bool enabled);
+void resetBlockCounters();
+void writeBlockCounters(LuaFile*);
+
+uint64_t getHLECallCount(uint32_t call);
+
+void startSampler(uint64_t interval);
+void stopSampler();
+void resetSampler();
+bool samplerEnabled();
+uint64_t samplerDroppedSamples();
+LuaSlice* samplerFolded();
 ]]
 
 local C = ffi.load 'PCSX'
@@ -154,6 +177,146 @@ local function addBreakpoint(address, bptype, width, cause, invoker, label)
     return bp
 end
 
+local function createMemoryReader(reader, onError)
+    return ffi.cast('LuaMemoryReader', function(address, size, value)
+        local ok, ret = pcall(reader, address, size)
+        if not ok then
+            onError(ret)
+            return false
+        end
+        if type(ret) ~= 'number' then return false end
+        value[0] = ret
+        return true
+    end)
+end
+
+local function createMemoryWriter(writer, onError)
+    return ffi.cast('LuaMemoryWriter', function(address, size, value)
+        local ok, ret = pcall(writer, address, size, value)
+        if not ok then
+            onError(ret)
+            return false
+        end
+        return ret == true
+    end)
+end
+
+local function removeMemoryHandler(handler)
+    if handler._id == 0 then return end
+    C.removeMemoryHandler(handler._id)
+    handler._id = 0
+    if handler._readercb ~= nil then handler._readercb:free() end
+    if handler._writercb ~= nil then handler._writercb:free() end
+    handler._readercb = nil
+    handler._writercb = nil
+end
+
+local function addMemoryHandler(address, length, reader, writer)
+    if type(address) ~= 'number' then error 'PCSX.addMemoryHandler needs an address' end
+    if type(length) ~= 'number' then error 'PCSX.addMemoryHandler needs a length' end
+    if reader ~= nil and type(reader) ~= 'function' then error 'PCSX.addMemoryHandler needs a reader that is a function' end
+    if writer ~= nil and type(writer) ~= 'function' then error 'PCSX.addMemoryHandler needs a writer that is a function' end
+    local handler = { _proxy = newproxy() }
+    -- Handlers can't be removed from within their own callbacks, so errors only disable them.
+    local function onError(msg)
+        printError(msg)
+        handler._disabled = true
+    end
+    if reader ~= nil then
+        handler._readercb = createMemoryReader(function(...)
+            if handler._disabled then return nil end
+            return reader(...)
+        end, onError)
+    end
+    if writer ~= nil then
+        handler._writercb = createMemoryWriter(function(...)
+            if handler._disabled then return false end
+            return writer(...)
+        end, onError)
+    end
+    handler._id = C.addMemoryHandler(address, length, handler._readercb, handler._writercb)
+    handler.remove = function(handler) removeMemoryHandler(handler) end
+    debug.setmetatable(handler._proxy, { __gc = function() removeMemoryHandler(handler) end })
+    return handler
+end
+
+-- Scripts used to define the global functions UnknownMemoryRead and UnknownMemoryWrite, which the core
+-- had to look up on every unmapped access. They are now routed through the core's fallback memory handler,
+-- which is only installed while at least one of them is set, using PCSX.setUnknownMemoryHooks.
+local unknownMemoryHooks = {}
+local unknownMemoryReader = createMemoryReader(function(address, size)
+    local hook = unknownMemoryHooks.read
+    if hook == nil then return nil end
+    return hook(address, size)
+end, function(msg)
+    printError(msg)
+    unknownMemoryHooks.read = nil
+end)
+local unknownMemoryWriter = createMemoryWriter(function(address, size, value)
+    local hook = unknownMemoryHooks.write
+    if hook == nil then return false end
+    return hook(address, size, value)
+end, function(msg)
+    printError(msg)
+    unknownMemoryHooks.write = nil
+end)
+local unknownMemoryHooksInstalled = false
+
+local function setUnknownMemoryHooks(reader, writer)
+    if reader ~= nil and type(reader) ~= 'function' then
+        error 'PCSX.setUnknownMemoryHooks needs a reader that is a function'
+    end
+    if writer ~= nil and type(writer) ~= 'function' then
+        error 'PCSX.setUnknownMemoryHooks needs a writer that is a function'
+    end
+    unknownMemoryHooks.read = reader
+    unknownMemoryHooks.write = writer
+    local needed = reader ~= nil or writer ~= nil
+    if needed == unknownMemoryHooksInstalled then return end
+    unknownMemoryHooksInstalled = needed
+    if needed then
+        C.setFallbackMemoryHandler(unknownMemoryReader, unknownMemoryWriter)
+    else
+        C.setFallbackMemoryHandler(nil, nil)
+    end
+end
+
+-- Assigning the legacy globals still works: the globals' metatable, whichever one is already there, gets
+-- its __newindex chained so these two names are forwarded to setUnknownMemoryHooks. There's deliberately
+-- no __index counterpart, so lookups of undefined globals aren't slowed down, which means the legacy names
+-- read back as nil. Scripts replacing the globals' metatable afterwards need to use the function instead.
+do
+    local mt = getmetatable(_G)
+    if mt == nil then
+        mt = {}
+        setmetatable(_G, mt)
+    end
+    local previousNewIndex = mt.__newindex
+    mt.__newindex = function(t, k, v)
+        if k == 'UnknownMemoryRead' then
+            setUnknownMemoryHooks(v, unknownMemoryHooks.write)
+        elseif k == 'UnknownMemoryWrite' then
+            setUnknownMemoryHooks(unknownMemoryHooks.read, v)
+        elseif type(previousNewIndex) == 'function' then
+            previousNewIndex(t, k, v)
+        elseif previousNewIndex ~= nil then
+            previousNewIndex[k] = v
+        else
+            rawset(t, k, v)
+        end
+    end
+end
+
+local function getBlockCounters()
+    local file = Support.File.buffer()
+    C.writeBlockCounters(file._wrapper)
+    local ret = {}
+    local count = file:readU32At(8)
+    for i = 0, count - 1 do ret[file:readU32At(12 + i * 12)] = file:readU64At(16 + i * 12) end
+    file:close()
+    return ret
+end
+
 local function printLike(callback, ...)
     local s = ''
     for i, v in ipairs({ ... }) do s = s .. tostring(v) .. ' ' end
@@ -182,6 +345,10 @@ PCSX = {
     getReadLUT = function() return C.getReadLUT() end,
     getWriteLUT = function() return C.getWriteLUT() end,
     addBreakpoint = addBreakpoint,
+    addMemoryHandler = addMemoryHandler,
+    setUnknownMemoryHooks = setUnknownMemoryHooks,
+    readMemory = function(address, size) return C.readMemory(address, size or 4) end,
+    writeMemory = function(address, value, size) C.writeMemory(address, size or 4, value) end,
     pauseEmulator = function() C.pauseEmulator() end,
     resumeEmulator = function() C.resumeEmulator() end,
     softResetEmulator = function() C.softResetEmulator() end,
@@ -223,6 +390,23 @@ PCSX = {
     end,
     getMemoryAsFile = function() return Support.File._createFileWrapper(C.getMemoryAsFile()) end,
     quit = function(code) C.quit(code or 0) end,
+    BlockCounters = {
+        supported = function() return C.blockCountersSupported() end,
+        enabled = function() return C.blockCountersEnabled() end,
+        enable = function(enabled) C.enableBlockCounters(enabled ~= false) end,
+        reset = function() C.resetBlockCounters() end,
+        get = getBlockCounters,
+        write = function(file) C.writeBlockCounters(file._wrapper) end,
+    },
+    getHLECallCount = function(call) return tonumber(C.getHLECallCount(call)) end,
+    Sampler = {
+        start = function(interval) C.startSampler(interval or 10000) end,
+        stop = function() C.stopSampler() end,
+        reset = function() C.resetSampler() end,
+        enabled = function() return C.samplerEnabled() end,
+        dropped = function() return C.samplerDroppedSamples() end,
+        folded = function() return tostring(Support.File._createSliceWrapper(C.samplerFolded())) end,
+    },
 }
 
 print = function(...) printLike(function(s) C.luaMessage(s, false) end, ...) end
@@ -24,6 +24,7 @@
 #include "core/psxemulator.h"
 #include "core/psxmem.h"
 #include "core/r3000a.h"
+#include "core/sampler.h"
 #include "core/sstate.h"
 #include "lua/luafile.h"
 #include "lua/luawrapper.h"
@@ -123,6 +124,78 @@ PCSX::LuaFFI::LuaFile* getMemoryAsFile() {
 
 void quit(int code) { PCSX::g_system->quit(code); }
 
+typedef bool (*LuaMemoryReader)(uint32_t address, unsigned size, uint32_t* value);
+typedef bool (*LuaMemoryWriter)(uint32_t address, unsigned size, uint32_t value);
+
+PCSX::Memory::MemoryHandler createMemoryHandler(LuaMemoryReader reader, LuaMemoryWriter writer) {
+    PCSX::Memory::MemoryHandler handler;
+    if (reader) {
+        handler.read = [reader](uint32_t address, unsigned size, uint32_t& value) {
+            return reader(address, size, &value);
+        };
+    }
+    if (writer) {
+        handler.write = [writer](uint32_t address, unsigned size, uint32_t value) {
+            return writer(address, size, value);
+        };
+    }
+    return handler;
+}
+
+unsigned addMemoryHandler(uint32_t address, uint32_t length, LuaMemoryReader reader, LuaMemoryWriter writer) {
+    return PCSX::g_emulator->m_mem->addMemoryHandler(address, length, createMemoryHandler(reader, writer));
+}
+void removeMemoryHandler(unsigned id) { PCSX::g_emulator->m_mem->removeMemoryHandler(id); }
+void setFallbackMemoryHandler(LuaMemoryReader reader, LuaMemoryWriter writer) {
+    PCSX::g_emulator->m_mem->setFallbackMemoryHandler(createMemoryHandler(reader, writer));
+}
+
+// Accesses going through the CPU's view of memory, hardware registers and handlers included.
+uint32_t readMemory(uint32_t address, unsigned size) {
+    auto& mem = PCSX::g_emulator->m_mem;
+    switch (size) {
+        case 1:
+            return mem->read8(address);
+        case 2:
+            return mem->read16(address);
+        default:
+            return mem->read32(address);
+    }
+}
+void writeMemory(uint32_t address, unsigned size, uint32_t value) {
+    auto& mem = PCSX::g_emulator->m_mem;
+    switch (size) {
+        case 1:
+            mem->write8(address, value);
+            break;
+        case 2:
+            mem->write16(address, value);
+            break;
+        default:
+            mem->write32(address, value);
+            break;
+    }
+}
+
+bool blockCountersSupported() { return PCSX::g_emulator->m_cpu->supportsBlockCounters(); }
+bool blockCountersEnabled() { return PCSX::g_emulator->m_cpu->blockCountersEnabled(); }
+void enableBlockCounters(bool enabled) { PCSX::g_emulator->m_cpu->enableBlockCounters(enabled); }
+void resetBlockCounters() { PCSX::g_emulator->m_cpu->resetBlockCounters(); }
+void writeBlockCounters(PCSX::LuaFFI::LuaFile* file) { PCSX::g_emulator->m_cpu->writeBlockCounters(file->file); }
+
+uint64_t getHLECallCount(uint32_t call) { return PCSX::g_emulator->m_cpu->hleCallCount(call); }
+
+void startSampler(uint64_t interval) { PCSX::g_emulator->m_sampler->start(interval); }
+void stopSampler() { PCSX::g_emulator->m_sampler->stop(); }
+void resetSampler() { PCSX::g_emulator->m_sampler->reset(); }
+bool samplerEnabled() { return PCSX::g_emulator->m_sampler->enabled(); }
+uint64_t samplerDroppedSamples() { return PCSX::g_emulator->m_sampler->droppedSamples(); }
+PCSX::Slice* samplerFolded() {
+    auto ret = new PCSX::Slice();
+    ret->copy(PCSX::g_emulator->m_sampler->folded());
+    return ret;
+}
+
 }  // namespace
 
 template <typename T, size_t S>
@@ -166,6 +239,23 @@ static void registerAllSymbols(PCSX::Lua L) {
     REGISTER(L, loadSaveStateFromFile);
     REGISTER(L, getMemoryAsFile);
     REGISTER(L, quit);
+    REGISTER(L, addMemoryHandler);
+    REGISTER(L, removeMemoryHandler);
+    REGISTER(L, setFallbackMemoryHandler);
+    REGISTER(L, readMemory);
+    REGISTER(L, writeMemory);
+    REGISTER(L, blockCountersSupported);
+    REGISTER(L, blockCountersEnabled);
+    REGISTER(L, enableBlockCounters);
+    REGISTER(L, resetBlockCounters);
+    REGISTER(L, writeBlockCounters);
+    REGISTER(L, getHLECallCount);
+    REGISTER(L, startSampler);
+    REGISTER(L, stopSampler);
+    REGISTER(L, resetSampler);
+    REGISTER(L, samplerEnabled);
+    REGISTER(L, samplerDroppedSamples);
+    REGISTER(L, samplerFolded);
     L.settable();
     L.pop();
 }
@@ -34,6 +34,7 @@
 #include "core/pcsxlua.h"
 #include "core/pio-cart.h"
 #include "core/r3000a.h"
+#include "core/sampler.h"
 #include "core/sio.h"
 #include "core/sio1-server.h"
 #include "core/sio1.h"
@@ -51,6 +52,7 @@ extern "C" {
 #include "supportpsx/adpcmlua.h"
 #include "supportpsx/assembler.h"
 #include "supportpsx/binlua.h"
+#include "tracy/public/tracy/Tracy.hpp"
 
 extern "C" int luaopen_lpeg(lua_State* L);
 
@@ -69,6 +71,7 @@ PCSX::Emulator::Emulator()
       m_pads(PCSX::Pads::factory()),
       m_patchManager(new PatchManager()),
       m_pioCart(new PCSX::PIOCart),
+      m_sampler(new PCSX::Sampler()),
       m_sio(new PCSX::SIO()),
       m_sio1(new PCSX::SIO1()),
       m_sio1Server(new PCSX::SIO1Server()),
@@ -166,6 +169,7 @@ void PCSX::Emulator::reset() {
 }
 
 void PCSX::Emulator::shutdown() {
+    m_sio->waitForMcdFlush();
     m_mem->shutdown();
     m_cpu->psxShutdown();
 
@@ -173,6 +177,7 @@ void PCSX::Emulator::shutdown() {
 }
 
 void PCSX::Emulator::vsync() {
+    FrameMarkNamed("PSX VSync");
     m_gpu->vblank();
     g_system->m_eventBus->signal<Events::GPU::VSync>({});
     g_system->update(true);
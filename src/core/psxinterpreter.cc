@@ -26,6 +26,7 @@
 #include "core/pgxp_gte.h"
 #include "core/psxemulator.h"
 #include "core/r3000a.h"
+#include "core/sampler.h"
 #include "tracy/public/tracy/Tracy.hpp"
 
 #undef _PC_
@@ -114,7 +115,8 @@ class InterpretedCPU final : public PCSX::R3000Acpu {
     cIntFunc_t *s_pPsxCP2 = NULL;
     cIntFunc_t *s_pPsxCP2BSC = NULL;
 
-    template <bool debug, bool trace>
+    // The debug path goes one instruction at a time already, so it always lets the sampler have a look.
+    template <bool debug, bool trace, bool sample = debug>
     void execBlock();
     void doBranch(uint32_t target, bool fromLink);
 
@@ -1576,7 +1578,11 @@ void InterpretedCPU::Execute() {
             }
         } else {
             if (!trace || (skipISR && m_inISR)) {
-                execBlock<false, false>();
+                if (PCSX::g_emulator->m_sampler->enabled()) {
+                    execBlock<false, false, true>();
+                } else {
+                    execBlock<false, false>();
+                }
             } else {
                 execBlock<false, true>();
             }
@@ -1593,7 +1599,7 @@ void InterpretedCPU::Clear(uint32_t Addr, uint32_t Size) {
 
 void InterpretedCPU::Shutdown() {}
 // interpreter execution
-template <bool debug, bool trace>
+template <bool debug, bool trace, bool sample>
 inline void InterpretedCPU::execBlock() {
     bool ranDelaySlot = false;
     do {
@@ -1613,6 +1619,8 @@ inline void InterpretedCPU::execBlock() {
             PCSX::g_system->log(PCSX::LogClass::CPU, "%s\n", ins);
         }
 
+        if constexpr (sample) PCSX::g_emulator->m_sampler->maybeSample(m_regs.cycle, pc);
+
         m_regs.pc += 4;
         m_regs.cycle += PCSX::Emulator::BIAS;
 
@@ -1633,6 +1641,8 @@ inline void InterpretedCPU::execBlock() {
             m_inDelaySlot = false;
             ranDelaySlot = true;
             InterceptBIOS<true>(m_regs.pc);
+            // Don't bypass the BIOS code if a load from the call's delay slot is still in flight
+            if (!m_delayedLoadInfo[0].active && !m_delayedLoadInfo[1].active) HLEKernelCall<true>(m_regs.pc);
             branchTest();
         }
         if constexpr (debug) {
@@ -21,6 +21,7 @@
 
 #include <zlib.h>
 
+#include <algorithm>
 #include <map>
 #include <string_view>
 
@@ -269,11 +270,8 @@ uint8_t PCSX::Memory::read8(uint32_t address) {
         }
     } else if ((page & 0x1fff) >= 0x1f00 && (page & 0x1fff) < 0x1f80 && pioConnected) {
         return g_emulator->m_pioCart->read8(address);
-    } else if (sendReadToLua(address, 1)) {
-        auto L = *g_emulator->m_lua;
-        const uint8_t ret = L.tonumber();
-        L.pop();
-        return ret;
+    } else if (uint32_t value = 0; dispatchRead(address, 1, value)) {
+        return value;
     } else if (address == 0x1f000004 || address == 0x1f000084) {
         // EXP1 not mapped, likely the bios looking for pre/post boot entry point
         // We probably don't want to pause here so just throw it a dummy value
@@ -305,11 +303,8 @@ uint16_t PCSX::Memory::read16(uint32_t address) {
         }
     } else if ((page & 0x1fff) >= 0x1f00 && (page & 0x1fff) < 0x1f80 && pioConnected) {
         return g_emulator->m_pioCart->read8(address);
-    } else if (sendReadToLua(address, 2)) {
-        auto L = *g_emulator->m_lua;
-        const uint16_t ret = L.tonumber();
-        L.pop();
-        return ret;
+    } else if (uint32_t value = 0; dispatchRead(address, 2, value)) {
+        return value;
     } else if (isiCacheEnabled()) {
         g_system->log(LogClass::CPU, _("16-bit read from unknown address: %8.8lx\n"), address);
         if (g_emulator->settings.get<Emulator::SettingDebugSettings>().get<Emulator::DebugSettings::Debug>()) {
@@ -339,11 +334,8 @@ uint32_t PCSX::Memory::read32(uint32_t address, ReadType readType) {
         return g_emulator->m_pioCart->read32(address);
     } else if (address == 0xfffe0130) {
         return m_BIU;
-    } else if (sendReadToLua(address, 4)) {
-        auto L = *g_emulator->m_lua;
-        const uint32_t ret = L.tonumber();
-        L.pop();
-        return ret;
+    } else if (uint32_t value = 0; dispatchRead(address, 4, value)) {
+        return value;
     } else if (isiCacheEnabled()) {
         g_system->log(LogClass::CPU, _("32-bit read from unknown address: %8.8lx\n"), address);
         if (g_emulator->settings.get<Emulator::SettingDebugSettings>().get<Emulator::DebugSettings::Debug>()) {
@@ -353,78 +345,54 @@ uint32_t PCSX::Memory::read32(uint32_t address, ReadType readType) {
     return 0xffffffff;
 }
 
-int PCSX::Memory::sendReadToLua(const uint32_t address, const size_t size) {
-    // Grab a local pointer for our Lua VM interpreter
-    auto L = *g_emulator->m_lua;
-    int nresult = 0;
-    // Try getting the symbol 'UnknownMemoryRead' from the global space, and put it on top of the stack
-    L.getfield("UnknownMemoryRead", LUA_GLOBALSINDEX);
-    // If top-of-stack is not nil, then we're going to try calling it.
-    if (!L.isnil()) {
-        try {
-            // Call the function. Technically we should empty
-            // the stack afterward to clean potential return
-            // values from the Lua code, this is a bug in the gui code.
-            const int top = L.gettop();
-            L.push(lua_Number(address));
-            L.push(lua_Number(size));
-            nresult = L.pcall(2);
-            // Discard anything more than 1 result
-            for (int n = 1; n < nresult; n++) {
-                L.pop();
-            }
-        } catch (...) {
-            // If there is any error while executing the Lua code,
-            // push the string "UnknownMemoryRead" on top of the stack,
-            L.push("UnknownMemoryRead");
-            // then push the value "nil" (rough equivalent of NULL in Lua)
-            L.push();
-            // This will pop a key/value pair from the stack, and set
-            // the corresponding value in the global space. This effectively
-            // deletes the global function on errors.
-            L.settable(LUA_GLOBALSINDEX);
-        }
-    } else {
-        // This pops the nil from the stack.
-        L.pop();
+unsigned PCSX::Memory::addMemoryHandler(uint32_t address, uint32_t length, MemoryHandler &&handler) {
+    if (length == 0) return 0;
+    const unsigned id = m_nextHandlerId++;
+    const uint32_t start = handlerAddress(address);
+    auto &rangeHandler = m_rangeHandlers.emplace_back(RangeHandler{id, start, length, std::move(handler)});
+    if (!m_handlerLUT) m_handlerLUT = std::make_unique<std::vector<RangeHandler *>[]>(0x10000);
+    const uint64_t last = std::min(uint64_t(start) + length - 1, uint64_t(0xffffffff));
+    for (uint64_t page = start >> 16; page <= (last >> 16); page++) {
+        m_handlerLUT[page].push_back(&rangeHandler);
     }
-
-    return nresult;
+    return id;
 }
 
-bool PCSX::Memory::sendWriteToLua(const uint32_t address, const size_t size, uint32_t value) {
-    auto L = *g_emulator->m_lua;
-    bool write_handled = false;
-
-    L.getfield("UnknownMemoryWrite", LUA_GLOBALSINDEX);
-    if (!L.isnil()) {
-        try {
-            const int top = L.gettop();
-            L.push(lua_Number(address));
-            L.push(lua_Number(size));
-            L.push(lua_Number(value));
-            int nresult = L.pcall(3);
-
-            if (nresult > 0) {
-                // Discard anything more than 1 result
-                for (int n = 1; n < nresult; n++) {
-                    L.pop();
-                }
-
-                write_handled = L.toboolean();
-                L.pop();
-            }
+void PCSX::Memory::removeMemoryHandler(unsigned id) {
+    auto it = std::find_if(m_rangeHandlers.begin(), m_rangeHandlers.end(),
+                           [id](const RangeHandler &h) { return h.id == id; });
+    if (it == m_rangeHandlers.end()) return;
+    const uint64_t last = std::min(uint64_t(it->start) + it->length - 1, uint64_t(0xffffffff));
+    for (uint64_t page = it->start >> 16; page <= (last >> 16); page++) {
+        auto &handlers = m_handlerLUT[page];
+        handlers.erase(std::remove(handlers.begin(), handlers.end(), &*it), handlers.end());
+    }
+    m_rangeHandlers.erase(it);
+    if (m_rangeHandlers.empty()) m_handlerLUT.reset();
+}
 
-        } catch (...) {
-            L.push("UnknownMemoryWrite");
-            L.push();
-            L.settable(LUA_GLOBALSINDEX);
+bool PCSX::Memory::dispatchRead(uint32_t address, unsigned size, uint32_t &value) {
+    if (m_handlerLUT) {
+        const uint32_t physical = handlerAddress(address);
+        for (auto handler : m_handlerLUT[physical >> 16]) {
+            if ((physical - handler->start) >= handler->length) continue;
+            if (handler->handler.read && handler->handler.read(address, size, value)) return true;
         }
-    } else {
-        L.pop();
     }
+    if (m_fallbackHandler.read) return m_fallbackHandler.read(address, size, value);
+    return false;
+}
 
-    return write_handled;
+bool PCSX::Memory::dispatchWrite(uint32_t address, unsigned size, uint32_t value) {
+    if (m_handlerLUT) {
+        const uint32_t physical = handlerAddress(address);
+        for (auto handler : m_handlerLUT[physical >> 16]) {
+            if ((physical - handler->start) >= handler->length) continue;
+            if (handler->handler.write && handler->handler.write(address, size, value)) return true;
+        }
+    }
+    if (m_fallbackHandler.write) return m_fallbackHandler.write(address, size, value);
+    return false;
 }
 
 void PCSX::Memory::write8(uint32_t address, uint32_t value) {
@@ -445,7 +413,7 @@ void PCSX::Memory::write8(uint32_t address, uint32_t value) {
         }
     } else if ((page & 0x1fff) >= 0x1f00 && (page & 0x1fff) < 0x1f80 && pioConnected) {
         g_emulator->m_pioCart->write8(address, value);
-    } else if (sendWriteToLua(address, 1, value)) {
+    } else if (dispatchWrite(address, 1, value)) {
     } else if (isiCacheEnabled()) {
         g_emulator->m_cpu->Clear(address, 1);
         g_system->log(LogClass::CPU, _("8-bit write to unknown address: %8.8lx\n"), address);
@@ -474,7 +442,7 @@ void PCSX::Memory::write16(uint32_t address, uint32_t value) {
         }
     } else if ((page & 0x1fff) >= 0x1f00 && (page & 0x1fff) < 0x1f80 && pioConnected) {
         g_emulator->m_pioCart->write16(address, value);
-    } else if (sendWriteToLua(address, 2, value)) {
+    } else if (dispatchWrite(address, 2, value)) {
     } else if (isiCacheEnabled()) {
         g_emulator->m_cpu->Clear(address, 1);
         g_system->log(LogClass::CPU, _("16-bit write to unknown address: %8.8lx\n"), address);
@@ -521,7 +489,7 @@ void PCSX::Memory::write32(uint32_t address, uint32_t value) {
                 }
                 break;
         }
-    } else if (sendWriteToLua(address, 4, value)) {
+    } else if (dispatchWrite(address, 4, value)) {
     } else if (isiCacheEnabled()) {
         g_emulator->m_cpu->Clear(address, 1);
         g_system->log(LogClass::CPU, _("32-bit write to unknown address: %8.8lx\n"), address);
@@ -19,6 +19,9 @@
 
 #pragma once
 
+#include <functional>
+#include <list>
+#include <memory>
 #include <string_view>
 #include <vector>
 
@@ -187,8 +190,20 @@ class Memory {
     std::string_view getBiosVersionString();
 
     bool loadEXP1FromFile(std::filesystem::path rom_path);
-    int sendReadToLua(uint32_t address, size_t size);
-    bool sendWriteToLua(uint32_t address, size_t size, uint32_t value);
+
+    // Handlers for address ranges which aren't backed by the LUTs, such as custom expansion hardware.
+    // They are only consulted after an access missed the LUTs, the hardware registers and the PIO cart,
+    // and are looked up through a per-64KB-page table. Ranges are physical: the KUSEG, KSEG0 and KSEG1
+    // mirrors all reach the same handler, which receives the original address. A handler returns true
+    // when it handled the access. Handlers must not be removed from within their own callbacks.
+    struct MemoryHandler {
+        std::function<bool(uint32_t address, unsigned size, uint32_t &value)> read;
+        std::function<bool(uint32_t address, unsigned size, uint32_t value)> write;
+    };
+    unsigned addMemoryHandler(uint32_t address, uint32_t length, MemoryHandler &&handler);
+    void removeMemoryHandler(unsigned id);
+    // The fallback handler sees every unmapped access not claimed by a range handler.
+    void setFallbackMemoryHandler(MemoryHandler &&handler) { m_fallbackHandler = std::move(handler); }
 
     class MemoryAsFile : public File {
       public:
@@ -232,6 +247,23 @@ class Memory {
     friend class MemoryAsFile;
     IO<MemoryAsFile> m_memoryAsFile;
 
+    struct RangeHandler {
+        unsigned id;
+        uint32_t start;
+        uint32_t length;
+        MemoryHandler handler;
+    };
+    static constexpr uint32_t handlerAddress(uint32_t address) {
+        return address < 0xc0000000 ? address & 0x1fffffff : address;
+    }
+    bool dispatchRead(uint32_t address, unsigned size, uint32_t &value);
+    bool dispatchWrite(uint32_t address, unsigned size, uint32_t value);
+    std::list<RangeHandler> m_rangeHandlers;
+    // Only allocated while at least one range handler is registered.
+    std::unique_ptr<std::vector<RangeHandler *>[]> m_handlerLUT;
+    MemoryHandler m_fallbackHandler;
+    unsigned m_nextHandlerId = 1;
+
     uint32_t m_biosCRC = 0;
 
     // Shared memory wrappers, pointers below point to these where appropriate
@@ -23,12 +23,15 @@
 
 #include "core/r3000a.h"
 
+#include <optional>
+
 #include "core/cdrom.h"
 #include "core/debug.h"
 #include "core/gpu.h"
 #include "core/gte.h"
 #include "core/mdec.h"
 #include "core/pgxp_mem.h"
+#include "core/sampler.h"
 #include "core/sio.h"
 #include "core/sio1.h"
 #include "core/spu.h"
@@ -46,6 +49,16 @@ int PCSX::R3000Acpu::psxInit() {
 
     if (!g_emulator->m_cpu) g_emulator->m_cpu = Cpus::Interpreted();
 
+    std::string stateTrace(args.getStateTracePath());
+    if (!stateTrace.empty()) {
+        IO<File> file(new PosixFile(stateTrace, FileOps::TRUNCATE));
+        if (file->failed()) {
+            g_system->printf(_("Unable to open state trace file %s\n"), stateTrace.c_str());
+        } else {
+            g_emulator->m_cpu->startStateTrace(file);
+        }
+    }
+
     PGXP_Init();
     g_system->printf(_("CPU type: %s\n"), g_emulator->m_cpu->getName().c_str());
 
@@ -57,6 +70,7 @@ void PCSX::R3000Acpu::psxReset() {
 
     memset(&m_regs, 0, sizeof(m_regs));
     m_shellStarted = false;
+    memset(m_hleCallCounts, 0, sizeof(m_hleCallCounts));
     m_inISR = false;
     m_nextIsDelaySlot = false;
     m_inDelaySlot = false;
@@ -75,11 +89,97 @@ void PCSX::R3000Acpu::psxReset() {
     m_regs.CP0.r[15] = 0x00000002;  // PRevID = Revision ID, same as R3000A
 
     PCSX::g_emulator->m_hw->reset();
+
+    if (m_stateTracing) recordState(StateTraceRecord::Exception, ~uint64_t(0));
+}
+
+void PCSX::R3000Acpu::psxShutdown() {
+    stopStateTrace();
+    Shutdown();
+}
+
+void PCSX::R3000Acpu::writeBlockCounters(IO<File> file) {
+    std::vector<std::pair<uint32_t, uint64_t>> counters;
+    forEachBlockCounter([&counters](uint32_t pc, uint64_t count) { counters.emplace_back(pc, count); });
+
+    file->write<uint32_t>(0x544e4342);  // "BCNT"
+    file->write<uint32_t>(1);
+    file->write<uint32_t>(counters.size());
+    for (auto& [pc, count] : counters) {
+        file->write<uint32_t>(pc);
+        file->write<uint64_t>(count);
+    }
+}
+
+void PCSX::R3000Acpu::startStateTrace(IO<File> file) {
+    stopStateTrace();
+    m_stateTrace = file;
+    m_stateTrace->write<uint32_t>(0x43525453);  // "STRC"
+    m_stateTrace->write<uint32_t>(2);
+    m_stateTracing = true;
+}
+
+// FNV-1a, on 32 bits words rather than bytes, since it runs over a RAM page at every event check
+static uint64_t hashStateTraceMemory(const uint8_t* data, uint32_t size) {
+    uint64_t hash = 0xcbf29ce484222325;
+    for (uint32_t i = 0; i < size; i += 4) {
+        uint32_t word;
+        memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 0x100000001b3;
+    }
+    return hash;
 }
 
-void PCSX::R3000Acpu::psxShutdown() { Shutdown(); }
+void PCSX::R3000Acpu::stopStateTrace() {
+    if (!m_stateTracing) return;
+    const uint32_t ramSize = g_emulator->settings.get<Emulator::Setting8MB>() ? 0x800000 : 0x200000;
+    recordState(StateTraceRecord::End, hashStateTraceMemory(g_emulator->m_mem->m_wram, ramSize));
+    m_stateTracing = false;
+    m_stateTrace->close();
+    m_stateTrace.reset();
+}
+
+void PCSX::R3000Acpu::recordState(StateTraceRecord kind, uint64_t value) {
+    switch (kind) {
+        case StateTraceRecord::EventCheck: {
+            if (m_delayedLoadInfo[0].active || m_delayedLoadInfo[1].active) return;
+            // FNV-1a over all the GPRs, lo and hi, except $k0 and $k1 which the kernel freely clobbers
+            uint64_t hash = 0xcbf29ce484222325;
+            for (unsigned i = 1; i < 34; i++) {
+                if ((i == 26) || (i == 27)) continue;
+                uint32_t r = m_regs.GPR.r[i];
+                for (unsigned b = 0; b < 4; b++) {
+                    hash = (hash ^ ((r >> (b * 8)) & 0xff)) * 0x100000001b3;
+                }
+            }
+            writeStateRecord(kind, hash);
+            constexpr uint32_t c_pageSize = 0x1000;
+            const uint32_t ramSize = g_emulator->settings.get<Emulator::Setting8MB>() ? 0x800000 : 0x200000;
+            const uint32_t page = (m_regs.cycle / Emulator::BIAS) % (ramSize / c_pageSize);
+            writeStateRecord(StateTraceRecord::Memory,
+                             hashStateTraceMemory(g_emulator->m_mem->m_wram + page * c_pageSize, c_pageSize));
+            return;
+        }
+        case StateTraceRecord::Exception:
+            m_stateTraceEpoch++;
+            break;
+        case StateTraceRecord::End:
+        case StateTraceRecord::Memory:
+            break;
+    }
+    writeStateRecord(kind, value);
+}
+
+void PCSX::R3000Acpu::writeStateRecord(StateTraceRecord kind, uint64_t value) {
+    m_stateTrace->write<uint32_t>(magic_enum::enum_integer(kind));
+    m_stateTrace->write<uint32_t>(m_regs.pc);
+    m_stateTrace->write<uint64_t>(m_regs.cycle);
+    m_stateTrace->write<uint64_t>(m_stateTraceEpoch);
+    m_stateTrace->write<uint64_t>(value);
+}
 
 void PCSX::R3000Acpu::exception(uint32_t code, bool bd, bool cop0) {
+    if (m_stateTracing) recordState(StateTraceRecord::Exception, code);
     auto& emuSettings = g_emulator->settings;
     auto& debugSettings = emuSettings.get<Emulator::SettingDebugSettings>();
     unsigned ec = (code >> 2) & 0x1f;
@@ -350,12 +450,17 @@ void PCSX::R3000Acpu::branchTest() {
     }
 #endif
 
+    if (m_stateTracing) recordState(StateTraceRecord::EventCheck, 0);
+
     const uint64_t cycle = m_regs.cycle;
 
     if (cycle >= g_emulator->m_counters->m_psxNextCounter) g_emulator->m_counters->update();
 
     if (m_regs.spuInterrupt.exchange(false)) g_emulator->m_spu->interrupt();
 
+    // The interpreter samples on its own, on every instruction.
+    if (g_emulator->m_sampler->enabled() && isDynarec()) g_emulator->m_sampler->maybeSample(cycle, m_regs.pc);
+
     const uint32_t interrupts = m_regs.interrupt;
 
     int32_t lowestDistance = std::numeric_limits<int64_t>::max();
@@ -415,6 +520,174 @@ void PCSX::R3000Acpu::branchTest() {
     }
 }
 
+static bool isIdleSafeAddress(uint32_t address) {
+    const uint32_t physical = address & 0x1fffffff;
+    if (physical < 0x00800000) return true;                                // RAM and its mirrors
+    if ((physical >= 0x1f800000) && (physical < 0x1f800400)) return true;  // Scratchpad
+    if ((physical >= 0x1f801070) && (physical < 0x1f801078)) return true;  // I_STAT and I_MASK
+    if ((physical >= 0x1f801080) && (physical < 0x1f801100)) return true;  // DMA registers
+    if ((physical >= 0x1f801814) && (physical < 0x1f801818)) return true;  // GPUSTAT
+    if ((physical >= 0x1fc00000) && (physical < 0x1fc80000)) return true;  // BIOS
+    // Everything else may have read side effects, or change with the cycle count, like the root counters.
+    return false;
+}
+
+bool PCSX::R3000Acpu::isIdleLoop(uint32_t pc) {
+    constexpr unsigned c_maxLength = 16;
+    auto& mem = g_emulator->m_mem;
+
+    uint32_t written = 0;            // Registers written so far during this iteration
+    uint32_t readBeforeWritten = 0;  // Registers read before being written, i.e. carried from the previous iteration
+    uint32_t constants[32] = {};     // Values known at this point of the iteration, computed within the loop
+    uint32_t constMask = 1;          // $zero is always known
+    int pendingLoad = -1;            // Destination of a load whose delay slot is the current instruction
+    bool inDelaySlot = false;
+
+    for (unsigned i = 0; i < c_maxLength; i++) {
+        const uint32_t* ptr = mem->getPointer<uint32_t>(pc + i * 4);
+        if (!ptr) return false;
+        const uint32_t code = *ptr;
+        const uint32_t instructionPC = pc + i * 4;
+
+        const unsigned rs = _fRs_(code);
+        const unsigned rt = _fRt_(code);
+        const unsigned rd = _fRd_(code);
+        uint32_t reads = 0;
+        int write = -1;
+        bool isLoad = false;
+        bool isBranch = false;
+        std::optional<uint32_t> target;
+        std::optional<uint32_t> result;
+
+        const auto isConst = [&constMask](unsigned reg) { return (constMask & (1u << reg)) != 0; };
+
+        switch (_fOp_(code)) {
+            case 0x00:  // SPECIAL
+                switch (_fFunct_(code)) {
+                    case 0x00:  // SLL
+                    case 0x02:  // SRL
+                    case 0x03:  // SRA
+                        reads = 1 << rt;
+                        write = rd;
+                        break;
+                    case 0x20:  // ADD
+                    case 0x21:  // ADDU
+                    case 0x23:  // SUBU
+                    case 0x24:  // AND
+                    case 0x25:  // OR
+                    case 0x26:  // XOR
+                    case 0x27:  // NOR
+                    case 0x2a:  // SLT
+                    case 0x2b:  // SLTU
+                        reads = (1u << rs) | (1u << rt);
+                        write = rd;
+                        break;
+                    default:
+                        return false;
+                }
+                break;
+            case 0x01:  // REGIMM, only BLTZ and BGEZ, the linking variants write $ra
+                if (rt > 1) return false;
+                reads = 1 << rs;
+                isBranch = true;
+                target = instructionPC + 4 + (_fImm_(code) << 2);
+                break;
+            case 0x02:  // J
+                isBranch = true;
+                target = (instructionPC & 0xf0000000) | (_fTarget_(code) << 2);
+                break;
+            case 0x04:  // BEQ
+            case 0x05:  // BNE
+                reads = (1u << rs) | (1u << rt);
+                isBranch = true;
+                target = instructionPC + 4 + (_fImm_(code) << 2);
+                break;
+            case 0x06:  // BLEZ
+            case 0x07:  // BGTZ
+                reads = 1 << rs;
+                isBranch = true;
+                target = instructionPC + 4 + (_fImm_(code) << 2);
+                break;
+            case 0x08:  // ADDI
+            case 0x09:  // ADDIU
+                reads = 1 << rs;
+                write = rt;
+                if (isConst(rs)) result = constants[rs] + _fImm_(code);
+                break;
+            case 0x0a:  // SLTI
+            case 0x0b:  // SLTIU
+            case 0x0c:  // ANDI
+            case 0x0e:  // XORI
+                reads = 1 << rs;
+                write = rt;
+                break;
+            case 0x0d:  // ORI
+                reads = 1 << rs;
+                write = rt;
+                if (isConst(rs)) result = constants[rs] | _fImmU_(code);
+                break;
+            case 0x0f:  // LUI
+                write = rt;
+                result = _fImmLU_(code);
+                break;
+            case 0x20:  // LB
+            case 0x21:  // LH
+            case 0x23:  // LW
+            case 0x24:  // LBU
+            case 0x25:  // LHU
+                // Only loads from addresses known at analysis time can be vetted
+                if (!isConst(rs) || !isIdleSafeAddress(constants[rs] + _fImm_(code))) return false;
+                reads = 1 << rs;
+                write = rt;
+                isLoad = true;
+                break;
+            default:
+                return false;
+        }
+
+        if (isBranch && inDelaySlot) return false;
+        if (inDelaySlot && isLoad) return false;
+
+        // Reading the destination of the previous load in its delay slot yields the old value
+        uint32_t available = written;
+        if (pendingLoad > 0) available &= ~(1u << pendingLoad);
+        readBeforeWritten |= reads & ~available & ~1;
+
+        if (pendingLoad > 0) {
+            written |= 1 << pendingLoad;
+            pendingLoad = -1;
+        }
+        if (write > 0) {
+            if (isLoad) {
+                pendingLoad = write;
+                constMask &= ~(1u << write);
+            } else {
+                written |= 1 << write;
+                if (result) {
+                    constants[write] = *result;
+                    constMask |= 1 << write;
+                } else {
+                    constMask &= ~(1u << write);
+                }
+            }
+        }
+
+        if (inDelaySlot) return (readBeforeWritten & written) == 0;
+        if (isBranch) {
+            if (target != pc) return false;
+            inDelaySlot = true;
+        }
+    }
+
+    return false;
+}
+
+void PCSX::R3000Acpu::skipIdleCycles() {
+    uint64_t target = g_emulator->m_counters->m_psxNextCounter;
+    if ((m_regs.interrupt != 0) && (m_regs.lowestTarget < target)) target = m_regs.lowestTarget;
+    if (int64_t(target - m_regs.cycle) > 0) m_regs.cycle = target;
+}
+
 void PCSX::R3000Acpu::psxSetPGXPMode(uint32_t pgxpMode) {
     SetPGXPMode(pgxpMode);
     // g_emulator->m_cpu->Reset();
@@ -467,6 +740,128 @@ void PCSX::R3000Acpu::processA0KernelCall(uint32_t call) {
     }
 }
 
+// Returns a host pointer to a guest buffer, if it lies entirely within contiguous main RAM.
+// Going through the LUTs takes care of the mirrors, as well as cache isolation for writes.
+static uint8_t* hleRamPointer(uint32_t address, uint32_t size, bool write) {
+    const uint32_t segment = address >> 29;
+    if ((segment != 0) && (segment != 4) && (segment != 5)) return nullptr;
+    const uint32_t physical = address & 0x1fffffff;
+    if (size == 0) size = 1;
+    if ((physical >= 0x00800000) || (size > 0x00800000 - physical)) return nullptr;
+
+    const auto lut = write ? PCSX::g_emulator->m_mem->m_writeLUT : PCSX::g_emulator->m_mem->m_readLUT;
+    const uint32_t first = address >> 16;
+    const uint32_t last = (address + size - 1) >> 16;
+    uint8_t* base = lut[first];
+    if (!base) return nullptr;
+    for (uint32_t page = first + 1; page <= last; page++) {
+        if (lut[page] != base + ((page - first) << 16)) return nullptr;
+    }
+    return base + (address & 0xffff);
+}
+
+// Measures a guest string, if it lies entirely within main RAM.
+static std::optional<uint32_t> hleStrlen(uint32_t address) {
+    uint32_t length = 0;
+    while (true) {
+        const uint32_t current = address + length;
+        const uint8_t* ptr = hleRamPointer(current, 1, false);
+        if (!ptr) return std::nullopt;
+        const uint32_t available = 0x10000 - (current & 0xffff);
+        const uint8_t* terminator = reinterpret_cast<const uint8_t*>(memchr(ptr, 0, available));
+        if (terminator) return length + uint32_t(terminator - ptr);
+        length += available;
+    }
+}
+
+static bool hleOverlaps(uint32_t a, uint32_t b, uint32_t size) {
+    a &= 0x1fffffff;
+    b &= 0x1fffffff;
+    return (a < b + size) && (b < a + size);
+}
+
+bool PCSX::R3000Acpu::hleA0KernelCall(uint32_t call) {
+    // Approximate costs, in instructions, of the BIOS implementations
+    constexpr uint32_t c_callOverhead = 16;
+    constexpr uint32_t c_perByte = 4;
+
+    auto& r = m_regs.GPR.n;
+
+    // Leave games which redirected the table entry to their own code alone.
+    const uint32_t* entry = g_emulator->m_mem->getPointer<uint32_t>(0x200 + call * 4);
+    if (!entry || ((SWAP_LE32(*entry) & 0x1fffffff) < 0x1fc00000)) return false;
+
+    // Null pointers and non-positive sizes are edge cases where BIOS versions differ,
+    // and overlapping copies depend on the exact copy order. These all go through LLE.
+    uint32_t instructions = c_callOverhead;
+    switch (call) {
+        case 0x17: {  // strcmp
+            if (!r.a0 || !r.a1) return false;
+            auto length1 = hleStrlen(r.a0);
+            auto length2 = hleStrlen(r.a1);
+            if (!length1 || !length2) return false;
+            const uint8_t* s1 = hleRamPointer(r.a0, *length1 + 1, false);
+            const uint8_t* s2 = hleRamPointer(r.a1, *length2 + 1, false);
+            if (!s1 || !s2) return false;
+            uint32_t i = 0;
+            while ((s1[i] == s2[i]) && s1[i]) i++;
+            r.v0 = int32_t(s1[i]) - int32_t(s2[i]);
+            instructions += (i + 1) * c_perByte;
+            break;
+        }
+        case 0x1b: {  // strlen
+            if (!r.a0) return false;
+            auto length = hleStrlen(r.a0);
+            if (!length) return false;
+            r.v0 = *length;
+            instructions += (*length + 1) * c_perByte;
+            break;
+        }
+        case 0x28: {  // bzero
+            const int32_t size = r.a1;
+            if (!r.a0 || (size <= 0)) return false;
+            uint8_t* ptr = hleRamPointer(r.a0, size, true);
+            if (!ptr) return false;
+            memset(ptr, 0, size);
+            Clear(r.a0 & ~3, ((r.a0 & 3) + size + 3) / 4);
+            r.v0 = r.a0;
+            instructions += size * c_perByte;
+            break;
+        }
+        case 0x2a:    // memcpy
+        case 0x2c: {  // memmove
+            const int32_t size = r.a2;
+            if (!r.a0 || !r.a1 || (size <= 0) || hleOverlaps(r.a0, r.a1, size)) return false;
+            uint8_t* dst = hleRamPointer(r.a0, size, true);
+            const uint8_t* src = hleRamPointer(r.a1, size, false);
+            if (!dst || !src) return false;
+            memcpy(dst, src, size);
+            Clear(r.a0 & ~3, ((r.a0 & 3) + size + 3) / 4);
+            r.v0 = r.a0;
+            instructions += size * c_perByte;
+            break;
+        }
+        case 0x2b: {  // memset
+            const int32_t size = r.a2;
+            if (!r.a0 || (size <= 0)) return false;
+            uint8_t* ptr = hleRamPointer(r.a0, size, true);
+            if (!ptr) return false;
+            memset(ptr, r.a1 & 0xff, size);
+            Clear(r.a0 & ~3, ((r.a0 & 3) + size + 3) / 4);
+            r.v0 = r.a0;
+            instructions += size * c_perByte;
+            break;
+        }
+        default:
+            return false;
+    }
+
+    m_regs.pc = r.ra;
+    m_regs.cycle += instructions * Emulator::BIAS;
+    m_hleCallCounts[call]++;
+    return true;
+}
+
 void PCSX::R3000Acpu::processB0KernelCall(uint32_t call) {
     auto& r = m_regs.GPR.n;
 
@@ -22,6 +22,7 @@
 #include <atomic>
 #include <cassert>
 #include <cstdint>
+#include <functional>
 #include <list>
 #include <map>
 #include <memory>
@@ -292,6 +293,52 @@ class R3000Acpu {
 
     static int psxInit();
     virtual bool isDynarec() = 0;
+
+    // Per-block execution counters, for coverage and hot-spot analysis of guest code.
+    // Only recompilers can provide these; the counting can be toggled at runtime.
+    virtual bool supportsBlockCounters() { return false; }
+    virtual bool blockCountersEnabled() { return false; }
+    virtual void enableBlockCounters(bool enabled) {}
+    virtual void resetBlockCounters() {}
+    // Calls the callback for every block entry point with a non-zero counter, in ascending PC order.
+    virtual void forEachBlockCounter(std::function<void(uint32_t pc, uint64_t count)> callback) {}
+    // Writes all the non-zero counters as a flat little endian binary profile:
+    // "BCNT" magic, u32 version, u32 entries count, then {u32 pc, u64 count} per entry.
+    void writeBlockCounters(IO<File> file);
+
+    // Compilation statistics. Recompilers compile code as plain blocks first, and recompile blocks
+    // as traces once they ran more than the promotion threshold.
+    struct JitCompileStats {
+        uint64_t blocks = 0;
+        uint64_t codeBytes = 0;
+        uint64_t compileTimeNs = 0;
+    };
+    struct JitStats {
+        JitCompileStats blocks;
+        JitCompileStats traces;
+        uint64_t promotions = 0;
+        uint64_t invalidations = 0;  // Traces taken down because code they hold a copy of got written to
+        uint32_t promotionThreshold = 0;
+    };
+    virtual bool supportsJitStats() { return false; }
+    virtual JitStats getJitStats() { return {}; }
+    virtual void resetJitStats() {}
+    // Only applies to blocks compiled after the change.
+    virtual void setPromotionThreshold(uint32_t threshold) {}
+
+    // Differential state tracing, to cross-check the recompilers against the interpreter.
+    // Every event check appends a 32 bytes little endian record to the file, after a
+    // "STRC" magic and a u32 version: {u32 kind, u32 pc, u64 cycle, u64 epoch, u64 value}.
+    // The epoch counts the exceptions and resets seen so far. Event checks (kind 0) store a hash of
+    // the GPRs, lo and hi in value, exceptions and resets (kind 1) store the cause code, or ~0 for
+    // a reset, and the final record (kind 2), written when stopping, stores a hash of the main RAM.
+    // Every event check is followed by a memory record (kind 3), storing the hash of one 4KB page of
+    // the main RAM; the page is picked from the cycle count, so that two traces hash the same page
+    // at the same point. Event checks happening while a load is still in its delay slot aren't recorded.
+    enum class StateTraceRecord : uint32_t { EventCheck = 0, Exception = 1, End = 2, Memory = 3 };
+    void startStateTrace(IO<File> file);
+    void stopStateTrace();
+    bool stateTraceEnabled() { return m_stateTracing; }
     void psxReset();
     void psxShutdown();
 
@@ -313,6 +360,12 @@ class R3000Acpu {
     void exception(uint32_t code, bool bd, bool cop0 = false);
     void branchTest();
 
+    // Idle loop detection. A short loop starting at pc, which only loads from memory that can't change
+    // until the next scheduled event, doesn't store anything, and doesn't carry registers from one
+    // iteration to the next, is just waiting for that event. Skipping the cycles in between is safe.
+    bool isIdleLoop(uint32_t pc);
+    void skipIdleCycles();
+
     void psxSetPGXPMode(uint32_t pgxpMode);
 
     void scheduleInterrupt(unsigned interrupt, uint32_t eCycle) {
@@ -402,6 +455,8 @@ class R3000Acpu {
     }
     void processA0KernelCall(uint32_t call);
     void processB0KernelCall(uint32_t call);
+    bool hleA0KernelCall(uint32_t call);
+    uint64_t m_hleCallCounts[256] = {};
     void logA0KernelCall(uint32_t call);
     void logB0KernelCall(uint32_t call);
     void logC0KernelCall(uint32_t call);
@@ -450,6 +505,30 @@ class R3000Acpu {
         }
     }
 
+    // High level emulation of some of the hot A0 library calls, such as memcpy or strlen. Returns true
+    // if the call was executed natively, in which case $v0 holds the result and pc was set to $ra.
+    // Otherwise, the call needs to go through the BIOS code as usual.
+    template <bool checkPC = true>
+    inline bool HLEKernelCall(uint32_t currentPC) {
+        if ((currentPC & g_emulator->getRamMask()) != 0xa0) return false;
+
+        if constexpr (checkPC) {
+            const uint32_t base = (currentPC >> 20) & 0xffc;
+            if ((base != 0x000) && (base != 0x800) && (base != 0xa00)) return false;
+        }
+
+        if (!g_emulator->settings.get<Emulator::SettingKernelHLE>()) return false;
+        // Breakpoints and memory watches need to see the actual accesses
+        if (g_emulator->settings.get<Emulator::SettingDebugSettings>().get<Emulator::DebugSettings::Debug>()) {
+            return false;
+        }
+
+        return hleA0KernelCall(m_regs.GPR.n.t1 & 0xff);
+    }
+
+    // How many times the given A0 call ran natively through HLEKernelCall since the last reset.
+    uint64_t hleCallCount(uint32_t call) const { return m_hleCallCounts[call & 0xff]; }
+
     /*
 Formula One 2001
 - Use old CPU cache code when the RAM location is
@@ -529,6 +608,12 @@ Formula One 2001
   private:
     const std::string m_name;
 
+    void recordState(StateTraceRecord kind, uint64_t value);
+    void writeStateRecord(StateTraceRecord kind, uint64_t value);
+    IO<File> m_stateTrace;
+    bool m_stateTracing = false;
+    uint64_t m_stateTraceEpoch = 0;
+
     struct PCdrvFile;
     typedef Intrusive::HashTable<uint32_t, PCdrvFile> PCdrvFiles;
     struct PCdrvFile : public IO<File>, public PCdrvFiles::Node {
@@ -0,0 +1,121 @@
+/***************************************************************************
+ *   Copyright (C) 2024 PCSX-Redux authors                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#include "core/sampler.h"
+
+#include <algorithm>
+
+#include "core/callstacks.h"
+#include "core/psxemulator.h"
+#include "core/r3000a.h"
+#include "fmt/format.h"
+
+PCSX::Sampler::Sampler() : m_listener(g_system->m_eventBus) {
+    m_listener.listen<Events::GPU::VSync>([this](const auto& event) {
+        if (m_enabled) drain();
+    });
+}
+
+void PCSX::Sampler::start(uint64_t interval) {
+    m_pending.reserve(c_maxPending);
+    m_interval = std::max(interval, uint64_t(1));
+    m_nextSample = g_emulator->m_cpu->m_regs.cycle + m_interval;
+    m_enabled = true;
+}
+
+void PCSX::Sampler::stop() {
+    m_enabled = false;
+    drain();
+}
+
+void PCSX::Sampler::reset() {
+    drain();
+    m_stacks.clear();
+    m_dropped = 0;
+}
+
+void PCSX::Sampler::sample(uint64_t cycle, uint32_t pc) {
+    // Next sample somewhere between half and one and a half intervals from now.
+    m_rng ^= m_rng << 13;
+    m_rng ^= m_rng >> 17;
+    m_rng ^= m_rng << 5;
+    m_nextSample = cycle + m_interval / 2 + m_rng % (m_interval + 1);
+
+    if (m_pending.size() >= c_maxPending) {
+        m_dropped++;
+        return;
+    }
+
+    auto& sample = m_pending.emplace_back();
+    unsigned depth = 0;
+    auto& callstacks = g_emulator->m_callStacks;
+    if (callstacks->hasCurrent()) {
+        auto& current = callstacks->getCurrent();
+        // Keep the innermost frames if the stack is deeper than what we can store.
+        auto skip = current.calls.size() + 2 > c_maxDepth ? current.calls.size() + 2 - c_maxDepth : 0;
+        for (auto& call : current.calls) {
+            if (skip) {
+                skip--;
+                continue;
+            }
+            sample.frames[depth++] = call.ra;
+        }
+        if (current.ra != 0) sample.frames[depth++] = current.ra;
+    }
+    sample.frames[depth++] = pc;
+    sample.depth = depth;
+}
+
+void PCSX::Sampler::drain() {
+    std::vector<uint32_t> key;
+    for (auto& sample : m_pending) {
+        key.assign(sample.frames, sample.frames + sample.depth);
+        m_stacks[key]++;
+    }
+    m_pending.clear();
+}
+
+std::string PCSX::Sampler::symbolize(uint32_t pc) {
+    auto& symbols = g_emulator->m_cpu->m_symbols;
+    auto symbol = symbols.upper_bound(pc);
+    if (symbol != symbols.begin()) {
+        --symbol;
+        if ((pc - symbol->first) <= c_maxSymbolDistance) return symbol->second;
+    }
+    return fmt::format("{:08x}", pc);
+}
+
+std::string PCSX::Sampler::folded() {
+    drain();
+    // Different PCs within the same function fold into the same line.
+    std::map<std::string, uint64_t> lines;
+    for (auto& [frames, count] : m_stacks) {
+        std::string line;
+        for (auto pc : frames) {
+            if (!line.empty()) line += ';';
+            line += symbolize(pc);
+        }
+        lines[line] += count;
+    }
+    std::string ret;
+    for (auto& [line, count] : lines) {
+        ret += fmt::format("{} {}\n", line, count);
+    }
+    return ret;
+}
@@ -0,0 +1,92 @@
+/***************************************************************************
+ *   Copyright (C) 2024 PCSX-Redux authors                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/system.h"
+#include "support/eventbus.h"
+
+namespace PCSX {
+
+// Sampling profiler for guest code. Roughly every m_interval emulated cycles, with
+// some jitter so periodic code doesn't alias with the sampling, the current PC and
+// the call chain known to CallStacks are recorded. The samples are aggregated per
+// unique stack on every vsync, and can be exported in the folded format used by
+// flamegraph tools.
+//
+// The interpreter samples on instruction boundaries, so the PC is exact. The dynarec
+// only gets a chance to sample in its branch test, between blocks, so its samples
+// land on block entry points.
+class Sampler {
+  public:
+    static constexpr unsigned c_maxDepth = 32;
+    // Samples kept between two vsyncs; anything beyond that is counted as dropped.
+    static constexpr unsigned c_maxPending = 4096;
+    // A PC further than this from the closest symbol below it is reported as a raw address.
+    static constexpr uint32_t c_maxSymbolDistance = 0x4000;
+
+    Sampler();
+
+    bool enabled() const { return m_enabled; }
+    uint64_t interval() const { return m_interval; }
+    uint64_t droppedSamples() const { return m_dropped; }
+    void start(uint64_t interval);
+    void stop();
+    void reset();
+
+    // Only costs a compare while disabled.
+    void maybeSample(uint64_t cycle, uint32_t pc) {
+        if (!m_enabled || (cycle < m_nextSample)) return;
+        sample(cycle, pc);
+    }
+
+    // One "frame;frame;frame count" line per unique stack, outermost frame first.
+    std::string folded();
+
+  private:
+    struct Sample {
+        uint32_t depth;
+        uint32_t frames[c_maxDepth];
+    };
+
+    void sample(uint64_t cycle, uint32_t pc);
+    void drain();
+    static std::string symbolize(uint32_t pc);
+
+    bool m_enabled = false;
+    uint64_t m_interval = 0;
+    uint64_t m_nextSample = 0;
+    uint64_t m_dropped = 0;
+    uint32_t m_rng = 0x9e3779b9;
+
+    std::vector<Sample> m_pending;
+
+    std::map<std::vector<uint32_t>, uint64_t> m_stacks;
+
+    EventBus::Listener m_listener;
+};
+
+}  // namespace PCSX
@@ -117,6 +117,10 @@ class SIO {
         m_memoryCard[1].loadMcd(mcd2);
     }
     void saveMcd(int mcd);
+    void waitForMcdFlush() {
+        m_memoryCard[0].waitForFlush();
+        m_memoryCard[1].waitForFlush();
+    }
     static constexpr int otherMcd(int mcd) {
         if ((mcd != 1) && (mcd != 2)) throw std::runtime_error("Bad memory card number");
         if (mcd == 1) return 2;
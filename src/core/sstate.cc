@@ -28,6 +28,7 @@
 #include "core/psxmem.h"
 #include "core/r3000a.h"
 #include "core/sio.h"
+#include "fmt/format.h"
 #include "spu/interface.h"
 
 PCSX::SaveStates::SaveState PCSX::SaveStates::constructSaveState() {
@@ -182,8 +183,8 @@ std::string PCSX::SaveStates::save() {
     SaveState state = constructSaveState();
     SaveStateWrapper wrapper(state);
 
-    state.get<SaveStateInfoField>().get<VersionString>().value = "PCSX-Redux SaveState v4";
-    state.get<SaveStateInfoField>().get<Version>().value = 4;
+    state.get<SaveStateInfoField>().get<VersionString>().value = fmt::format("PCSX-Redux SaveState v{}", c_version);
+    state.get<SaveStateInfoField>().get<Version>().value = c_version;
 
     g_emulator->m_gpu->serialize(&wrapper);
     g_emulator->m_spu->save(state.get<SPUField>());
@@ -278,22 +279,10 @@ void PCSX::Counters::serialize(SaveStateWrapper* w) {
     counters.get<PSXNextCounter>().value = m_psxNextCounter;
 }
 
-bool PCSX::SaveStates::load(std::string_view data) {
-    SaveState state = constructSaveState();
-
-    Protobuf::InSlice slice(reinterpret_cast<const uint8_t*>(data.data()), data.size());
-    try {
-        state.deserialize(&slice, 0);
-    } catch (...) {
-        return false;
-    }
-
-    if (state.get<SaveStateInfoField>().get<Version>().value != 4) {
-        return false;
-    }
-
+static void restoreSaveState(PCSX::SaveStates::SaveState& state) {
+    using namespace PCSX;
+    using namespace PCSX::SaveStates;
     SaveStateWrapper wrapper(state);
-    PCSX::g_emulator->m_cpu->Reset();
     state.commit();
     g_emulator->m_cpu->m_regs.lowestTarget = g_emulator->m_cpu->m_regs.cycle;
     g_emulator->m_cpu->m_regs.previousCycles = g_emulator->m_cpu->m_regs.cycle;
@@ -336,7 +325,56 @@ bool PCSX::SaveStates::load(std::string_view data) {
     g_emulator->m_callStacks->deserialize(&wrapper);
 
     g_system->m_eventBus->signal(Events::ExecutionFlow::SaveStateLoaded{});
+}
+
+bool PCSX::SaveStates::load(std::string_view data) {
+    SaveState state = constructSaveState();
+
+    Protobuf::InSlice slice(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    try {
+        state.deserialize(&slice, 0);
+    } catch (...) {
+        return false;
+    }
+
+    if (state.get<SaveStateInfoField>().get<Version>().value != c_version) {
+        return false;
+    }
+
+    PCSX::g_emulator->m_cpu->Reset();
+    restoreSaveState(state);
+    return true;
+}
+
+bool PCSX::SaveStates::load(IO<File> file) {
+    SaveState state = constructSaveState();
+
+    Protobuf::InSlice slice(file);
+    try {
+        // The info message is always serialized first, so we can check the
+        // version before the memory fields start getting decoded in place.
+        auto& info = state.get<SaveStateInfoField>();
+        if (slice.getVarInt() != ((SaveStateInfoField::fieldNumber << 3) | SaveStateInfoField::wireType)) {
+            return false;
+        }
+        info.deserialize(&slice, SaveStateInfoField::wireType);
+        if (info.get<Version>().value != c_version) return false;
+    } catch (...) {
+        return false;
+    }
+
+    PCSX::g_emulator->m_cpu->Reset();
+    try {
+        state.deserialize(&slice, 0);
+    } catch (...) {
+        // The memory has been partially overwritten already, and there is no going
+        // back to the previous state, so start the machine over from a clean slate.
+        g_system->printf(_("The save state is corrupted, resetting the emulator\n"));
+        g_system->hardReset();
+        return false;
+    }
 
+    restoreSaveState(state);
     return true;
 }
 
@@ -319,10 +319,16 @@ typedef Protobuf::ProtoFile<SaveStateInfo, Thumbnail, Memory, DelaySlotInfo, Reg
                             CDRom, Hardware, Rcnt, Counters, MDEC, PCdrvFile, Call, CallStack, CallStacks, SaveState>
     ProtoFile;
 
+// Bumped whenever the layout above changes in a way older states can't be loaded from.
+constexpr uint32_t c_version = 4;
+
 SaveState constructSaveState();
 
 std::string save();
 bool load(std::string_view data);
+// Decodes the save state as it's read from the file, with the main memory
+// written in place, instead of requiring the whole state in memory first.
+bool load(IO<File> file);
 }  // namespace SaveStates
 
 }  // namespace PCSX
@@ -26,7 +26,11 @@
 #include "core/gpu.h"
 #include "core/pad.h"
 #include "core/psxemulator.h"
+#include "core/psxmem.h"
 #include "core/spu.h"
+#include "core/sstate.h"
+#include "fmt/format.h"
+#include "support/zfile.h"
 #include "supportpsx/binloader.h"
 
 PCSX::UI::UI() : m_listener(g_system->m_eventBus) {
@@ -91,9 +95,73 @@ void PCSX::UI::tick() {
     }
 }
 
+std::filesystem::path PCSX::UI::bootCachePath() {
+    auto& settings = g_emulator->settings;
+    auto& debugSettings = settings.get<Emulator::SettingDebugSettings>();
+    const bool ramExpansion = settings.get<Emulator::Setting8MB>();
+    // Anything that changes what the machine looks like once the shell is reached has to be part of
+    // the key, as well as the build itself, since the savestate layout may change without its version.
+    const auto& version = g_system->getVersion();
+    const bool hle = settings.get<Emulator::SettingKernelHLE>();
+    const bool debug = debugSettings.get<Emulator::DebugSettings::Debug>();
+    const bool skipISR = debugSettings.get<Emulator::DebugSettings::SkipISR>();
+    const bool hardwareRenderer = settings.get<Emulator::SettingHardwareRenderer>();
+    const bool xa = settings.get<Emulator::SettingXa>();
+    const bool spuIrq = settings.get<Emulator::SettingSpuIrq>();
+    const bool rcntFix = settings.get<Emulator::SettingRCntFix>();
+    const int video = settings.get<Emulator::SettingVideo>();
+    auto key = fmt::format("{}-{}-{}-hle{}-debug{}-skipisr{}-hw{}-xa{}-spuirq{}-rcntfix{}-video{}", version.version,
+                           version.changeset, version.buildId.value_or(0), hle, debug, skipISR, hardwareRenderer, xa,
+                           spuIrq, rcntFix, video);
+    return g_system->getPersistentDir() / "bootcache" /
+           fmt::format("{:08x}-{}-v{}-{:016x}.sstate", g_emulator->m_mem->getBiosCRC32(), ramExpansion ? "8mb" : "2mb",
+                       SaveStates::c_version, djbHash::hash(key));
+}
+
+bool PCSX::UI::restoreBootCache() {
+    if (!g_system->getArgs().isBootCacheEnabled()) return false;
+    auto path = bootCachePath();
+    if (!std::filesystem::exists(path)) return false;
+    IO<File> cache(new ZReader(new PosixFile(path)));
+    if (cache->failed()) return false;
+    bool success = SaveStates::load(cache);
+    cache->close();
+    if (!success) {
+        g_system->log(LogClass::UI, "Unable to restore boot cache %s\n", path.string());
+        return false;
+    }
+    m_bootCacheRestored = true;
+    g_system->log(LogClass::UI, "Restored boot cache %s\n", path.string());
+    return true;
+}
+
+void PCSX::UI::captureBootCache() {
+    auto path = bootCachePath();
+    if (std::filesystem::exists(path)) return;
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    // Write to a unique file first, so concurrent runs never see a partial snapshot.
+    auto temp = path;
+    temp += fmt::format(".{}.tmp", uv_os_getpid());
+    {
+        ZWriter cache(new PosixFile(temp, FileOps::TRUNCATE), ZWriter::GZIP);
+        if (cache.failed()) return;
+        cache.writeString(SaveStates::save());
+        cache.close();
+    }
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return;
+    }
+    g_system->log(LogClass::UI, "Captured boot cache %s\n", path.string());
+}
+
 void PCSX::UI::shellReached() {
     auto& regs = g_emulator->m_cpu->m_regs;
     uint32_t oldPC = regs.pc;
+    // This has to happen before any of the fast boot or side loading changes below.
+    if (g_system->getArgs().isBootCacheEnabled() && !m_bootCacheRestored) captureBootCache();
     if (g_emulator->settings.get<Emulator::SettingFastBoot>()) {
         regs.pc = regs.GPR.n.ra;
         // Enables display as some games like SaGa Frontier (USA)
@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <filesystem>
 #include <functional>
 #include <string>
 #include <utility>
@@ -60,6 +61,13 @@ class UI {
         bool pauseAfterLoad = true;
     } m_exeToLoad;
 
+    // With -fastboot, the first boot with a given BIOS captures a snapshot of the machine when reaching
+    // the shell, and subsequent runs restore it instead of going through the BIOS initialization again.
+    // Snapshots are keyed on the BIOS, the build, the savestate version, and the settings that affect
+    // the boot sequence. Passing -no-bootcache keeps -fastboot from reading or writing them.
+    // Returns true if a snapshot was restored; the usual shell reached handling then happens as normal.
+    bool restoreBootCache();
+
   protected:
     using json = nlohmann::json;
     json m_settingsJson;
@@ -72,6 +80,9 @@ class UI {
 
   private:
     void shellReached();
+    std::filesystem::path bootCachePath();
+    void captureBootCache();
+    bool m_bootCacheRestored = false;
 };
 
 }  // namespace PCSX
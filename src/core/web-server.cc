@@ -19,10 +19,12 @@
 
 #include "core/web-server.h"
 
+#include <algorithm>
 #include <charconv>
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "GL/gl3w.h"
 #include "cdrom/cdriso.h"
@@ -34,6 +36,7 @@
 #include "core/psxemulator.h"
 #include "core/psxmem.h"
 #include "core/r3000a.h"
+#include "core/sampler.h"
 #include "core/system.h"
 #include "gui/gui.h"
 #include "http-parser/http_parser.h"
@@ -230,6 +233,203 @@ class CacheExecutor : public PCSX::WebExecutor {
     virtual ~CacheExecutor() = default;
 };
 
+class BlockCountersExecutor : public PCSX::WebExecutor {
+    virtual bool match(PCSX::WebClient* client, const PCSX::UrlData& urldata) final {
+        return urldata.path == "/api/v1/cpu/block-counters";
+    }
+    virtual bool execute(PCSX::WebClient* client, PCSX::RequestData& request) final {
+        auto& cpu = PCSX::g_emulator->m_cpu;
+        if (!cpu->supportsBlockCounters()) {
+            client->write("HTTP/1.1 501 Not Implemented\r\n\r\n");
+            return true;
+        }
+        auto vars = parseQuery(request.urlData.query);
+        if (request.method == PCSX::RequestData::Method::HTTP_HTTP_GET) {
+            auto iformat = vars.find("format");
+            if ((iformat != vars.end()) && (iformat->second == "binary")) {
+                PCSX::IO<PCSX::BufferFile> file = new PCSX::BufferFile(PCSX::FileOps::READWRITE);
+                cpu->writeBlockCounters(file);
+                PCSX::Slice slice;
+                slice.copy(file->borrow());
+                client->write(std::string("HTTP/1.1 200 OK\r\n"));
+                client->write(std::string("Content-Type: application/octet-stream\r\n"));
+                client->write(std::string("Content-Length: " + std::to_string(slice.size()) + "\r\n\r\n"));
+                client->write(std::move(slice));
+                return true;
+            }
+            nlohmann::json j;
+            j["enabled"] = cpu->blockCountersEnabled();
+            auto& blocks = j["blocks"] = nlohmann::json::array();
+            cpu->forEachBlockCounter([&cpu, &blocks](uint32_t pc, uint64_t count) {
+                nlohmann::json block;
+                block["pc"] = pc;
+                block["count"] = count;
+                auto symbol = cpu->m_symbols.find(pc);
+                if (symbol != cpu->m_symbols.end()) block["symbol"] = symbol->second;
+                blocks.push_back(std::move(block));
+            });
+            write200(client, j);
+            return true;
+        } else if (request.method == PCSX::RequestData::Method::HTTP_POST) {
+            auto ifunction = vars.find("function");
+            if (ifunction == vars.end()) {
+                client->write("HTTP/1.1 400 Bad Request\r\n\r\n");
+                return true;
+            }
+            std::string function = ifunction->second;
+            if (function.compare("enable") == 0) {
+                cpu->enableBlockCounters(true);
+                client->write("HTTP/1.1 200 OK\r\n\r\n");
+                return true;
+            }
+            if (function.compare("disable") == 0) {
+                cpu->enableBlockCounters(false);
+                client->write("HTTP/1.1 200 OK\r\n\r\n");
+                return true;
+            }
+            if (function.compare("reset") == 0) {
+                cpu->resetBlockCounters();
+                client->write("HTTP/1.1 200 OK\r\n\r\n");
+                return true;
+            }
+            client->write("HTTP/1.1 400 Bad Request\r\n\r\n");
+            return true;
+        }
+        return false;
+    }
+
+  public:
+    BlockCountersExecutor() = default;
+    virtual ~BlockCountersExecutor() = default;
+};
+
+class SamplerExecutor : public PCSX::WebExecutor {
+    virtual bool match(PCSX::WebClient* client, const PCSX::UrlData& urldata) final {
+        return urldata.path == "/api/v1/cpu/sampler";
+    }
+    virtual bool execute(PCSX::WebClient* client, PCSX::RequestData& request) final {
+        auto& sampler = PCSX::g_emulator->m_sampler;
+        if (request.method == PCSX::RequestData::Method::HTTP_HTTP_GET) {
+            std::string folded = sampler->folded();
+            std::string message = std::string(
+                                      "HTTP/1.1 200 OK\r\n"
+                                      "Content-Type: text/plain\r\n"
+                                      "Content-Length: ") +
+                                  std::to_string(folded.size()) + std::string("\r\n\r\n") + folded;
+            client->write(std::move(message));
+            return true;
+        } else if (request.method == PCSX::RequestData::Method::HTTP_POST) {
+            auto vars = parseQuery(request.urlData.query);
+            auto ifunction = vars.find("function");
+            if (ifunction == vars.end()) {
+                client->write("HTTP/1.1 400 Bad Request\r\n\r\n");
+                return true;
+            }
+            std::string function = ifunction->second;
+            if (function.compare("start") == 0) {
+                uint64_t interval = 10000;
+                auto iinterval = vars.find("interval");
+                if (iinterval != vars.end()) {
+                    auto& str = iinterval->second;
+                    auto result = std::from_chars(str.data(), str.data() + str.size(), interval);
+                    if ((result.ec != std::errc()) || (interval == 0)) {
+                        client->write("HTTP/1.1 400 Bad Request\r\n\r\n");
+                        return true;
+                    }
+                }
+                sampler->start(interval);
+                client->write("HTTP/1.1 200 OK\r\n\r\n");
+                return true;
+            }
+            if (function.compare("stop") == 0) {
+                sampler->stop();
+                client->write("HTTP/1.1 200 OK\r\n\r\n");
+                return true;
+            }
+            if (function.compare("reset") == 0) {
+                sampler->reset();
+                client->write("HTTP/1.1 200 OK\r\n\r\n");
+                return true;
+            }
+            client->write("HTTP/1.1 400 Bad Request\r\n\r\n");
+            return true;
+        }
+        return false;
+    }
+
+  public:
+    SamplerExecutor() = default;
+    virtual ~SamplerExecutor() = default;
+};
+
+class JitStatsExecutor : public PCSX::WebExecutor {
+    virtual bool match(PCSX::WebClient* client, const PCSX::UrlData& urldata) final {
+        return urldata.path == "/api/v1/cpu/jit-stats";
+    }
+    virtual bool execute(PCSX::WebClient* client, PCSX::RequestData& request) final {
+        auto& cpu = PCSX::g_emulator->m_cpu;
+        if (!cpu->supportsJitStats()) {
+            client->write("HTTP/1.1 501 Not Implemented\r\n\r\n");
+            return true;
+        }
+        if (request.method == PCSX::RequestData::Method::HTTP_HTTP_GET) {
+            auto stats = cpu->getJitStats();
+            auto compiled = [](const PCSX::R3000Acpu::JitCompileStats& compileStats) {
+                nlohmann::json j;
+                j["blocks"] = compileStats.blocks;
+                j["codeBytes"] = compileStats.codeBytes;
+                j["compileTimeNs"] = compileStats.compileTimeNs;
+                return j;
+            };
+            nlohmann::json j;
+            j["blocks"] = compiled(stats.blocks);
+            j["traces"] = compiled(stats.traces);
+            j["promotions"] = stats.promotions;
+            j["invalidations"] = stats.invalidations;
+            j["promotionThreshold"] = stats.promotionThreshold;
+            write200(client, j);
+            return true;
+        } else if (request.method == PCSX::RequestData::Method::HTTP_POST) {
+            auto vars = parseQuery(request.urlData.query);
+            auto ifunction = vars.find("function");
+            if (ifunction == vars.end()) {
+                client->write("HTTP/1.1 400 Bad Request\r\n\r\n");
+                return true;
+            }
+            std::string function = ifunction->second;
+            if (function.compare("reset") == 0) {
+                cpu->resetJitStats();
+                client->write("HTTP/1.1 200 OK\r\n\r\n");
+                return true;
+            }
+            if (function.compare("threshold") == 0) {
+                uint32_t threshold = 0;
+                auto ivalue = vars.find("value");
+                if (ivalue == vars.end()) {
+                    client->write("HTTP/1.1 400 Bad Request\r\n\r\n");
+                    return true;
+                }
+                auto& str = ivalue->second;
+                auto result = std::from_chars(str.data(), str.data() + str.size(), threshold);
+                if ((result.ec != std::errc()) || (threshold == 0)) {
+                    client->write("HTTP/1.1 400 Bad Request\r\n\r\n");
+                    return true;
+                }
+                cpu->setPromotionThreshold(threshold);
+                client->write("HTTP/1.1 200 OK\r\n\r\n");
+                return true;
+            }
+            client->write("HTTP/1.1 400 Bad Request\r\n\r\n");
+            return true;
+        }
+        return false;
+    }
+
+  public:
+    JitStatsExecutor() = default;
+    virtual ~JitStatsExecutor() = default;
+};
+
 class FlowExecutor : public PCSX::WebExecutor {
     virtual bool match(PCSX::WebClient* client, const PCSX::UrlData& urldata) final {
         return urldata.path == "/api/v1/execution-flow";
@@ -754,6 +954,395 @@ class ScreenExecutor : public PCSX::WebExecutor {
     virtual ~ScreenExecutor() = default;
 };
 
+class VramStreamExecutor : public PCSX::WebExecutor {
+    enum class Source { Display, VRAM };
+    enum class Format { Raw, QOI, PNG };
+    struct Rect {
+        uint16_t x, y, w, h;
+    };
+    struct Subscriber {
+        PCSX::WebClient* client;
+        Source source;
+        Format format;
+        bool dirty;
+        unsigned interval;
+        unsigned skipped = 0;
+        uint32_t frame = 0;
+        // Set while a job is queued on the worker pool; only one frame per client is in flight.
+        bool busy = false;
+        // Last frame sent, used for the dirty rectangles diff; only touched by the worker.
+        PCSX::Slice previous;
+        uint16_t previousWidth = 0, previousHeight = 0;
+        unsigned previousBpp = 0;
+    };
+    struct Job {
+        uv_work_t req;
+        std::shared_ptr<Subscriber> subscriber;
+        PCSX::Slice snapshot;
+        uint16_t width, height;
+        unsigned bpp;
+        uint32_t frame;
+        std::vector<PCSX::Slice> chunks;
+    };
+
+    virtual bool match(PCSX::WebClient* client, const PCSX::UrlData& urldata) final {
+        return urldata.path == "/api/v1/gpu/vram/stream";
+    }
+    virtual bool execute(PCSX::WebClient* client, PCSX::RequestData& request) final {
+        if (request.method != PCSX::RequestData::Method::HTTP_HTTP_GET) return false;
+        auto vars = parseQuery(request.urlData.query);
+        auto subscriber = std::make_shared<Subscriber>();
+        subscriber->client = client;
+        subscriber->source = Source::Display;
+        subscriber->format = Format::Raw;
+        subscriber->dirty = false;
+        subscriber->interval = 1;
+
+        auto isource = vars.find("source");
+        if (isource != vars.end()) {
+            if (isource->second == "display") {
+                subscriber->source = Source::Display;
+            } else if (isource->second == "vram") {
+                subscriber->source = Source::VRAM;
+            } else {
+                client->write("HTTP/1.1 400 Bad Request\r\n\r\n");
+                return true;
+            }
+        }
+        auto iformat = vars.find("format");
+        if (iformat != vars.end()) {
+            if (iformat->second == "raw") {
+                subscriber->format = Format::Raw;
+            } else if (iformat->second == "qoi") {
+                subscriber->format = Format::QOI;
+            } else if (iformat->second == "png") {
+                subscriber->format = Format::PNG;
+            } else {
+                client->write("HTTP/1.1 400 Bad Request\r\n\r\n");
+                return true;
+            }
+        }
+        auto idirty = vars.find("dirty");
+        if (idirty != vars.end()) subscriber->dirty = idirty->second == "1" || idirty->second == "true";
+        auto iinterval = vars.find("interval");
+        if (iinterval != vars.end()) {
+            auto& str = iinterval->second;
+            unsigned interval = 0;
+            auto result = std::from_chars(str.data(), str.data() + str.size(), interval);
+            if ((result.ec != std::errc()) || (interval == 0)) {
+                client->write("HTTP/1.1 400 Bad Request\r\n\r\n");
+                return true;
+            }
+            subscriber->interval = interval;
+        }
+        // Browsers only know how to present whole images out of a multipart stream.
+        if ((subscriber->format == Format::PNG) && subscriber->dirty) {
+            client->write("HTTP/1.1 400 Bad Request\r\n\r\n");
+            return true;
+        }
+
+        if (subscriber->format == Format::PNG) {
+            client->write(
+                "HTTP/1.1 200 OK\r\nContent-Type: multipart/x-mixed-replace; boundary=pcsxframe\r\n"
+                "Cache-Control: no-cache\r\nTransfer-Encoding: chunked\r\n\r\n");
+        } else {
+            client->write(
+                "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\n"
+                "Cache-Control: no-cache\r\nTransfer-Encoding: chunked\r\n\r\n");
+        }
+        client->keepOpen([this, subscriber]() {
+            subscriber->client = nullptr;
+            std::erase(m_subscribers, subscriber);
+        });
+        m_subscribers.push_back(subscriber);
+        return true;
+    }
+
+    void onVSync() {
+        for (auto& subscriber : m_subscribers) {
+            if (subscriber->busy) continue;
+            if (++subscriber->skipped < subscriber->interval) continue;
+            subscriber->skipped = 0;
+            // The client isn't keeping up; drop this frame instead of piling up buffers.
+            if (subscriber->client->pendingWrites() > c_maxPendingWrites) continue;
+            Job* job = new Job();
+            job->subscriber = subscriber;
+            job->frame = subscriber->frame++;
+            takeSnapshot(subscriber->source, job);
+            job->req.data = job;
+            subscriber->busy = true;
+            uv_queue_work(PCSX::g_system->getLoop(), &job->req, encodeCB, afterEncodeCB);
+        }
+    }
+
+    // This runs on the emulation thread, so it only grabs the pixels; everything else is for the worker.
+    static void takeSnapshot(Source source, Job* job) {
+        auto& gpu = PCSX::g_emulator->m_gpu;
+        if (source == Source::Display) {
+            try {
+                auto screenshot = gpu->takeScreenShot();
+                job->snapshot = std::move(screenshot.data);
+                job->width = screenshot.width;
+                job->height = screenshot.height;
+                job->bpp = screenshot.bpp == PCSX::GPU::ScreenShot::BPP_24 ? 24 : 16;
+                return;
+            } catch (...) {
+                // Not every GPU backend can take screenshots; fall back to the whole VRAM.
+            }
+        }
+        job->snapshot = gpu->getVRAM(PCSX::GPU::Ownership::ACQUIRE);
+        job->width = 1024;
+        job->height = 512;
+        job->bpp = 16;
+    }
+
+    static void encodeCB(uv_work_t* req) {
+        Job* job = static_cast<Job*>(req->data);
+        auto& subscriber = *job->subscriber;
+        if ((job->width == 0) || (job->height == 0)) return;
+        unsigned bytesPerPixel = job->bpp / 8;
+        bool full = !subscriber.dirty || (subscriber.previousWidth != job->width) ||
+                    (subscriber.previousHeight != job->height) || (subscriber.previousBpp != job->bpp) ||
+                    (subscriber.previous.size() != job->snapshot.size());
+        std::vector<Rect> rects;
+        if (full) {
+            rects.push_back({0, 0, job->width, job->height});
+        } else {
+            diff(job, subscriber.previous.data<uint8_t>(), rects);
+        }
+
+        for (unsigned i = 0; i < rects.size(); i++) {
+            auto& rect = rects[i];
+            PCSX::Slice payload;
+            switch (subscriber.format) {
+                case Format::Raw:
+                    if (!subscriber.dirty && (rect.w == job->width) && (rect.h == job->height)) {
+                        payload = std::move(job->snapshot);
+                    } else {
+                        unsigned stride = rect.w * bytesPerPixel;
+                        uint8_t* data = static_cast<uint8_t*>(malloc(stride * rect.h));
+                        const uint8_t* src = job->snapshot.data<uint8_t>();
+                        for (unsigned y = 0; y < rect.h; y++) {
+                            memcpy(data + y * stride,
+                                   src + ((rect.y + y) * job->width + rect.x) * bytesPerPixel, stride);
+                        }
+                        payload.acquire(data, stride * rect.h);
+                    }
+                    break;
+                case Format::QOI:
+                    payload = encodeQOI(toRGB(job, rect, 3), rect.w, rect.h);
+                    break;
+                case Format::PNG: {
+                    auto rgba = toRGB(job, rect, 4);
+                    clip::image_spec spec;
+                    spec.width = rect.w;
+                    spec.height = rect.h;
+                    spec.bits_per_pixel = 32;
+                    spec.bytes_per_row = rect.w * 4;
+                    spec.red_mask = 0xff;
+                    spec.green_mask = 0xff00;
+                    spec.blue_mask = 0xff0000;
+                    spec.alpha_mask = 0xff000000;
+                    spec.red_shift = 0;
+                    spec.green_shift = 8;
+                    spec.blue_shift = 16;
+                    spec.alpha_shift = 24;
+                    clip::image img(rgba.data(), spec);
+                    std::vector<uint8_t> pngData;
+                    if (!img.export_to_png(pngData)) continue;
+                    payload.copy(pngData.data(), pngData.size());
+                    break;
+                }
+            }
+
+            std::string prefix;
+            if (subscriber.format == Format::PNG) {
+                auto part = fmt::format("--pcsxframe\r\nContent-Type: image/png\r\nContent-Length: {}\r\n\r\n",
+                                        payload.size());
+                prefix = fmt::format("{:x}\r\n", part.size() + payload.size() + 2) + part;
+            } else {
+                // Each rectangle is its own chunk, with a 16 bytes little endian header:
+                // frame number, x, y, width, height, bits per pixel, flags (1 = last of frame, 2 = full frame).
+                prefix = fmt::format("{:x}\r\n", 16 + payload.size());
+                uint16_t flags = (i == rects.size() - 1 ? 1 : 0) | (full ? 2 : 0);
+                uint16_t bpp = subscriber.format == Format::Raw ? job->bpp : 24;
+                auto put16 = [&prefix](uint16_t v) {
+                    prefix += char(v & 0xff);
+                    prefix += char(v >> 8);
+                };
+                put16(job->frame & 0xffff);
+                put16(job->frame >> 16);
+                put16(rect.x);
+                put16(rect.y);
+                put16(rect.w);
+                put16(rect.h);
+                put16(bpp);
+                put16(flags);
+            }
+            job->chunks.emplace_back(std::move(prefix));
+            job->chunks.push_back(std::move(payload));
+            PCSX::Slice suffix;
+            if (subscriber.format == Format::PNG) {
+                suffix.borrow("\r\n\r\n");
+            } else {
+                suffix.borrow("\r\n");
+            }
+            job->chunks.push_back(std::move(suffix));
+        }
+
+        if (subscriber.dirty) {
+            subscriber.previous = std::move(job->snapshot);
+            subscriber.previousWidth = job->width;
+            subscriber.previousHeight = job->height;
+            subscriber.previousBpp = job->bpp;
+        }
+    }
+
+    static void afterEncodeCB(uv_work_t* req, int status) {
+        std::unique_ptr<Job> job(static_cast<Job*>(req->data));
+        auto& subscriber = *job->subscriber;
+        subscriber.busy = false;
+        if (!subscriber.client || (status != 0)) return;
+        for (auto& chunk : job->chunks) subscriber.client->write(std::move(chunk));
+    }
+
+    // Splits the frame in bands of c_band lines, and reports the changed horizontal span of each band.
+    static void diff(const Job* job, const uint8_t* previous, std::vector<Rect>& rects) {
+        unsigned bytesPerPixel = job->bpp / 8;
+        unsigned stride = job->width * bytesPerPixel;
+        const uint8_t* current = job->snapshot.data<uint8_t>();
+        for (unsigned y0 = 0; y0 < job->height; y0 += c_band) {
+            unsigned h = std::min(c_band, job->height - y0);
+            unsigned minX = job->width, maxX = 0;
+            for (unsigned y = y0; y < y0 + h; y++) {
+                const uint8_t* a = current + y * stride;
+                const uint8_t* b = previous + y * stride;
+                if (memcmp(a, b, stride) == 0) continue;
+                unsigned left = 0;
+                while (memcmp(a + left * bytesPerPixel, b + left * bytesPerPixel, bytesPerPixel) == 0) left++;
+                unsigned right = job->width - 1;
+                while (memcmp(a + right * bytesPerPixel, b + right * bytesPerPixel, bytesPerPixel) == 0) right--;
+                minX = std::min(minX, left);
+                maxX = std::max(maxX, right);
+            }
+            if (minX > maxX) continue;
+            rects.push_back({uint16_t(minX), uint16_t(y0), uint16_t(maxX - minX + 1), uint16_t(h)});
+        }
+    }
+
+    static std::vector<uint8_t> toRGB(const Job* job, const Rect& rect, unsigned channels) {
+        std::vector<uint8_t> ret(rect.w * rect.h * channels);
+        const uint8_t* src = job->snapshot.data<uint8_t>();
+        uint8_t* dst = ret.data();
+        for (unsigned y = 0; y < rect.h; y++) {
+            for (unsigned x = 0; x < rect.w; x++) {
+                unsigned offset = (rect.y + y) * job->width + rect.x + x;
+                if (job->bpp == 24) {
+                    dst[0] = src[offset * 3 + 0];
+                    dst[1] = src[offset * 3 + 1];
+                    dst[2] = src[offset * 3 + 2];
+                } else {
+                    uint16_t c = src[offset * 2] | (src[offset * 2 + 1] << 8);
+                    uint8_t r = c & 0x1f;
+                    uint8_t g = (c >> 5) & 0x1f;
+                    uint8_t b = (c >> 10) & 0x1f;
+                    dst[0] = (r << 3) | (r >> 2);
+                    dst[1] = (g << 3) | (g >> 2);
+                    dst[2] = (b << 3) | (b >> 2);
+                }
+                if (channels == 4) dst[3] = 0xff;
+                dst += channels;
+            }
+        }
+        return ret;
+    }
+
+    // Straight implementation of the QOI specification, for an RGB image without alpha.
+    static PCSX::Slice encodeQOI(const std::vector<uint8_t>& rgb, unsigned width, unsigned height) {
+        unsigned pixels = width * height;
+        uint8_t* data = static_cast<uint8_t*>(malloc(14 + pixels * 4 + 8));
+        uint8_t* ptr = data;
+        auto put32 = [&ptr](uint32_t v) {
+            *ptr++ = v >> 24;
+            *ptr++ = v >> 16;
+            *ptr++ = v >> 8;
+            *ptr++ = v;
+        };
+        *ptr++ = 'q';
+        *ptr++ = 'o';
+        *ptr++ = 'i';
+        *ptr++ = 'f';
+        put32(width);
+        put32(height);
+        *ptr++ = 3;
+        *ptr++ = 0;
+
+        uint32_t index[64] = {0};
+        uint8_t pr = 0, pg = 0, pb = 0;
+        unsigned run = 0;
+        for (unsigned i = 0; i < pixels; i++) {
+            uint8_t r = rgb[i * 3 + 0];
+            uint8_t g = rgb[i * 3 + 1];
+            uint8_t b = rgb[i * 3 + 2];
+            if ((r == pr) && (g == pg) && (b == pb)) {
+                run++;
+                if ((run == 62) || (i == pixels - 1)) {
+                    *ptr++ = 0xc0 | (run - 1);
+                    run = 0;
+                }
+                continue;
+            }
+            if (run > 0) {
+                *ptr++ = 0xc0 | (run - 1);
+                run = 0;
+            }
+            uint32_t pixel = r | (g << 8) | (b << 16) | 0xff000000;
+            unsigned hash = (r * 3 + g * 5 + b * 7 + 255 * 11) % 64;
+            if (index[hash] == pixel) {
+                *ptr++ = hash;
+            } else {
+                index[hash] = pixel;
+                int8_t vr = r - pr;
+                int8_t vg = g - pg;
+                int8_t vb = b - pb;
+                int8_t vgr = vr - vg;
+                int8_t vgb = vb - vg;
+                if ((vr > -3) && (vr < 2) && (vg > -3) && (vg < 2) && (vb > -3) && (vb < 2)) {
+                    *ptr++ = 0x40 | ((vr + 2) << 4) | ((vg + 2) << 2) | (vb + 2);
+                } else if ((vgr > -9) && (vgr < 8) && (vg > -33) && (vg < 32) && (vgb > -9) && (vgb < 8)) {
+                    *ptr++ = 0x80 | (vg + 32);
+                    *ptr++ = ((vgr + 8) << 4) | (vgb + 8);
+                } else {
+                    *ptr++ = 0xfe;
+                    *ptr++ = r;
+                    *ptr++ = g;
+                    *ptr++ = b;
+                }
+            }
+            pr = r;
+            pg = g;
+            pb = b;
+        }
+        for (unsigned i = 0; i < 7; i++) *ptr++ = 0;
+        *ptr++ = 1;
+
+        PCSX::Slice ret;
+        ret.acquire(data, ptr - data);
+        return ret;
+    }
+
+    static constexpr unsigned c_band = 16;
+    static constexpr size_t c_maxPendingWrites = 16;
+    std::vector<std::shared_ptr<Subscriber>> m_subscribers;
+    PCSX::EventBus::Listener m_listener;
+
+  public:
+    VramStreamExecutor() : m_listener(PCSX::g_system->m_eventBus) {
+        m_listener.listen<PCSX::Events::GPU::VSync>([this](const auto& event) { onVSync(); });
+    }
+    virtual ~VramStreamExecutor() = default;
+};
+
 }  // namespace
 
 std::multimap<std::string, std::string> PCSX::WebExecutor::parseQuery(const std::string& query) {
@@ -815,11 +1404,15 @@ PCSX::WebServer::WebServer() : m_listener(g_system->m_eventBus) {
     m_executors.push_back(new RamExecutor());
     m_executors.push_back(new AssemblyExecutor());
     m_executors.push_back(new CacheExecutor());
+    m_executors.push_back(new BlockCountersExecutor());
+    m_executors.push_back(new SamplerExecutor());
+    m_executors.push_back(new JitStatsExecutor());
     m_executors.push_back(new FlowExecutor());
     m_executors.push_back(new LuaExecutor());
     m_executors.push_back(new CDExecutor());
     m_executors.push_back(new StateExecutor());
     m_executors.push_back(new ScreenExecutor());
+    m_executors.push_back(new VramStreamExecutor());
     m_listener.listen<Events::SettingsLoaded>([this](const auto& event) {
         auto& debugSettings = g_emulator->settings.get<Emulator::SettingDebugSettings>();
         if (debugSettings.get<Emulator::DebugSettings::WebServer>() && (m_serverStatus != SERVER_STARTED)) {
@@ -1128,6 +1721,7 @@ struct PCSX::WebClient::WebClientImpl {
     }
     static void closeCB(uv_handle_t* handle) {
         WebClientImpl* client = static_cast<WebClientImpl*>(handle->data);
+        if (client->m_onClose) client->m_onClose();
         delete client->m_parent;
     }
     void processData(const Slice& slice) {
@@ -1151,6 +1745,7 @@ struct PCSX::WebClient::WebClientImpl {
     }
 
     void write(Slice&& slice) {
+        if (m_status != OPEN) return;
         auto* req = new WriteRequest(std::move(slice));
         req->enqueue(this);
     }
@@ -1186,7 +1781,7 @@ struct PCSX::WebClient::WebClientImpl {
     int executeRequest() {
         m_requestData.method = static_cast<RequestData::Method>(m_httpParser.method);
         m_currentExecutor->execute(m_parent, m_requestData);
-        scheduleClose();
+        if (!m_keepOpen) scheduleClose();
         return 0;
     }
     void scheduleClose() {
@@ -1225,6 +1820,8 @@ struct PCSX::WebClient::WebClientImpl {
     multipart_parser_settings m_multipartParserCallbacks;
 
     bool m_closeScheduled = false;
+    bool m_keepOpen = false;
+    std::function<void()> m_onClose;
 };
 
 PCSX::WebClient::WebClient(WebServer* server) : m_impl(std::make_unique<WebClientImpl>(server, this)) {}
@@ -1233,6 +1830,11 @@ bool PCSX::WebClient::accept(uv_tcp_t* srv) { return m_impl->accept(srv); }
 void PCSX::WebClient::write(Slice&& slice) { m_impl->write(std::move(slice)); }
 void PCSX::WebClient::write(std::string&& str) { m_impl->write(std::move(str)); }
 void PCSX::WebClient::write(const std::string& str) { m_impl->write(str); }
+void PCSX::WebClient::keepOpen(std::function<void()>&& onClose) {
+    m_impl->m_keepOpen = true;
+    m_impl->m_onClose = std::move(onClose);
+}
+size_t PCSX::WebClient::pendingWrites() { return m_impl->m_requests.size(); }
 
 void PCSX::WebServer::onNewConnection(int status) {
     if (status < 0) return;
@@ -21,6 +21,7 @@
 
 #include <uv.h>
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -113,6 +114,10 @@ class WebClient : public Intrusive::List<WebClient>::Node {
     }
     void write(std::string&& str);
     void write(const std::string& str);
+    // Streaming executors call this so the connection survives the end of the
+    // request; the callback runs once the connection is actually closed.
+    void keepOpen(std::function<void()>&& onClose);
+    size_t pendingWrites();
 
   private:
     struct WebClientImpl;
@@ -1021,6 +1021,7 @@ void PCSX::GUI::flip() {
 }
 
 void PCSX::GUI::endFrame() {
+    ZoneScoped;
     constexpr float renderRatio = 3.0f / 4.0f;
     const int w = m_framebufferSize.x;
     const int h = m_framebufferSize.y;
@@ -2064,6 +2065,22 @@ when changing this setting.)"));
 which may include additional checks.
 Also will make the boot time substantially
 faster by not displaying the logo.)"));
+        if (ImGui::Checkbox(_("Skip idle loops"), &settings.get<Emulator::SettingIdleSkip>().value)) {
+            changed = true;
+            // The check is only compiled into blocks while the setting is on.
+            g_emulator->m_cpu->invalidateCache();
+        }
+        ImGuiHelpers::ShowHelpMarker(_(R"(When using the dynarec, detect short loops
+which only poll memory while waiting for an
+interrupt, and skip ahead to the next event
+instead of running them. This can noticeably
+speed up emulation, but changes timings.)"));
+        changed |= ImGui::Checkbox(_("HLE kernel library calls"), &settings.get<Emulator::SettingKernelHLE>().value);
+        ImGuiHelpers::ShowHelpMarker(_(R"(Run some of the BIOS library functions, such as
+memcpy, memset or strlen, natively instead of
+emulating the BIOS code for them. Calls which
+touch anything but main RAM still go through
+the BIOS. Disabled while the debugger is on.)"));
         auto bios = settings.get<Emulator::SettingBios>().string();
         ImGui::InputText(_("BIOS file"), const_cast<char*>(reinterpret_cast<const char*>(bios.c_str())), bios.length(),
                          ImGuiInputTextFlags_ReadOnly);
@@ -2501,6 +2518,7 @@ bool PCSX::GUI::about() {
 }
 
 void PCSX::GUI::update(bool vsync) {
+    ZoneScoped;
     glDisable(GL_SCISSOR_TEST);
     endFrame();
     startFrame();
@@ -2635,28 +2653,12 @@ bool PCSX::GUI::loadSaveState(std::filesystem::path filename) {
     if (filename.is_relative()) {
         filename = g_system->getPersistentDir() / filename;
     }
-    ZReader save(new PosixFile(filename));
-    if (save.failed()) return false;
-    std::ostringstream os;
-    constexpr unsigned buff_size = 1 << 16;
-    char* buff = new char[buff_size];
-    bool error = false;
-
-    while (!save.eof()) {
-        auto cnt = save.read(buff, buff_size);
-        if (cnt == 0) break;
-        if (cnt < 0) {
-            error = true;
-            break;
-        }
-        os.write(buff, cnt);
-    }
-
-    save.close();
-    delete[] buff;
-
-    if (!error) SaveStates::load(os.str());
-    return !error;
+    IO<File> save(new ZReader(new PosixFile(filename)));
+    // Inflated and decoded on the fly, straight into the emulated memory.
+    bool success = !save->failed() && SaveStates::load(save);
+    save->close();
+    if (!success) addNotification(fmt::format(f_("Unable to load save state {}"), filename.filename().string()));
+    return success;
 }
 
 bool PCSX::GUI::deleteSaveState(std::filesystem::path filename) {
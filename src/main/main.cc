@@ -97,6 +97,7 @@ class SystemImpl final : public PCSX::System {
 
     virtual void update(bool vsync = false) final override {
         // called on vblank to update states
+        m_eventBus->flush();
         s_ui->update(vsync);
     }
 
@@ -279,6 +280,13 @@ int pcsxMain(int argc, char **argv) {
             emuSettings.get<PCSX::Emulator::SettingFastBoot>() = false;
         }
 
+        if (args.get<bool>("hle")) {
+            emuSettings.get<PCSX::Emulator::SettingKernelHLE>() = true;
+        }
+        if (args.get<bool>("no-hle")) {
+            emuSettings.get<PCSX::Emulator::SettingKernelHLE>() = false;
+        }
+
         if (args.get<bool>("gdb")) {
             debugSettings.get<PCSX::Emulator::DebugSettings::GdbServer>() = true;
         }
@@ -375,6 +383,7 @@ runner.init({
     emulator->m_gpu->setCachedDithering(emuSettings.get<PCSX::Emulator::SettingCachedDithering>());
     emulator->m_gpu->setLinearFiltering();
     emulator->reset();
+    s_ui->restoreBootCache();
 
     // Looking at setting up what to run exactly within the emulator, if requested.
     if (args.get<bool>("run")) system->resume();
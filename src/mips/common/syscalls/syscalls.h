@@ -142,6 +142,12 @@ static __attribute__((always_inline)) char *syscall_strrchr(const char *s, int c
     return ((char *(*)(const char *, int c))0xa0)(s, c);
 }
 
+static __attribute__((always_inline)) void *syscall_bzero(void *ptr, size_t count) {
+    register int n asm("t1") = 0x28;
+    __asm__ volatile("" : "=r"(n) : "r"(n));
+    return ((void *(*)(void *, size_t))0xa0)(ptr, count);
+}
+
 static __attribute__((always_inline)) void *syscall_memcpy(void *dst, const void *src, size_t count) {
     register int n asm("t1") = 0x2a;
     __asm__ volatile("" : "=r"(n) : "r"(n));
@@ -154,6 +160,12 @@ static __attribute__((always_inline)) void *syscall_memset(void *dst, int c, siz
     return ((void *(*)(void *, int, size_t))0xa0)(dst, c, count);
 }
 
+static __attribute__((always_inline)) void *syscall_memmove(void *dst, const void *src, size_t count) {
+    register int n asm("t1") = 0x2c;
+    __asm__ volatile("" : "=r"(n) : "r"(n));
+    return ((void *(*)(void *, const void *, size_t))0xa0)(dst, src, count);
+}
+
 static __attribute__((always_inline)) void syscall_qsort(void *base, size_t nel, size_t width,
                                                          int (*compar)(const void *, const void *)) {
     register int n asm("t1") = 0x31;
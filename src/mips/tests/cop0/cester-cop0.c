@@ -79,6 +79,8 @@ CESTER_BODY(
     uint32_t linkandload();
     uint32_t lwandlink();
     uint32_t nolink();
+    uint32_t tracedcallee();
+    uint32_t tracedloop(uint32_t count);
 
     static int s_interruptsWereEnabled;
 )
@@ -229,3 +229,16 @@ CESTER_TEST(nolink, cpu_tests,
     uint32_t r = nolink();
     cester_assert_uint_ne(0, r);
 )
+
+CESTER_TEST(traces, cpu_tests,
+    volatile uint32_t * code = (volatile uint32_t *) tracedcallee;
+    uint32_t r = tracedloop(1000);
+    cester_assert_uint_eq(1000, r);
+    // li $v0, 2, over the li $v0, 1 the loop's trace holds a copy of
+    code[0] = 0x24020002;
+    r = tracedloop(1000);
+    cester_assert_uint_eq(2000, r);
+    code[0] = 0x24020001;
+    r = tracedloop(1000);
+    cester_assert_uint_eq(1000, r);
+)
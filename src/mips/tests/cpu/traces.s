@@ -0,0 +1,58 @@
+/*
+
+MIT License
+
+Copyright (c) 2024 PCSX-Redux authors
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+    .set push
+    .set noreorder
+    .section .ramtext, "ax", @progbits
+    .align 2
+    .global tracedcallee
+    .type tracedcallee, @function
+
+/* The test overwrites the first instruction, so the write lands on the
+   start of the block, which is all a plain block gets invalidated for. */
+tracedcallee:
+    li    $v0, 1
+    jr    $ra
+    nop
+
+    .global tracedloop
+    .type tracedloop, @function
+
+/* Calls tracedcallee $a0 times, and returns the sum of what it returned.
+   The loop head gets hot enough for the dynarec to turn it into a trace,
+   which holds a copy of tracedcallee. */
+tracedloop:
+    move  $t1, $ra
+    move  $v1, $0
+1:
+    jal   tracedcallee
+    addiu $a0, $a0, -1
+    addu  $v1, $v1, $v0
+    bnez  $a0, 1b
+    nop
+    jr    $t1
+    move  $v0, $v1
@@ -0,0 +1,123 @@
+/*
+
+MIT License
+
+Copyright (c) 2024 PCSX-Redux authors
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "common/hardware/pcsxhw.h"
+#include "common/syscalls/syscalls.h"
+
+// These exercise the A0 library calls which the emulator may run natively when
+// kernel HLE is enabled, so the same expectations apply to both LLE and HLE runs.
+//
+// The test runner installs a Lua function in the exec slot below, which reads
+// an A0 call number from the first word of the scratchpad, and writes back how
+// many times the emulator ran that call natively in the second word, and
+// whether kernel HLE is enabled at all in the third. See tests/pcsxrunner/libc.cc.
+#define HLE_QUERY_SLOT 0x48
+
+static volatile uint32_t * const s_hleQuery = (volatile uint32_t *)0x1f800000;
+
+static uint32_t hleCalls(uint32_t call) {
+    s_hleQuery[0] = call;
+    pcsx_execSlot(HLE_QUERY_SLOT);
+    return s_hleQuery[1];
+}
+
+// How many out of `count` calls have to have run natively, as of the last query.
+static uint32_t hleExpected(uint32_t count) { return s_hleQuery[2] ? count : 0; }
+
+// clang-format off
+
+CESTER_TEST(hleMemcpy, test_instance,
+    char in[300];
+    char out[302];
+    for (unsigned i = 0; i < sizeof(in); i++) in[i] = i * 7;
+    syscall_memset(out, 0x55, sizeof(out));
+    uint32_t calls = hleCalls(0x2a);
+    void * s = syscall_memcpy(out + 1, in, sizeof(in));
+    cester_assert_uint_eq(hleExpected(1), hleCalls(0x2a) - calls);
+    cester_assert_ptr_equal(out + 1, s);
+    cester_assert_int_eq(0x55, out[0]);
+    for (unsigned i = 0; i < sizeof(in); i++) cester_assert_int_eq(in[i], out[i + 1]);
+    cester_assert_int_eq(0x55, out[301]);
+)
+
+CESTER_TEST(hleMemmove, test_instance,
+    char b[16] = "0123456789abcde";
+    char c[16];
+    uint32_t calls = hleCalls(0x2c);
+    void * s = syscall_memmove(c, b, sizeof(b));
+    cester_assert_uint_eq(hleExpected(1), hleCalls(0x2c) - calls);
+    cester_assert_ptr_equal(c, s);
+    cester_assert_str_equal("0123456789abcde", c);
+    // Overlapping moves depend on the copy order, and always go through the BIOS.
+    calls = hleCalls(0x2c);
+    s = syscall_memmove(b, b + 4, 8);
+    cester_assert_uint_eq(0, hleCalls(0x2c) - calls);
+    cester_assert_ptr_equal(b, s);
+    cester_assert_str_equal("456789ab89abcde", b);
+)
+
+CESTER_TEST(hleMemset, test_instance,
+    char b[66];
+    b[0] = 'x';
+    b[65] = 0;
+    uint32_t calls = hleCalls(0x2b);
+    void * s = syscall_memset(b + 1, 'm', 64);
+    cester_assert_uint_eq(hleExpected(1), hleCalls(0x2b) - calls);
+    cester_assert_ptr_equal(b + 1, s);
+    cester_assert_int_eq('x', b[0]);
+    for (unsigned i = 1; i < 65; i++) cester_assert_int_eq('m', b[i]);
+    cester_assert_int_eq(0, b[65]);
+)
+
+CESTER_TEST(hleBzero, test_instance,
+    char b[8] = "abcdefg";
+    uint32_t calls = hleCalls(0x28);
+    void * s = syscall_bzero(b + 2, 3);
+    cester_assert_uint_eq(hleExpected(1), hleCalls(0x28) - calls);
+    cester_assert_ptr_equal(b + 2, s);
+    cester_assert_int_eq('b', b[1]);
+    cester_assert_int_eq(0, b[2]);
+    cester_assert_int_eq(0, b[3]);
+    cester_assert_int_eq(0, b[4]);
+    cester_assert_int_eq('f', b[5]);
+)
+
+CESTER_TEST(hleStrlen, test_instance,
+    uint32_t calls = hleCalls(0x1b);
+    cester_assert_uint_eq(0, syscall_strlen(""));
+    cester_assert_uint_eq(13, syscall_strlen("Hello, world!"));
+    cester_assert_uint_eq(hleExpected(2), hleCalls(0x1b) - calls);
+)
+
+CESTER_TEST(hleStrcmp, test_instance,
+    uint32_t calls = hleCalls(0x17);
+    cester_assert_int_eq(0, syscall_strcmp("abc", "abc"));
+    cester_assert_int_eq(1, syscall_strcmp("abc", "abd") < 0);
+    cester_assert_int_eq(1, syscall_strcmp("abd", "abc") > 0);
+    cester_assert_int_eq(1, syscall_strcmp("ab", "abc") < 0);
+    cester_assert_int_eq(1, syscall_strcmp("abc", "ab") > 0);
+    cester_assert_uint_eq(hleExpected(5), hleCalls(0x17) - calls);
+)
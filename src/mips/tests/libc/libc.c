@@ -32,4 +32,5 @@ SOFTWARE.
 #include "exotic/cester.h"
 #include "longjmp.c"
 #include "qsort.c"
+#include "hle.c"
 #include "string.c"
@@ -31,6 +31,7 @@
 #include "spu/miniaudio.h"
 #include "spu/types.h"
 #include "support/settings.h"
+#include "tracy/public/tracy/Tracy.hpp"
 
 namespace PCSX {
 
@@ -215,7 +216,7 @@ class impl final : public SPUInterface {
         int32_t endIndex = 0;
         int32_t currIndex = 0;
     };
-    std::mutex cbMtx;
+    TracyLockable(std::mutex, cbMtx);
 
     // The temporary cap buffer for CD Audio left/right.
     CaptureBuffer captureBuffer;
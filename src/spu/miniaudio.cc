@@ -233,7 +233,7 @@ void PCSX::SPU::MiniAudio::callbackNull(ma_device* device, float* output, ma_uin
     m_triggered++;
     m_triggered.notify_one();
 #else
-    std::unique_lock<std::mutex> l(m_mu);
+    std::unique_lock<LockableBase(std::mutex)> l(m_mu);
     auto goalpost = m_goalpost;
     if (goalpost == m_previousGoalpost) return;
 
@@ -23,6 +23,8 @@
 
 #include <array>
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -38,6 +40,7 @@
 #include "spu/settings.h"
 #include "support/circular.h"
 #include "support/eventbus.h"
+#include "tracy/public/tracy/Tracy.hpp"
 
 #if defined(_MSC_VER) || defined(__linux__)
 #define HAS_ATOMIC_WAIT 1
@@ -99,7 +102,7 @@ class MiniAudio {
         m_triggered.wait(triggered);
 #else
         // and until the rest of the world catches on, we'll have to do this instead:
-        std::unique_lock<std::mutex> l(m_mu);
+        std::unique_lock<LockableBase(std::mutex)> l(m_mu);
         auto triggered = m_triggered;
         m_goalpost = goal;
         m_cv.wait(l, [this, triggered]() { return m_triggered != triggered; });
@@ -134,8 +137,9 @@ class MiniAudio {
 #else
     uint32_t m_goalpost = 0;
     uint32_t m_triggered = 0;
-    std::mutex m_mu;
-    std::condition_variable m_cv;
+    // condition_variable_any, since the Tracy lockable isn't a plain std::mutex.
+    TracyLockable(std::mutex, m_mu);
+    std::condition_variable_any m_cv;
 #endif
     uint32_t m_previousGoalpost = 0;
 
@@ -479,6 +479,8 @@ void PCSX::SPU::impl::MainThread() {
                     1;  // if a new channel kicks in (or, of course, sound buffer runs low), we will leave the loop
         }
 
+        ZoneScopedN("SPU mix");
+
         //--------------------------------------------------// continue from irq handling in timer mode?
 
         if (lastch >= 0)  // will be -1 if no continue is pending
@@ -509,11 +511,11 @@ void PCSX::SPU::impl::MainThread() {
                 if (!pChannel->data.get<PCSX::SPU::Chan::On>().value) {
                     // Although the voices may stop outputting audio, the capture buffer is still filling up.
                     if (pMixIrq && ch == 1) {
-                        std::unique_lock<std::mutex> lock(cbMtx);
+                        std::unique_lock<LockableBase(std::mutex)> lock(cbMtx);
                         for (int c = 0; c < NSSIZE; c++) spuMem[tmpCapVoice1Index + c + 0x400] = 0;
                         tmpCapVoice1Index = (tmpCapVoice1Index + NSSIZE) % 0x200;
                     } else if (pMixIrq && ch == 3) {
-                        std::unique_lock<std::mutex> lock(cbMtx);
+                        std::unique_lock<LockableBase(std::mutex)> lock(cbMtx);
                         for (int c = 0; c < NSSIZE; c++) spuMem[tmpCapVoice3Index + c + 0x600] = 0;
                         tmpCapVoice3Index = (tmpCapVoice3Index + NSSIZE) % 0x200;
                     }
@@ -546,11 +548,11 @@ void PCSX::SPU::impl::MainThread() {
                                 // Although the voices may stop outputting audio, the capture buffer is still filling
                                 // up. At this point, ns samples are already filled, we need (NSSIZE-ns) more samples.
                                 if (pMixIrq && ch == 1) {
-                                    std::unique_lock<std::mutex> lock(cbMtx);
+                                    std::unique_lock<LockableBase(std::mutex)> lock(cbMtx);
                                     for (int c = ns; c < NSSIZE; c++) spuMem[tmpCapVoice1Index + c + 0x400] = 0;
                                     tmpCapVoice1Index = (tmpCapVoice1Index + (NSSIZE - ns)) % 0x200;
                                 } else if (pMixIrq && ch == 3) {
-                                    std::unique_lock<std::mutex> lock(cbMtx);
+                                    std::unique_lock<LockableBase(std::mutex)> lock(cbMtx);
                                     for (int c = ns; c < NSSIZE; c++) spuMem[tmpCapVoice3Index + c + 0x600] = 0;
                                     tmpCapVoice3Index = (tmpCapVoice3Index + (NSSIZE - ns)) % 0x200;
                                 }
@@ -677,11 +679,11 @@ void PCSX::SPU::impl::MainThread() {
                     // processing?
                     mixedSample = std::min(0xFFFF, std::max(-0xFFFF, mixedSample));
                     if (pMixIrq && ch == 1) {
-                        std::unique_lock<std::mutex> lock(cbMtx);
+                        std::unique_lock<LockableBase(std::mutex)> lock(cbMtx);
                         spuMem[tmpCapVoice1Index + 0x400] = mixedSample;
                         tmpCapVoice1Index = (tmpCapVoice1Index + 1) % 0x200;
                     } else if (pMixIrq && ch == 3) {
-                        std::unique_lock<std::mutex> lock(cbMtx);
+                        std::unique_lock<LockableBase(std::mutex)> lock(cbMtx);
                         spuMem[tmpCapVoice3Index + 0x600] = mixedSample;
                         tmpCapVoice3Index = (tmpCapVoice3Index + 1) % 0x200;
                     }
@@ -816,7 +818,7 @@ void PCSX::SPU::impl::MainThread() {
 
 void PCSX::SPU::impl::writeCaptureBufferCD(int numbSamples) {
     if (pMixIrq) {
-        std::unique_lock<std::mutex> lock(cbMtx);
+        std::unique_lock<LockableBase(std::mutex)> lock(cbMtx);
         for (int n = 0; n < numbSamples; n++) {
             if (captureBuffer.startIndex == captureBuffer.endIndex) {
                 // If there are no samples left in the temp buffer,
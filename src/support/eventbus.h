@@ -26,33 +26,75 @@ SOFTWARE.
 
 #pragma once
 
-#include <any>
+#include <atomic>
 #include <functional>
 #include <memory>
-#include <typeindex>
-#include <typeinfo>
+#include <mutex>
+#include <type_traits>
 #include <utility>
-
-#include "support/hashtable.h"
-#include "support/list.h"
+#include <vector>
 
 namespace PCSX {
 
 namespace EventBus {
 
-struct ListenerElementBaseEventBusList {};
-struct ListenerElementBase;
-typedef PCSX::Intrusive::List<ListenerElementBase> ListenerBaseListType;
-typedef PCSX::Intrusive::List<ListenerElementBase, ListenerElementBaseEventBusList> ListenerBaseEventBusList;
-struct ListenerElementBase : public ListenerBaseListType::Node, public ListenerBaseEventBusList::Node {
-    virtual std::any getCB() = 0;
+// Each event type gets a dense index the first time it's used, which is then
+// used to directly address its listeners, instead of hashing its type.
+struct EventIndex {
+    template <typename Event>
+    static size_t get() {
+        static const size_t index = s_counter++;
+        return index;
+    }
+
+  private:
+    static inline std::atomic<size_t> s_counter = 0;
+};
+
+struct ListenersBase {
+    virtual ~ListenersBase() = default;
+    virtual void remove(uint64_t id) = 0;
 };
-template <typename M>
-struct ListenerElement : public ListenerElementBase {
-    typedef std::function<void(const M&)> Functor;
-    virtual std::any getCB() { return &cb; }
-    ListenerElement(Functor&& cb) : cb(std::move(cb)) {}
-    Functor cb;
+
+// Contiguous array of the listeners of a given event type. Listeners can be
+// added or removed from within a callback: removals are deferred until the
+// outermost signal for that event returns, and the functors are heap allocated
+// so they don't move while the array grows.
+template <typename Event>
+struct Listeners : public ListenersBase {
+    typedef std::function<void(const Event&)> Functor;
+    struct Slot {
+        uint64_t id;
+        std::unique_ptr<Functor> cb;
+    };
+    void signal(const Event& event) {
+        m_depth++;
+        for (size_t i = 0; i < m_slots.size(); i++) {
+            if (m_slots[i].id) (*m_slots[i].cb)(event);
+        }
+        if ((--m_depth == 0) && m_dirty) {
+            std::erase_if(m_slots, [](const Slot& slot) { return slot.id == 0; });
+            m_dirty = false;
+        }
+    }
+    void add(uint64_t id, Functor&& cb) { m_slots.push_back({id, std::make_unique<Functor>(std::move(cb))}); }
+    virtual void remove(uint64_t id) final override {
+        for (auto it = m_slots.begin(); it != m_slots.end(); it++) {
+            if (it->id != id) continue;
+            if (m_depth) {
+                it->id = 0;
+                m_dirty = true;
+            } else {
+                m_slots.erase(it);
+            }
+            return;
+        }
+    }
+
+  private:
+    std::vector<Slot> m_slots;
+    unsigned m_depth = 0;
+    bool m_dirty = false;
 };
 
 class EventBus;
@@ -60,54 +102,69 @@ class EventBus;
 class Listener {
   public:
     Listener(std::shared_ptr<EventBus> bus) : m_bus(bus) {}
-    ~Listener() { m_listeners.destroyAll(); }
+    ~Listener();
     template <typename Event>
-    void listen(typename ListenerElement<Event>::Functor&& cb);
+    void listen(typename Listeners<Event>::Functor&& cb);
 
   private:
     std::shared_ptr<EventBus> m_bus;
-    ListenerBaseListType m_listeners;
-};
-
-struct ListenerElementsHashTableList;
-typedef PCSX::Intrusive::HashTable<std::size_t, ListenerElementsHashTableList> ListenersHashTable;
-struct ListenerElementsHashTableList : public ListenersHashTable::Node {
-    ~ListenerElementsHashTableList() { list.destroyAll(); }
-    ListenerBaseEventBusList list;
+    std::vector<std::pair<size_t, uint64_t>> m_listeners;
 };
 
 class EventBus {
   public:
-    ~EventBus() { m_table.destroyAll(); }
     template <typename Event>
     void signal(const Event& event) {
-        using Functor = typename ListenerElement<Event>::Functor;
-        auto list = m_table.find(typeid(Event).hash_code());
-        if (list == m_table.end()) return;
-        for (auto& listener : list->list) {
-            std::any cb = listener.getCB();
-            Functor* func = std::any_cast<Functor*>(cb);
-            (*func)(event);
+        auto index = EventIndex::get<Event>();
+        if (index >= m_listeners.size()) return;
+        auto& listeners = m_listeners[index];
+        if (!listeners) return;
+        static_cast<Listeners<Event>*>(listeners.get())->signal(event);
+    }
+    // Thread safe: queues the event, to be signaled from the main thread on the
+    // next call to flush(). Events posted together are delivered in order.
+    template <typename Event>
+    void post(Event&& event) {
+        typedef std::decay_t<Event> Decayed;
+        std::unique_lock<std::mutex> lock(m_postedMutex);
+        m_posted.emplace_back([this, event = Decayed(std::forward<Event>(event))]() { signal<Decayed>(event); });
+    }
+    void flush() {
+        std::vector<std::function<void()>> posted;
+        {
+            std::unique_lock<std::mutex> lock(m_postedMutex);
+            if (m_posted.empty()) return;
+            posted.swap(m_posted);
         }
+        for (auto& signal : posted) signal();
     }
 
   private:
-    void listen(std::size_t id, ListenerElementBase* listenerElement) {
-        auto list = m_table.find(id);
-        if (list == m_table.end()) {
-            list = m_table.insert(id, new ListenerElementsHashTableList());
-        }
-        list->list.push_back(listenerElement);
+    template <typename Event>
+    Listeners<Event>* getListeners() {
+        auto index = EventIndex::get<Event>();
+        if (index >= m_listeners.size()) m_listeners.resize(index + 1);
+        auto& listeners = m_listeners[index];
+        if (!listeners) listeners.reset(new Listeners<Event>());
+        return static_cast<Listeners<Event>*>(listeners.get());
     }
-    ListenersHashTable m_table;
+    void unlisten(size_t index, uint64_t id) { m_listeners[index]->remove(id); }
+    std::vector<std::unique_ptr<ListenersBase>> m_listeners;
+    uint64_t m_nextId = 1;
+    std::mutex m_postedMutex;
+    std::vector<std::function<void()>> m_posted;
     friend class Listener;
 };
 
+inline Listener::~Listener() {
+    for (auto& [index, id] : m_listeners) m_bus->unlisten(index, id);
+}
+
 template <typename Event>
-void Listener::listen(typename ListenerElement<Event>::Functor&& cb) {
-    ListenerElement<Event>* element = new ListenerElement(std::move(cb));
-    m_listeners.push_back(element);
-    m_bus->listen(typeid(Event).hash_code(), element);
+void Listener::listen(typename Listeners<Event>::Functor&& cb) {
+    uint64_t id = m_bus->m_nextId++;
+    m_bus->getListeners<Event>()->add(id, std::move(cb));
+    m_listeners.emplace_back(EventIndex::get<Event>(), id);
 }
 
 }  // namespace EventBus
@@ -0,0 +1,340 @@
+/*
+
+MIT License
+
+Copyright (c) 2024 PCSX-Redux authors
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "support/flac-decoder.h"
+
+#include <vector>
+
+#include "support/table-generator.h"
+
+namespace {
+
+struct CRC8Generator {
+    static consteval uint8_t calculateValue(std::size_t i) {
+        uint8_t crc = i;
+        for (unsigned j = 0; j < 8; j++) crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+        return crc;
+    }
+};
+
+struct CRC16Generator {
+    static consteval uint16_t calculateValue(std::size_t i) {
+        uint16_t crc = i << 8;
+        for (unsigned j = 0; j < 8; j++) crc = (crc & 0x8000) ? (crc << 1) ^ 0x8005 : crc << 1;
+        return crc;
+    }
+};
+
+constexpr auto c_crc8 = PCSX::generateTable<256, CRC8Generator>();
+constexpr auto c_crc16 = PCSX::generateTable<256, CRC16Generator>();
+
+class BitReader {
+  public:
+    BitReader(const uint8_t* src, size_t size) : m_src(src), m_size(size) {}
+
+    uint32_t read(unsigned bits) {
+        if (bits == 0) return 0;
+        refill();
+        if (m_bits < bits) {
+            m_error = true;
+            return 0;
+        }
+        uint32_t ret = (m_cache >> (m_bits - bits)) & ((uint64_t(1) << bits) - 1);
+        m_bits -= bits;
+        return ret;
+    }
+    int32_t readSigned(unsigned bits) {
+        if (bits == 0) return 0;
+        uint32_t v = read(bits);
+        return int32_t(v << (32 - bits)) >> (32 - bits);
+    }
+    // Counts the zeroes before the next set bit, and consumes all of them.
+    uint32_t readUnary() {
+        uint32_t ret = 0;
+        while (true) {
+            refill();
+            if (m_bits == 0) {
+                m_error = true;
+                return 0;
+            }
+            uint64_t window = m_bits == 64 ? m_cache : m_cache & ((uint64_t(1) << m_bits) - 1);
+            if (window == 0) {
+                ret += m_bits;
+                m_bits = 0;
+                continue;
+            }
+            unsigned zeroes = m_bits - 1 - (63 - __builtin_clzll(window));
+            ret += zeroes;
+            m_bits -= zeroes + 1;
+            return ret;
+        }
+    }
+    void alignToByte() { m_bits -= m_bits & 7; }
+    // Byte position of the next bit to read; only meaningful when aligned.
+    size_t position() const { return m_pos - m_bits / 8; }
+    bool error() const { return m_error; }
+
+  private:
+    void refill() {
+        while ((m_bits <= 56) && (m_pos < m_size)) {
+            m_cache = (m_cache << 8) | m_src[m_pos++];
+            m_bits += 8;
+        }
+    }
+
+    const uint8_t* m_src;
+    size_t m_size;
+    size_t m_pos = 0;
+    uint64_t m_cache = 0;
+    unsigned m_bits = 0;
+    bool m_error = false;
+};
+
+class Decoder {
+  public:
+    Decoder(const uint8_t* src, size_t srcSize, unsigned channels)
+        : m_src(src), m_size(srcSize), m_bits(src, srcSize), m_channels(channels) {}
+
+    ssize_t run(int16_t* dest, size_t samples) {
+        size_t done = 0;
+        while (done < samples) {
+            unsigned blockSize = frame();
+            if (blockSize == 0) return -1;
+            unsigned count = std::min(size_t(blockSize), samples - done);
+            for (unsigned i = 0; i < count; i++) {
+                for (unsigned c = 0; c < m_channels; c++) {
+                    *dest++ = int16_t(m_samples[c][i]);
+                }
+            }
+            done += count;
+        }
+        return m_bits.position();
+    }
+
+  private:
+    static unsigned sampleSize(unsigned code) {
+        switch (code) {
+            case 0:
+                return 16;
+            case 1:
+                return 8;
+            case 2:
+                return 12;
+            case 4:
+                return 16;
+            case 5:
+                return 20;
+            case 6:
+                return 24;
+            case 7:
+                return 32;
+        }
+        return 0;
+    }
+
+    // Decodes one frame into m_samples, and returns its block size, or 0 in case of error.
+    unsigned frame() {
+        size_t start = m_bits.position();
+        uint32_t sync = m_bits.read(16);
+        if ((sync & 0xfffe) != 0xfff8) return 0;
+        unsigned blockSizeCode = m_bits.read(4);
+        unsigned sampleRateCode = m_bits.read(4);
+        unsigned channelAssignment = m_bits.read(4);
+        unsigned bps = sampleSize(m_bits.read(3));
+        m_bits.read(1);
+        // The frame or sample number is utf-8 encoded; we don't need it, but have to skip it.
+        uint32_t first = m_bits.read(8);
+        unsigned extra = 0;
+        while ((extra < 7) && (first & (0x80 >> extra))) extra++;
+        if (extra == 1) return 0;
+        if (extra > 1) m_bits.read(8 * (extra - 1));
+
+        unsigned blockSize = 0;
+        if (blockSizeCode == 1) {
+            blockSize = 192;
+        } else if ((blockSizeCode >= 2) && (blockSizeCode <= 5)) {
+            blockSize = 576 << (blockSizeCode - 2);
+        } else if (blockSizeCode == 6) {
+            blockSize = m_bits.read(8) + 1;
+        } else if (blockSizeCode == 7) {
+            blockSize = m_bits.read(16) + 1;
+        } else if (blockSizeCode >= 8) {
+            blockSize = 256 << (blockSizeCode - 8);
+        }
+        if (sampleRateCode == 12) {
+            m_bits.read(8);
+        } else if ((sampleRateCode == 13) || (sampleRateCode == 14)) {
+            m_bits.read(16);
+        }
+        size_t headerEnd = m_bits.position();
+        uint8_t crc8 = 0;
+        for (size_t i = start; i < headerEnd; i++) crc8 = c_crc8[crc8 ^ m_src[i]];
+        if (m_bits.read(8) != crc8) return 0;
+
+        if ((blockSize == 0) || (bps != 16)) return 0;
+        unsigned channels = channelAssignment < 8 ? channelAssignment + 1 : 2;
+        if ((channelAssignment > 10) || (channels != m_channels)) return 0;
+
+        for (unsigned c = 0; c < channels; c++) {
+            m_samples[c].resize(blockSize);
+            unsigned channelBps = bps;
+            if (((channelAssignment == 8) || (channelAssignment == 10)) && (c == 1)) channelBps++;
+            if ((channelAssignment == 9) && (c == 0)) channelBps++;
+            if (!subframe(m_samples[c].data(), blockSize, channelBps)) return 0;
+        }
+
+        m_bits.alignToByte();
+        size_t frameEnd = m_bits.position();
+        uint16_t crc16 = 0;
+        for (size_t i = start; i < frameEnd; i++) crc16 = (crc16 << 8) ^ c_crc16[(crc16 >> 8) ^ m_src[i]];
+        if (m_bits.read(16) != crc16) return 0;
+        if (m_bits.error()) return 0;
+
+        int32_t* a = m_samples[0].data();
+        int32_t* b = channels > 1 ? m_samples[1].data() : nullptr;
+        switch (channelAssignment) {
+            case 8:  // left/side
+                for (unsigned i = 0; i < blockSize; i++) b[i] = a[i] - b[i];
+                break;
+            case 9:  // side/right
+                for (unsigned i = 0; i < blockSize; i++) a[i] += b[i];
+                break;
+            case 10:  // mid/side
+                for (unsigned i = 0; i < blockSize; i++) {
+                    int32_t side = b[i];
+                    int32_t mid = (a[i] << 1) | (side & 1);
+                    a[i] = (mid + side) >> 1;
+                    b[i] = (mid - side) >> 1;
+                }
+                break;
+        }
+        return blockSize;
+    }
+
+    bool subframe(int32_t* out, unsigned blockSize, unsigned bps) {
+        if (m_bits.read(1) != 0) return false;
+        unsigned type = m_bits.read(6);
+        unsigned wasted = 0;
+        if (m_bits.read(1)) wasted = m_bits.readUnary() + 1;
+        if (wasted >= bps) return false;
+        bps -= wasted;
+
+        if (type == 0) {
+            int32_t v = m_bits.readSigned(bps);
+            for (unsigned i = 0; i < blockSize; i++) out[i] = v;
+        } else if (type == 1) {
+            for (unsigned i = 0; i < blockSize; i++) out[i] = m_bits.readSigned(bps);
+        } else if ((type >= 8) && (type <= 12)) {
+            unsigned order = type - 8;
+            if (order > blockSize) return false;
+            for (unsigned i = 0; i < order; i++) out[i] = m_bits.readSigned(bps);
+            if (!residual(out, blockSize, order)) return false;
+            switch (order) {
+                case 1:
+                    for (unsigned i = 1; i < blockSize; i++) out[i] += out[i - 1];
+                    break;
+                case 2:
+                    for (unsigned i = 2; i < blockSize; i++) out[i] += 2 * out[i - 1] - out[i - 2];
+                    break;
+                case 3:
+                    for (unsigned i = 3; i < blockSize; i++) out[i] += 3 * out[i - 1] - 3 * out[i - 2] + out[i - 3];
+                    break;
+                case 4:
+                    for (unsigned i = 4; i < blockSize; i++) {
+                        out[i] += 4 * out[i - 1] - 6 * out[i - 2] + 4 * out[i - 3] - out[i - 4];
+                    }
+                    break;
+            }
+        } else if (type >= 32) {
+            unsigned order = type - 31;
+            if (order > blockSize) return false;
+            for (unsigned i = 0; i < order; i++) out[i] = m_bits.readSigned(bps);
+            unsigned precision = m_bits.read(4) + 1;
+            if (precision == 16) return false;
+            int shift = m_bits.readSigned(5);
+            if (shift < 0) return false;
+            int32_t coefs[32];
+            for (unsigned i = 0; i < order; i++) coefs[i] = m_bits.readSigned(precision);
+            if (!residual(out, blockSize, order)) return false;
+            for (unsigned i = order; i < blockSize; i++) {
+                int64_t sum = 0;
+                for (unsigned j = 0; j < order; j++) sum += int64_t(coefs[j]) * out[i - 1 - j];
+                out[i] += int32_t(sum >> shift);
+            }
+        } else {
+            return false;
+        }
+
+        if (wasted) {
+            for (unsigned i = 0; i < blockSize; i++) out[i] <<= wasted;
+        }
+        return !m_bits.error();
+    }
+
+    // Reads the rice coded residual into out[order...blockSize - 1].
+    bool residual(int32_t* out, unsigned blockSize, unsigned order) {
+        unsigned method = m_bits.read(2);
+        if (method > 1) return false;
+        unsigned paramBits = method == 0 ? 4 : 5;
+        unsigned escape = method == 0 ? 15 : 31;
+        unsigned partitionOrder = m_bits.read(4);
+        unsigned partitions = 1 << partitionOrder;
+        if ((blockSize % partitions) != 0) return false;
+        unsigned partitionSize = blockSize >> partitionOrder;
+        if (partitionSize < order) return false;
+        unsigned i = order;
+        for (unsigned p = 0; p < partitions; p++) {
+            unsigned count = p == 0 ? partitionSize - order : partitionSize;
+            unsigned param = m_bits.read(paramBits);
+            if (param == escape) {
+                unsigned bits = m_bits.read(5);
+                for (unsigned j = 0; j < count; j++) out[i++] = m_bits.readSigned(bits);
+            } else {
+                for (unsigned j = 0; j < count; j++) {
+                    uint32_t v = m_bits.readUnary() << param;
+                    v |= m_bits.read(param);
+                    out[i++] = int32_t(v >> 1) ^ -int32_t(v & 1);
+                }
+            }
+            if (m_bits.error()) return false;
+        }
+        return true;
+    }
+
+    const uint8_t* m_src;
+    size_t m_size;
+    BitReader m_bits;
+    unsigned m_channels;
+    std::vector<int32_t> m_samples[8];
+};
+
+}  // namespace
+
+ssize_t PCSX::FLAC::decode(const uint8_t* src, size_t srcSize, int16_t* dest, size_t samples, unsigned channels) {
+    if ((channels == 0) || (channels > 8)) return -1;
+    Decoder decoder(src, srcSize, channels);
+    return decoder.run(dest, samples);
+}
@@ -0,0 +1,49 @@
+/*
+
+MIT License
+
+Copyright (c) 2024 PCSX-Redux authors
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "support/ssize_t.h"
+
+namespace PCSX {
+
+namespace FLAC {
+
+// Decodes a sequence of raw FLAC frames, without the stream marker nor any
+// metadata block, into interleaved 16 bits samples. Decoding stops once
+// `samples` samples per channel have been produced. Returns the offset in
+// the source right after the last decoded frame, or -1 if the stream is
+// corrupted, truncated, or isn't 16 bits audio with the right amount of
+// channels.
+ssize_t decode(const uint8_t* src, size_t srcSize, int16_t* dest, size_t samples, unsigned channels = 2);
+
+}  // namespace FLAC
+
+}  // namespace PCSX
@@ -0,0 +1,301 @@
+/*
+
+MIT License
+
+Copyright (c) 2024 PCSX-Redux authors
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "support/lzma-decoder.h"
+
+#include <memory>
+#include <vector>
+
+namespace {
+
+// This follows the reference decoder description from the LZMA SDK, with
+// the output buffer serving as the sliding window.
+class Decoder {
+  public:
+    Decoder(const uint8_t* src, size_t srcSize, uint8_t* dest, size_t destSize, unsigned lc, unsigned lp,
+            unsigned pb)
+        : m_src(src), m_srcSize(srcSize), m_dest(dest), m_destSize(destSize), m_lc(lc), m_lp(lp), m_pb(pb) {
+        m_literals.resize(0x300 << (lc + lp), c_probInit);
+        for (auto& p : m_posDecoders) p = c_probInit;
+        for (auto& p : m_isMatch) p = c_probInit;
+        for (auto& p : m_isRep) p = c_probInit;
+        for (auto& p : m_isRepG0) p = c_probInit;
+        for (auto& p : m_isRepG1) p = c_probInit;
+        for (auto& p : m_isRepG2) p = c_probInit;
+        for (auto& p : m_isRep0Long) p = c_probInit;
+    }
+
+    ssize_t run() {
+        if (!initRange()) return -1;
+
+        unsigned state = 0;
+        uint32_t rep0 = 0, rep1 = 0, rep2 = 0, rep3 = 0;
+        unsigned pbMask = (1 << m_pb) - 1;
+
+        while (m_pos < m_destSize) {
+            unsigned posState = m_pos & pbMask;
+            if (decodeBit(&m_isMatch[(state << c_numPosBitsMax) + posState]) == 0) {
+                decodeLiteral(state, rep0);
+                state = state < 4 ? 0 : (state < 10 ? state - 3 : state - 6);
+                if (m_error) return -1;
+                continue;
+            }
+
+            unsigned len;
+            if (decodeBit(&m_isRep[state]) != 0) {
+                if (m_pos == 0) return -1;
+                if (decodeBit(&m_isRepG0[state]) == 0) {
+                    if (decodeBit(&m_isRep0Long[(state << c_numPosBitsMax) + posState]) == 0) {
+                        if (rep0 >= m_pos) return -1;
+                        state = state < 7 ? 9 : 11;
+                        m_dest[m_pos] = m_dest[m_pos - rep0 - 1];
+                        m_pos++;
+                        if (m_error) return -1;
+                        continue;
+                    }
+                } else {
+                    uint32_t dist;
+                    if (decodeBit(&m_isRepG1[state]) == 0) {
+                        dist = rep1;
+                    } else {
+                        if (decodeBit(&m_isRepG2[state]) == 0) {
+                            dist = rep2;
+                        } else {
+                            dist = rep3;
+                            rep3 = rep2;
+                        }
+                        rep2 = rep1;
+                    }
+                    rep1 = rep0;
+                    rep0 = dist;
+                }
+                len = m_repLen.decode(this, posState);
+                state = state < 7 ? 8 : 11;
+            } else {
+                rep3 = rep2;
+                rep2 = rep1;
+                rep1 = rep0;
+                len = m_len.decode(this, posState);
+                state = state < 7 ? 7 : 10;
+                rep0 = decodeDistance(len);
+                // End marker; we know the output size, so it's fine if it's there or not.
+                if (rep0 == 0xffffffff) break;
+            }
+
+            if (rep0 >= m_pos) return -1;
+            len += c_matchMinLen;
+            if (len > (m_destSize - m_pos)) return -1;
+            const uint8_t* from = m_dest + m_pos - rep0 - 1;
+            // The source and destination overlap when the distance is shorter than the length, on purpose.
+            for (unsigned i = 0; i < len; i++) m_dest[m_pos + i] = from[i];
+            m_pos += len;
+            if (m_error) return -1;
+        }
+
+        if (m_error) return -1;
+        return m_in;
+    }
+
+  private:
+    typedef uint16_t Prob;
+    static constexpr unsigned c_numBitModelTotalBits = 11;
+    static constexpr unsigned c_bitModelTotal = 1 << c_numBitModelTotalBits;
+    static constexpr unsigned c_numMoveBits = 5;
+    static constexpr Prob c_probInit = c_bitModelTotal / 2;
+    static constexpr unsigned c_numPosBitsMax = 4;
+    static constexpr unsigned c_numStates = 12;
+    static constexpr unsigned c_numLenToPosStates = 4;
+    static constexpr unsigned c_numAlignBits = 4;
+    static constexpr unsigned c_startPosModelIndex = 4;
+    static constexpr unsigned c_endPosModelIndex = 14;
+    static constexpr unsigned c_numFullDistances = 1 << (c_endPosModelIndex >> 1);
+    static constexpr unsigned c_matchMinLen = 2;
+
+    template <unsigned NumBits>
+    struct BitTree {
+        Prob probs[1 << NumBits];
+        BitTree() {
+            for (auto& p : probs) p = c_probInit;
+        }
+        unsigned decode(Decoder* d) {
+            unsigned m = 1;
+            for (unsigned i = 0; i < NumBits; i++) m = (m << 1) + d->decodeBit(&probs[m]);
+            return m - (1 << NumBits);
+        }
+        unsigned reverseDecode(Decoder* d) { return d->bitTreeReverseDecode(probs, NumBits); }
+    };
+
+    struct LenDecoder {
+        Prob choice = c_probInit;
+        Prob choice2 = c_probInit;
+        BitTree<3> low[1 << c_numPosBitsMax];
+        BitTree<3> mid[1 << c_numPosBitsMax];
+        BitTree<8> high;
+        unsigned decode(Decoder* d, unsigned posState) {
+            if (d->decodeBit(&choice) == 0) return low[posState].decode(d);
+            if (d->decodeBit(&choice2) == 0) return 8 + mid[posState].decode(d);
+            return 16 + high.decode(d);
+        }
+    };
+
+    uint8_t nextByte() {
+        if (m_in >= m_srcSize) {
+            m_error = true;
+            return 0;
+        }
+        return m_src[m_in++];
+    }
+
+    bool initRange() {
+        m_range = 0xffffffff;
+        m_code = 0;
+        uint8_t b = nextByte();
+        for (unsigned i = 0; i < 4; i++) m_code = (m_code << 8) | nextByte();
+        return (b == 0) && (m_code != m_range) && !m_error;
+    }
+
+    void normalize() {
+        if (m_range < (1 << 24)) {
+            m_range <<= 8;
+            m_code = (m_code << 8) | nextByte();
+        }
+    }
+
+    unsigned decodeBit(Prob* prob) {
+        unsigned v = *prob;
+        uint32_t bound = (m_range >> c_numBitModelTotalBits) * v;
+        unsigned symbol;
+        if (m_code < bound) {
+            v += (c_bitModelTotal - v) >> c_numMoveBits;
+            m_range = bound;
+            symbol = 0;
+        } else {
+            v -= v >> c_numMoveBits;
+            m_code -= bound;
+            m_range -= bound;
+            symbol = 1;
+        }
+        *prob = v;
+        normalize();
+        return symbol;
+    }
+
+    uint32_t decodeDirectBits(unsigned numBits) {
+        uint32_t res = 0;
+        do {
+            m_range >>= 1;
+            m_code -= m_range;
+            uint32_t t = 0 - (m_code >> 31);
+            m_code += m_range & t;
+            if (m_code == m_range) m_error = true;
+            normalize();
+            res <<= 1;
+            res += t + 1;
+        } while (--numBits);
+        return res;
+    }
+
+    unsigned bitTreeReverseDecode(Prob* probs, unsigned numBits) {
+        unsigned m = 1;
+        unsigned symbol = 0;
+        for (unsigned i = 0; i < numBits; i++) {
+            unsigned bit = decodeBit(&probs[m]);
+            m <<= 1;
+            m += bit;
+            symbol |= bit << i;
+        }
+        return symbol;
+    }
+
+    void decodeLiteral(unsigned state, uint32_t rep0) {
+        unsigned prevByte = m_pos > 0 ? m_dest[m_pos - 1] : 0;
+        unsigned litState = ((m_pos & ((1 << m_lp) - 1)) << m_lc) + (prevByte >> (8 - m_lc));
+        Prob* probs = &m_literals[0x300 * litState];
+        unsigned symbol = 1;
+        if ((state >= 7) && (m_pos > rep0)) {
+            unsigned matchByte = m_dest[m_pos - rep0 - 1];
+            do {
+                unsigned matchBit = (matchByte >> 7) & 1;
+                matchByte <<= 1;
+                unsigned bit = decodeBit(&probs[((1 + matchBit) << 8) + symbol]);
+                symbol = (symbol << 1) | bit;
+                if (matchBit != bit) break;
+            } while (symbol < 0x100);
+        }
+        while (symbol < 0x100) symbol = (symbol << 1) | decodeBit(&probs[symbol]);
+        m_dest[m_pos++] = symbol - 0x100;
+    }
+
+    uint32_t decodeDistance(unsigned len) {
+        unsigned lenState = len;
+        if (lenState > c_numLenToPosStates - 1) lenState = c_numLenToPosStates - 1;
+        unsigned posSlot = m_posSlot[lenState].decode(this);
+        if (posSlot < 4) return posSlot;
+        unsigned numDirectBits = (posSlot >> 1) - 1;
+        uint32_t dist = (2 | (posSlot & 1)) << numDirectBits;
+        if (posSlot < c_endPosModelIndex) {
+            dist += bitTreeReverseDecode(m_posDecoders + dist - posSlot, numDirectBits);
+        } else {
+            dist += decodeDirectBits(numDirectBits - c_numAlignBits) << c_numAlignBits;
+            dist += m_align.reverseDecode(this);
+        }
+        return dist;
+    }
+
+    const uint8_t* m_src;
+    size_t m_srcSize;
+    size_t m_in = 0;
+    uint8_t* m_dest;
+    size_t m_destSize;
+    size_t m_pos = 0;
+    unsigned m_lc, m_lp, m_pb;
+    bool m_error = false;
+
+    uint32_t m_range;
+    uint32_t m_code;
+
+    std::vector<Prob> m_literals;
+    BitTree<6> m_posSlot[c_numLenToPosStates];
+    BitTree<c_numAlignBits> m_align;
+    Prob m_posDecoders[1 + c_numFullDistances - c_endPosModelIndex];
+    LenDecoder m_len;
+    LenDecoder m_repLen;
+    Prob m_isMatch[c_numStates << c_numPosBitsMax];
+    Prob m_isRep[c_numStates];
+    Prob m_isRepG0[c_numStates];
+    Prob m_isRepG1[c_numStates];
+    Prob m_isRepG2[c_numStates];
+    Prob m_isRep0Long[c_numStates << c_numPosBitsMax];
+};
+
+}  // namespace
+
+ssize_t PCSX::LZMA::decode(const uint8_t* src, size_t srcSize, uint8_t* dest, size_t destSize, unsigned lc,
+                           unsigned lp, unsigned pb) {
+    if ((lc > 8) || (lp > 4) || (pb > 4)) return -1;
+    auto decoder = std::make_unique<Decoder>(src, srcSize, dest, destSize, lc, lp, pb);
+    return decoder->run();
+}
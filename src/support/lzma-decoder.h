@@ -0,0 +1,48 @@
+/*
+
+MIT License
+
+Copyright (c) 2024 PCSX-Redux authors
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "support/ssize_t.h"
+
+namespace PCSX {
+
+namespace LZMA {
+
+// Decodes a raw LZMA1 stream, without the usual 13 bytes header, into a
+// buffer of a known size. The output buffer doubles as the dictionary, so
+// it has to hold the whole decompressed data. Returns the amount of input
+// bytes consumed, or -1 if the stream is corrupted or truncated.
+ssize_t decode(const uint8_t* src, size_t srcSize, uint8_t* dest, size_t destSize, unsigned lc = 3, unsigned lp = 0,
+               unsigned pb = 2);
+
+}  // namespace LZMA
+
+}  // namespace PCSX
@@ -0,0 +1,90 @@
+/*
+
+MIT License
+
+Copyright (c) 2024 PCSX-Redux authors
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#if !defined(_WIN32) && !defined(_WIN64)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "support/mmapfile.h"
+
+void PCSX::MmapFile::map(size_t createSize) {
+    int fd = m_writable ? ::open(m_filename.string().c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)
+                        : ::open(m_filename.string().c_str(), O_RDONLY);
+    if (fd < 0) return;
+    if (m_writable && (ftruncate(fd, createSize) < 0)) {
+        ::close(fd);
+        return;
+    }
+    struct stat st;
+    if ((fstat(fd, &st) < 0) || (st.st_size == 0)) {
+        ::close(fd);
+        return;
+    }
+    void* base = m_writable ? mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                            : mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping holds its own reference to the file, so the descriptor isn't needed anymore.
+    ::close(fd);
+    if (base == MAP_FAILED) return;
+    m_data = static_cast<uint8_t*>(base);
+    m_size = st.st_size;
+}
+
+void PCSX::MmapFile::unmap() {
+    if (m_data) munmap(m_data, m_size);
+}
+
+void PCSX::MmapFile::advise(Advice advice) {
+    if (!m_data) return;
+    int flag = MADV_NORMAL;
+    switch (advice) {
+        case Advice::Normal:
+            flag = MADV_NORMAL;
+            break;
+        case Advice::Sequential:
+            flag = MADV_SEQUENTIAL;
+            break;
+        case Advice::Random:
+            flag = MADV_RANDOM;
+            break;
+    }
+    madvise(m_data, m_size, flag);
+}
+
+void PCSX::MmapFile::willNeed(size_t pos, size_t size) {
+    if (pos >= m_size) return;
+    size = std::min(m_size - pos, size);
+    // madvise wants a page aligned address.
+    static const size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t aligned = pos & ~(pageSize - 1);
+    madvise(m_data + aligned, size + pos - aligned, MADV_WILLNEED);
+}
+
+#endif
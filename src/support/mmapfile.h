@@ -0,0 +1,94 @@
+/*
+
+MIT License
+
+Copyright (c) 2024 PCSX-Redux authors
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <filesystem>
+
+#include "support/file.h"
+
+namespace PCSX {
+
+// Memory mapped file. Reads are plain memcpy calls out of the mapping, and
+// data() gives direct access to the whole file, which lets callers skip
+// copying entirely when they only need to look at the bytes.
+// The file is read-only, unless created with a fixed size up front, in which
+// case writes go straight into the shared mapping, and mutableData() lets
+// producers assemble their output in place. Writes can't grow the file.
+class MmapFile : public File {
+  public:
+    enum class Advice { Normal, Sequential, Random };
+
+    MmapFile(const std::filesystem::path& filename);
+    MmapFile(const std::filesystem::path& filename, FileOps::Create, size_t size);
+
+    virtual ssize_t rSeek(ssize_t pos, int wheel) final override;
+    virtual ssize_t rTell() final override { return m_ptrR; }
+    virtual size_t size() final override { return m_size; }
+    virtual ssize_t read(void* dest, size_t size) final override;
+    virtual ssize_t readAt(void* dest, size_t size, size_t ptr) final override;
+    virtual ssize_t wSeek(ssize_t pos, int wheel) final override;
+    virtual ssize_t wTell() final override { return m_ptrW; }
+    virtual ssize_t write(const void* src, size_t size) final override;
+    virtual ssize_t writeAt(const void* src, size_t size, size_t ptr) final override;
+    virtual bool eof() final override { return m_ptrR == m_size; }
+    virtual std::filesystem::path filename() final override { return m_filename; }
+    virtual File* dup() final override { return new MmapFile(m_filename); }
+    virtual bool failed() final override { return m_data == nullptr; }
+    virtual int getc() final override {
+        if (m_ptrR >= m_size) return -1;
+        return m_data[m_ptrR++];
+    }
+
+    // The mapping is valid until the file is closed.
+    const uint8_t* data() { return m_data; }
+    // Only available on files created writable; nullptr otherwise.
+    uint8_t* mutableData() { return m_writable ? m_data : nullptr; }
+    Slice borrow(size_t pos, size_t size);
+
+    // Paging hints; these are no-ops on platforms that don't support them.
+    void advise(Advice advice);
+    void willNeed(size_t pos, size_t size);
+
+  private:
+    virtual void closeInternal() final override;
+    void map(size_t createSize);
+    void unmap();
+
+    const std::filesystem::path m_filename;
+    uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    size_t m_ptrR = 0;
+    size_t m_ptrW = 0;
+    const bool m_writable = false;
+
+    void* m_fileHandle = nullptr;
+    void* m_mappingHandle = nullptr;
+};
+
+}  // namespace PCSX
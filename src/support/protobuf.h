@@ -29,6 +29,7 @@ SOFTWARE.
 #include <memory.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <ostream>
@@ -37,6 +38,7 @@ SOFTWARE.
 #include <type_traits>
 #include <vector>
 
+#include "support/file.h"
 #include "typestring.hh"
 
 namespace PCSX {
@@ -47,13 +49,26 @@ class OutOfBoundError {};
 
 class InSlice {
   public:
-    constexpr uint64_t bytesLeft() { return m_size - m_ptr; }
+    static constexpr uint64_t c_unbounded = ~uint64_t(0);
+    constexpr uint64_t bytesLeft() {
+        if (m_stream && (m_size == c_unbounded)) return m_stream->available(m_base + m_ptr) ? m_size - m_ptr : 0;
+        return m_size - m_ptr;
+    }
     InSlice(const uint8_t *data, uint64_t size) : m_data(data), m_size(size) {}
+    // Streams the message from the file's current read position instead of
+    // requiring it all in memory. Without a size, the message runs until the
+    // end of the file. Small reads go through a buffer, while getBytes into a
+    // caller buffer reads straight from the file, so large payloads land at
+    // their final destination in one copy.
+    InSlice(IO<File> file, uint64_t size = c_unbounded)
+        : m_streamHolder(std::make_shared<Stream>(file)), m_stream(m_streamHolder.get()), m_size(size) {}
     InSlice getSubSlice(uint64_t size) {
         boundsCheck(size);
         m_ptr += size;
+        if (m_stream) return InSlice(m_streamHolder, m_base + m_ptr - size, size);
         return InSlice(m_data + m_ptr - size, size);
     }
+    constexpr bool isStream() const { return m_stream; }
     constexpr uint8_t getU8() {
         boundsCheck(1);
         return getU8Safe();
@@ -85,10 +100,23 @@ class InSlice {
         return ret;
     }
     std::string getBytes(uint64_t size) {
+        if (m_stream) {
+            boundsCheck(size);
+            std::string ret(size, '\0');
+            m_stream->read(reinterpret_cast<uint8_t *>(ret.data()), size, m_base + m_ptr);
+            m_ptr += size;
+            return ret;
+        }
         skipBytes(size);
         return std::string(reinterpret_cast<const char *>(m_data + m_ptr - size), size);
     }
     void getBytes(uint8_t *data, uint64_t size) {
+        if (m_stream) {
+            boundsCheck(size);
+            m_stream->read(data, size, m_base + m_ptr);
+            m_ptr += size;
+            return;
+        }
         skipBytes(size);
         memcpy(data, m_data + m_ptr - size, size);
     }
@@ -109,14 +137,75 @@ class InSlice {
     }
 
   private:
-    const uint8_t *m_data;
+    // State shared between a streamed slice and its sub-slices. Slices are
+    // consumed in order, so each one only needs to know its absolute offset;
+    // bytes skipped by a slice are discarded when the next read catches up.
+    struct Stream {
+        Stream(IO<File> file) : file(file) {}
+        void seek(uint64_t target) {
+            while (position < target) {
+                if ((bufferPtr == bufferSize) && !refill()) throw OutOfBoundError();
+                uint64_t skip = std::min<uint64_t>(bufferSize - bufferPtr, target - position);
+                bufferPtr += skip;
+                position += skip;
+            }
+            if (position != target) throw OutOfBoundError();
+        }
+        bool available(uint64_t target) {
+            seek(target);
+            return (bufferPtr != bufferSize) || refill();
+        }
+        uint8_t getU8(uint64_t target) {
+            seek(target);
+            if ((bufferPtr == bufferSize) && !refill()) throw OutOfBoundError();
+            position++;
+            return buffer[bufferPtr++];
+        }
+        void read(uint8_t *dest, uint64_t size, uint64_t target) {
+            seek(target);
+            uint64_t buffered = std::min<uint64_t>(bufferSize - bufferPtr, size);
+            memcpy(dest, buffer + bufferPtr, buffered);
+            bufferPtr += buffered;
+            position += buffered;
+            dest += buffered;
+            size -= buffered;
+            while (size) {
+                ssize_t r = file->read(dest, size);
+                if (r <= 0) throw OutOfBoundError();
+                position += r;
+                dest += r;
+                size -= r;
+            }
+        }
+        bool refill() {
+            ssize_t r = file->read(buffer, sizeof(buffer));
+            bufferPtr = 0;
+            bufferSize = r > 0 ? r : 0;
+            return bufferSize != 0;
+        }
+        IO<File> file;
+        uint64_t position = 0;
+        size_t bufferPtr = 0;
+        size_t bufferSize = 0;
+        uint8_t buffer[4096];
+    };
+    InSlice(std::shared_ptr<Stream> stream, uint64_t base, uint64_t size)
+        : m_streamHolder(stream), m_stream(stream.get()), m_size(size), m_base(base) {}
+
+    const uint8_t *m_data = nullptr;
+    std::shared_ptr<Stream> m_streamHolder;
+    Stream *m_stream = nullptr;
     const uint64_t m_size;
+    uint64_t m_base = 0;
     uint64_t m_ptr = 0;
 
-    constexpr uint8_t getU8Safe() { return m_data[m_ptr++]; }
+    constexpr uint8_t getU8Safe() {
+        if (m_stream) return m_stream->getU8(m_base + m_ptr++);
+        return m_data[m_ptr++];
+    }
 
     constexpr void boundsCheck(uint64_t size) const {
-        if (m_ptr + size > m_size) throw OutOfBoundError();
+        if (size > m_size - m_ptr) throw OutOfBoundError();
     }
 };
 
@@ -331,8 +420,9 @@ struct FixedBytes {
     constexpr void deserialize(InSlice *slice, unsigned) {
         uint64_t size = slice->getVarInt();
         if (size > amount) throw OutOfBoundError();
-        reset();
+        allocate();
         slice->getBytes(value, size);
+        memset(value + size, 0, amount - size);
     }
     static constexpr char const typeName[] = "bytes";
     uint8_t *value = nullptr;
@@ -472,9 +562,20 @@ struct FieldPtr<FieldType, irqus::typestring<C...>, fieldNumberValue> {
         const FieldType *field = reinterpret_cast<const FieldType *>(&ref);
         field->serialize(slice);
     }
-    constexpr void deserialize(InSlice *slice, unsigned wireType) { copy.deserialize(slice, wireType); }
+    // When streaming, the payload is decoded straight into the destination,
+    // which means it's live before commit() gets called.
+    constexpr void deserialize(InSlice *slice, unsigned wireType) {
+        if (slice->isStream()) {
+            FieldType *field = reinterpret_cast<FieldType *>(&ref);
+            field->deserialize(slice, wireType);
+            inPlace = true;
+        } else {
+            copy.deserialize(slice, wireType);
+        }
+    }
     constexpr void reset() {}
     constexpr void commit() {
+        if (inPlace || !copy.hasData()) return;
         FieldType *field = reinterpret_cast<FieldType *>(&ref);
         field->copyFrom(copy.value);
     }
@@ -488,6 +589,7 @@ struct FieldPtr<FieldType, irqus::typestring<C...>, fieldNumberValue> {
   private:
     type ref;
     FieldType copy = FieldType();
+    bool inPlace = false;
 };
 
 template <typename FieldType, size_t amount, typename name, uint64_t fieldNumberValue>
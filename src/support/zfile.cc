@@ -98,6 +98,232 @@ ssize_t PCSX::ZReader::read(void *dest_, size_t size) {
     return ret;
 }
 
+PCSX::ZIndexedReader::ZIndexedReader(Internal, IO<File> file, ssize_t size, bool raw)
+    : File(RO_SEEKABLE), m_file(file), m_size(size), m_raw(raw) {
+    auto z = &m_zstream;
+    z->zalloc = Z_NULL;
+    z->zfree = Z_NULL;
+    z->opaque = Z_NULL;
+    z->avail_in = 0;
+    z->next_in = Z_NULL;
+    auto res = inflateInit2(z, raw ? -MAX_WBITS : MAX_WBITS + 32);
+    if (res != Z_OK) throw std::runtime_error("inflateInit2 didn't work");
+}
+
+PCSX::File *PCSX::ZIndexedReader::dup() {
+    auto reader = new ZIndexedReader(INTERNAL, m_file, m_size, m_raw);
+    reader->m_span = m_span;
+    reader->m_index = m_index;
+    return reader;
+}
+
+void PCSX::ZIndexedReader::reset() {
+    inflateReset2(&m_zstream, m_raw ? -MAX_WBITS : MAX_WBITS + 32);
+    m_zstream.avail_in = 0;
+    m_inPtr = 0;
+    m_outPtr = 0;
+    m_streamEnd = false;
+}
+
+bool PCSX::ZIndexedReader::restore(const Checkpoint &checkpoint) {
+    // Checkpoints are past the zlib or gzip header, so we always resume as a raw deflate stream.
+    if (inflateReset2(&m_zstream, -MAX_WBITS) != Z_OK) return false;
+    m_zstream.avail_in = 0;
+    m_inPtr = checkpoint.in;
+    m_streamEnd = false;
+    if (checkpoint.bits) {
+        uint8_t byte;
+        if (m_file->readAt(&byte, 1, checkpoint.in - 1) != 1) return false;
+        inflatePrime(&m_zstream, checkpoint.bits, byte >> (8 - checkpoint.bits));
+    }
+    size_t windowSize = checkpoint.window.size();
+    if (windowSize) inflateSetDictionary(&m_zstream, checkpoint.window.data(), windowSize);
+    for (size_t i = 0; i < windowSize; i++) {
+        m_window[(checkpoint.out - windowSize + i) % c_windowSize] = checkpoint.window[i];
+    }
+    m_outPtr = checkpoint.out;
+    return true;
+}
+
+ssize_t PCSX::ZIndexedReader::inflateSome(size_t max) {
+    if (!m_zstream.avail_in) {
+        // There may be nothing left to read while inflate still has pending output.
+        ssize_t block = m_file->readAt(m_inBuffer, sizeof(m_inBuffer), m_inPtr);
+        if (block > 0) {
+            m_inPtr += block;
+            m_zstream.avail_in = block;
+            m_zstream.next_in = m_inBuffer;
+        }
+    }
+    // Inflate straight into the circular window, without wrapping around,
+    // so the output is always a contiguous run starting at m_outPtr.
+    size_t pos = m_outPtr % c_windowSize;
+    size_t avail = std::min(c_windowSize - pos, max);
+    m_zstream.avail_out = avail;
+    m_zstream.next_out = m_window + pos;
+    auto res = inflate(&m_zstream, Z_BLOCK);
+    if ((res == Z_NEED_DICT) || ((res < 0) && (res != Z_BUF_ERROR))) return -1;
+    size_t produced = avail - m_zstream.avail_out;
+    // Running out of input before the end of the stream means it's truncated.
+    if ((res == Z_BUF_ERROR) && !produced && !m_zstream.avail_in) return -1;
+    m_outPtr += produced;
+    if (res == Z_STREAM_END) {
+        m_streamEnd = true;
+        if (m_size < 0) m_size = m_outPtr;
+        return produced;
+    }
+    // The end of any block but the last one is a point we can resume from.
+    if ((m_zstream.data_type & 128) && !(m_zstream.data_type & 64)) {
+        size_t last = m_index.empty() ? 0 : m_index.back().out;
+        if (m_outPtr >= last + m_span) {
+            Checkpoint checkpoint;
+            checkpoint.out = m_outPtr;
+            checkpoint.in = m_inPtr - m_zstream.avail_in;
+            checkpoint.bits = m_zstream.data_type & 7;
+            size_t windowSize = std::min(m_outPtr, c_windowSize);
+            checkpoint.window.resize(windowSize);
+            for (size_t i = 0; i < windowSize; i++) {
+                checkpoint.window[i] = m_window[(m_outPtr - windowSize + i) % c_windowSize];
+            }
+            m_index.push_back(std::move(checkpoint));
+        }
+    }
+    return produced;
+}
+
+ssize_t PCSX::ZIndexedReader::readAt(void *dest_, size_t size, size_t ptr) {
+    uint8_t *dest = reinterpret_cast<uint8_t *>(dest_);
+    if (failed()) return -1;
+    if ((m_size >= 0) && (ptr >= size_t(m_size))) return -1;
+
+    // Going backward, or too far forward: resume from the closest checkpoint.
+    if ((ptr < m_outPtr) || (ptr - m_outPtr > m_span)) {
+        auto it = std::upper_bound(m_index.begin(), m_index.end(), ptr,
+                                   [](size_t ptr, const Checkpoint &checkpoint) { return ptr < checkpoint.out; });
+        if (it == m_index.begin()) {
+            if (ptr < m_outPtr) reset();
+        } else {
+            --it;
+            if (((ptr < m_outPtr) || (it->out > m_outPtr)) && !restore(*it)) {
+                m_failed = true;
+                return -1;
+            }
+        }
+    }
+
+    ssize_t ret = 0;
+    while (size && !m_streamEnd) {
+        size_t before = m_outPtr;
+        ssize_t produced = inflateSome(ptr + size - m_outPtr);
+        if (produced < 0) {
+            m_failed = true;
+            return ret ? ret : -1;
+        }
+        if (m_outPtr <= ptr) continue;
+        size_t from = std::max(before, ptr);
+        size_t count = m_outPtr - from;
+        memcpy(dest, m_window + from % c_windowSize, count);
+        dest += count;
+        ret += count;
+        size -= count;
+        ptr += count;
+    }
+
+    return ret ? ret : -1;
+}
+
+ssize_t PCSX::ZIndexedReader::read(void *dest, size_t size) {
+    ssize_t ret = readAt(dest, size, m_ptrR);
+    if (ret > 0) m_ptrR += ret;
+    return ret;
+}
+
+ssize_t PCSX::ZIndexedReader::rSeek(ssize_t pos, int wheel) {
+    switch (wheel) {
+        case SEEK_SET:
+            m_ptrR = pos;
+            break;
+        case SEEK_END:
+            m_ptrR = size() + pos;
+            break;
+        case SEEK_CUR:
+            m_ptrR += pos;
+            break;
+    }
+    return m_ptrR;
+}
+
+size_t PCSX::ZIndexedReader::size() {
+    if (m_size < 0) buildIndex();
+    if (m_size >= 0) return m_size;
+    throw std::runtime_error("Unable to determine file size");
+}
+
+void PCSX::ZIndexedReader::buildIndex() {
+    if (failed()) return;
+    if (!m_index.empty() && (m_index.back().out > m_outPtr) && !restore(m_index.back())) {
+        m_failed = true;
+        return;
+    }
+    while (!m_streamEnd) {
+        if (inflateSome(c_windowSize) < 0) {
+            m_failed = true;
+            return;
+        }
+    }
+}
+
+static constexpr uint32_t c_indexMagic = 0x5844495a;  // 'ZIDX'
+static constexpr uint32_t c_indexVersion = 1;
+
+void PCSX::ZIndexedReader::saveIndex(IO<File> out) {
+    out->write<uint32_t>(c_indexMagic);
+    out->write<uint32_t>(c_indexVersion);
+    out->write<uint64_t>(m_file->size());
+    out->write<int64_t>(m_size);
+    out->write<uint64_t>(m_span);
+    out->write<uint32_t>(m_index.size());
+    for (auto &checkpoint : m_index) {
+        out->write<uint64_t>(checkpoint.out);
+        out->write<uint64_t>(checkpoint.in);
+        out->write<uint8_t>(checkpoint.bits);
+        out->write<uint32_t>(checkpoint.window.size());
+        out->write(checkpoint.window.data(), checkpoint.window.size());
+    }
+}
+
+bool PCSX::ZIndexedReader::loadIndex(IO<File> in) {
+    if (!in || in->failed()) return false;
+    if (in->read<uint32_t>() != c_indexMagic) return false;
+    if (in->read<uint32_t>() != c_indexVersion) return false;
+    if (in->read<uint64_t>() != m_file->size()) return false;
+    int64_t size = in->read<int64_t>();
+    size_t span = in->read<uint64_t>();
+    uint32_t count = in->read<uint32_t>();
+    std::vector<Checkpoint> index(count);
+    size_t last = 0;
+    for (auto &checkpoint : index) {
+        checkpoint.out = in->read<uint64_t>();
+        checkpoint.in = in->read<uint64_t>();
+        checkpoint.bits = in->read<uint8_t>();
+        uint32_t windowSize = in->read<uint32_t>();
+        if ((checkpoint.out <= last) || (checkpoint.bits > 7) || (windowSize > c_windowSize) ||
+            (windowSize > checkpoint.out)) {
+            return false;
+        }
+        last = checkpoint.out;
+        checkpoint.window.resize(windowSize);
+        if (windowSize && (in->read(checkpoint.window.data(), windowSize) != ssize_t(windowSize))) return false;
+    }
+    // Don't throw away a more complete index we may have built in the meantime.
+    if (index.size() >= m_index.size()) {
+        m_index = std::move(index);
+        m_span = std::max(span, c_windowSize);
+    }
+    if (m_size < 0) m_size = size;
+    return true;
+}
+
 ssize_t PCSX::ZWriter::write(const void *dest, size_t size) {
     m_zstream.avail_in = size;
     m_zstream.next_in = static_cast<Bytef *>(const_cast<void *>(dest));
@@ -28,6 +28,9 @@ SOFTWARE.
 
 #include <zlib.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "support/file.h"
 
 namespace PCSX {
@@ -78,6 +81,70 @@ class ZReader : public File {
     uint8_t m_inBuffer[1024];
 };
 
+// Random access variant of ZReader. While inflating, it records checkpoints
+// at deflate block boundaries, roughly every span bytes of output, with the
+// 32kB window needed to resume from there. Seeking then costs at most one
+// span of inflating instead of restarting from the beginning of the stream.
+// The index is built lazily while reading, or at once using buildIndex, and
+// can be saved in a sidecar file so that later readers get it for free.
+class ZIndexedReader : public File {
+  public:
+    enum Raw { RAW };
+    ZIndexedReader(IO<File> file) : ZIndexedReader(INTERNAL, file, -1, false) {}
+    ZIndexedReader(IO<File> file, Raw) : ZIndexedReader(INTERNAL, file, -1, true) {}
+    ZIndexedReader(IO<File> file, ssize_t size) : ZIndexedReader(INTERNAL, file, size, false) {}
+    ZIndexedReader(IO<File> file, ssize_t size, Raw) : ZIndexedReader(INTERNAL, file, size, true) {}
+    virtual ssize_t rSeek(ssize_t pos, int wheel) final override;
+    virtual ssize_t rTell() final override { return m_ptrR; }
+    virtual ssize_t read(void* dest, size_t size) final override;
+    virtual ssize_t readAt(void* dest, size_t size, size_t ptr) final override;
+    // Inflates the whole stream the first time if the size wasn't provided.
+    virtual size_t size() final override;
+    virtual bool eof() final override { return (m_size >= 0) && (m_ptrR >= m_size); }
+    virtual File* dup() final override;
+    virtual bool failed() final override { return m_failed || m_file->failed(); }
+
+    // Distance between checkpoints, trading memory for seek cost; defaults to 1MB.
+    // Only affects checkpoints recorded afterwards.
+    void setSpan(size_t span) { m_span = std::max(span, c_windowSize); }
+    // Inflates the rest of the stream, recording all the checkpoints.
+    void buildIndex();
+    // The index is only valid for the exact same compressed stream; loadIndex
+    // checks the compressed size and the format, and returns false on mismatch.
+    void saveIndex(IO<File> out);
+    bool loadIndex(IO<File> in);
+
+  private:
+    static constexpr size_t c_windowSize = 32768;
+    struct Checkpoint {
+        size_t out;
+        size_t in;
+        unsigned bits;
+        std::vector<uint8_t> window;
+    };
+    virtual void closeInternal() final override { inflateEnd(&m_zstream); }
+    enum Internal { INTERNAL };
+    ZIndexedReader(Internal, IO<File> file, ssize_t size, bool raw);
+    void reset();
+    bool restore(const Checkpoint& checkpoint);
+    ssize_t inflateSome(size_t max);
+
+    IO<File> m_file;
+    z_stream m_zstream;
+    std::vector<Checkpoint> m_index;
+    size_t m_span = 1024 * 1024;
+    size_t m_inPtr = 0;
+    size_t m_outPtr = 0;
+    ssize_t m_ptrR = 0;
+    ssize_t m_size = -1;
+    bool m_raw = false;
+    bool m_streamEnd = false;
+    bool m_failed = false;
+    uint8_t m_inBuffer[16384];
+    // Circular buffer of the last 32kB of output, indexed by output position.
+    uint8_t m_window[c_windowSize];
+};
+
 class ZWriter : public File {
   public:
     enum Raw { RAW };
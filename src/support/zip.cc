@@ -135,7 +135,7 @@ PCSX::File* PCSX::ZipArchive::openFile(std::string path) {
         if (file.name == path) {
             SubFile* sub = new SubFile(m_file, file.offset, file.compressedSize);
             if (file.compressed) {
-                ret = new ZReader(sub, file.size, ZReader::RAW);
+                ret = new ZIndexedReader(sub, file.size, ZIndexedReader::RAW);
             } else {
                 ret = sub;
             }
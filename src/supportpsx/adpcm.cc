@@ -27,8 +27,31 @@ SOFTWARE.
 #include "supportpsx/adpcm.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstring>
 #include <stdexcept>
+#include <thread>
+
+namespace {
+
+// Runs work(i) for each i in [0, count), with the threads picking the next
+// stream as they finish the previous one, as they can vary wildly in size.
+template <typename Work>
+void runBatch(size_t count, unsigned threads, Work&& work) {
+    if (threads == 0) threads = std::max(std::thread::hardware_concurrency(), 1u);
+    threads = std::min<size_t>(threads, count);
+    std::atomic<size_t> next = 0;
+    auto worker = [&]() {
+        for (size_t i = next++; i < count; i = next++) work(i);
+    };
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; t++) workers.emplace_back(worker);
+    worker();
+    for (auto& w : workers) w.join();
+}
+
+}  // namespace
 
 void PCSX::ADPCM::Encoder::reset(Mode mode) {
     m_lastBlockSamples[0][0] = 0.0;
@@ -79,26 +102,31 @@ void PCSX::ADPCM::Encoder::convertToDoubles(std::span<const int16_t> input, std:
 void PCSX::ADPCM::Encoder::findFilterAndShift(std::span<const double> input, std::span<double> output,
                                               uint8_t* filterPtr, uint8_t* shiftPtr, unsigned channel) {
     double minMax = 1.8e+307;
-    std::array<double, 5> filteredMax;
-    std::array<std::array<double, 28>, 5> allFiltered;
+    std::array<double, 5> filteredMax = {};
+    std::array<std::array<double, 5>, 28> allFiltered;
     std::array<double, 2> samples;
 
     *filterPtr = 0;
 
-    for (unsigned filter = 0; filter < 5; filter++) {
-        samples[0] = m_lastBlockSamples[channel][0];
-        samples[1] = m_lastBlockSamples[channel][1];
-        filteredMax[filter] = 0.0;
-        auto inputPtr = input;
-        for (unsigned i = 0; i < 28; i++) {
-            auto next = inputPtr[i];
+    // The history only depends on the input, not on the filter, so all of the
+    // filters are tried in the same pass, with the inner loop running across
+    // filters for the compiler to vectorize. Each filter still computes the
+    // exact same expression in the same order as when trying them one by one,
+    // so the results are bit-identical.
+    samples[0] = m_lastBlockSamples[channel][0];
+    samples[1] = m_lastBlockSamples[channel][1];
+    for (unsigned i = 0; i < 28; i++) {
+        auto next = input[i];
+        for (unsigned filter = 0; filter < 5; filter++) {
             auto f = samples[0] * c_filters[filter][0] + samples[1] * c_filters[filter][1] + next;
-            allFiltered[filter][i] = f;
-            if (f <= 0.0) f = -f;
-            if (filteredMax[filter] < f) filteredMax[filter] = f;
-            samples[1] = samples[0];
-            samples[0] = next;
+            allFiltered[i][filter] = f;
+            f = std::abs(f);
+            filteredMax[filter] = std::max(filteredMax[filter], f);
         }
+        samples[1] = samples[0];
+        samples[0] = next;
+    }
+    for (unsigned filter = 0; filter < 5; filter++) {
         auto factorized = m_factors[filter] * filteredMax[filter];
         if (factorized < minMax) {
             *filterPtr = filter;
@@ -109,7 +137,7 @@ void PCSX::ADPCM::Encoder::findFilterAndShift(std::span<const double> input, std
     m_lastBlockSamples[channel][0] = samples[0];
     m_lastBlockSamples[channel][1] = samples[1];
     unsigned filter = *filterPtr;
-    std::copy(allFiltered[filter].begin(), allFiltered[filter].end(), output.begin());
+    for (unsigned i = 0; i < 28; i++) output[i] = allFiltered[i][filter];
     int maxI = filteredMax[filter] * m_factors[filter + 5];
     maxI = std::clamp(maxI, -32768, 32767);
     int mask = 0x4000;
@@ -309,3 +337,48 @@ void PCSX::ADPCM::Encoder::processXABlock(const int16_t* input, uint8_t* output,
         }
     }
 }
+
+std::vector<std::vector<uint8_t>> PCSX::ADPCM::Encoder::processSPUBatch(std::span<const std::span<const int16_t>> inputs,
+                                                                       Mode mode, unsigned threads) {
+    std::vector<std::vector<uint8_t>> outputs(inputs.size());
+    runBatch(inputs.size(), threads, [&](size_t i) {
+        auto input = inputs[i];
+        auto& output = outputs[i];
+        size_t blocks = (input.size() + 27) / 28;
+        output.resize(blocks * 16);
+        Encoder encoder;
+        encoder.reset(mode);
+        for (size_t b = 0; b < blocks; b++) {
+            int16_t padded[28] = {};
+            auto block = input.subspan(b * 28, std::min<size_t>(28, input.size() - b * 28));
+            std::copy(block.begin(), block.end(), padded);
+            encoder.processSPUBlock(padded, output.data() + b * 16, BlockAttribute::OneShot);
+        }
+    });
+    return outputs;
+}
+
+std::vector<std::vector<uint8_t>> PCSX::ADPCM::Encoder::processXABatch(std::span<const std::span<const int16_t>> inputs,
+                                                                      XAMode xaMode, unsigned channels,
+                                                                      unsigned threads) {
+    if (channels > 2) {
+        throw std::invalid_argument("Channels must be 1 or 2");
+    }
+    const size_t blockSize = xaMode == XAMode::FourBits ? 224 : 112;
+    std::vector<std::vector<uint8_t>> outputs(inputs.size());
+    runBatch(inputs.size(), threads, [&](size_t i) {
+        auto input = inputs[i];
+        auto& output = outputs[i];
+        size_t blocks = (input.size() + blockSize - 1) / blockSize;
+        output.resize(blocks * 128);
+        Encoder encoder;
+        encoder.reset(Mode::XA);
+        for (size_t b = 0; b < blocks; b++) {
+            int16_t padded[224] = {};
+            auto block = input.subspan(b * blockSize, std::min(blockSize, input.size() - b * blockSize));
+            std::copy(block.begin(), block.end(), padded);
+            encoder.processXABlock(padded, output.data() + b * 128, xaMode, channels);
+        }
+    });
+    return outputs;
+}
@@ -28,6 +28,7 @@ SOFTWARE.
 
 #include <array>
 #include <span>
+#include <vector>
 
 namespace PCSX {
 
@@ -120,6 +121,21 @@ class Encoder {
     // user. The last 4 bytes of the MODE2 FORM2 sector should either be the yellow book checksum, or set to 0.
     void processXABlock(const int16_t* input, uint8_t* output, XAMode xaMode, unsigned channels);
 
+    // Batch versions of the above, which encode several independent streams at once, such as the instruments of
+    // a sample bank, or the channels of an XA file, spreading them across threads. Each stream gets its own
+    // encoder, reset with the given mode, so the output is bit-identical to encoding the streams one after the
+    // other. A threads value of 0 means using all of the available cores. These are additions to the original
+    // encvag API.
+    // The SPU version emits 16 bytes per block of 28 samples, as processSPUBlock with the OneShot attribute
+    // would, the last block being padded with silence. The block attributes are left for the caller to adjust,
+    // and finishSPU isn't called.
+    static std::vector<std::vector<uint8_t>> processSPUBatch(std::span<const std::span<const int16_t>> inputs,
+                                                             Mode mode = Mode::Normal, unsigned threads = 0);
+    // The XA version emits 128 bytes per XA block, the last block being padded with silence. See processXABlock
+    // for the amount of samples each block consumes.
+    static std::vector<std::vector<uint8_t>> processXABatch(std::span<const std::span<const int16_t>> inputs,
+                                                            XAMode xaMode, unsigned channels, unsigned threads = 0);
+
   private:
     // The original encvag code uses this to force some filters to be discarded, by setting the factors
     // to 1000.0 instead of 1.0. This is used when calling reset with a mode different than Normal.
@@ -55,6 +55,10 @@ void adpcmEncoderProcessSPUBlock(LuaAdpcmEncoder* encoder, const void* input, vo
 void adpcmEncoderFinishSPU(LuaAdpcmEncoder* encoder, uint8_t* output);
 void adpcmEncoderProcessXABlock(LuaAdpcmEncoder* encoder, const int16_t* input, uint8_t* output,
                                 enum XAMode, unsigned channels);
+void adpcmEncoderProcessSPUBatch(const void** inputs, const uint32_t* sizes, void** outputs, unsigned count,
+                                 enum AdpcmEncoderMode);
+void adpcmEncoderProcessXABatch(const void** inputs, const uint32_t* sizes, void** outputs, unsigned count,
+                                enum XAMode, unsigned channels);
 
 ]]
 
@@ -62,6 +66,27 @@ local C = ffi.load 'SUPPORTPSX_ADPCM'
 
 local uint8_t = ffi.typeof 'uint8_t'
 
+-- Marshals a table of LuaBuffers of 16-bit samples for the batch encoders, and
+-- allocates their outputs, given the amount of samples and bytes per block.
+local function prepareBatch(inputs, blockSamples, blockBytes)
+    if type(inputs) ~= 'table' then error('Expected a table of buffers as first argument') end
+    local count = #inputs
+    local inPtrs = ffi.new('const void*[?]', count)
+    local sizes = ffi.new('uint32_t[?]', count)
+    local outPtrs = ffi.new('void*[?]', count)
+    local outputs = {}
+    for i, input in ipairs(inputs) do
+        if not Support.isLuaBuffer(input) then error('Expected a table of buffers as first argument') end
+        local samples = math.floor(#input / 2)
+        local out = Support.NewLuaBuffer(math.ceil(samples / blockSamples) * blockBytes)
+        inPtrs[i - 1] = input.data
+        sizes[i - 1] = samples
+        outPtrs[i - 1] = out.data
+        outputs[i] = out
+    end
+    return count, inPtrs, sizes, outPtrs, outputs
+end
+
 PCSX.Adpcm = {
     NewEncoder = function()
         local wrapped = C.newAdpcmEncoder()
@@ -173,6 +198,23 @@ PCSX.Adpcm = {
         debug.setmetatable(encoder._proxy, { __gc = function() C.destroyAdpcmEncoder(encoder._wrapped) end })
         return encoder
     end,
+    EncodeSPUBatch = function(inputs, mode)
+        if mode == nil then mode = 'Normal' end
+        local count, inPtrs, sizes, outPtrs, outputs = prepareBatch(inputs, 28, 16)
+        C.adpcmEncoderProcessSPUBatch(inPtrs, sizes, outPtrs, count, mode)
+        return outputs
+    end,
+    EncodeXABatch = function(inputs, mode, channels)
+        if type(mode) == 'number' and channels == nil then
+            channels = mode
+            mode = nil
+        end
+        if mode == nil then mode = 'XAFourBits' end
+        if channels == nil then channels = 1 end
+        local count, inPtrs, sizes, outPtrs, outputs = prepareBatch(inputs, mode == 'XAFourBits' and 224 or 112, 128)
+        C.adpcmEncoderProcessXABatch(inPtrs, sizes, outPtrs, count, mode, channels)
+        return outputs
+    end,
 }
 
 -- )EOF"
@@ -27,6 +27,10 @@ SOFTWARE.
 #include "supportpsx/adpcmlua.h"
 
 #include <stdint.h>
+#include <string.h>
+
+#include <span>
+#include <vector>
 
 #include "supportpsx/adpcm.h"
 
@@ -48,6 +52,20 @@ void adpcmEncoderProcessXABlock(PCSX::ADPCM::Encoder* encoder, const int16_t* in
                                 PCSX::ADPCM::Encoder::XAMode mode, unsigned channels) {
     encoder->processXABlock(input, output, mode, channels);
 }
+void adpcmEncoderProcessSPUBatch(const int16_t** inputs, const uint32_t* sizes, uint8_t** outputs, unsigned count,
+                                 PCSX::ADPCM::Encoder::Mode mode) {
+    std::vector<std::span<const int16_t>> spans;
+    for (unsigned i = 0; i < count; i++) spans.emplace_back(inputs[i], sizes[i]);
+    auto encoded = PCSX::ADPCM::Encoder::processSPUBatch(spans, mode);
+    for (unsigned i = 0; i < count; i++) memcpy(outputs[i], encoded[i].data(), encoded[i].size());
+}
+void adpcmEncoderProcessXABatch(const int16_t** inputs, const uint32_t* sizes, uint8_t** outputs, unsigned count,
+                                PCSX::ADPCM::Encoder::XAMode mode, unsigned channels) {
+    std::vector<std::span<const int16_t>> spans;
+    for (unsigned i = 0; i < count; i++) spans.emplace_back(inputs[i], sizes[i]);
+    auto encoded = PCSX::ADPCM::Encoder::processXABatch(spans, mode, channels);
+    for (unsigned i = 0; i < count; i++) memcpy(outputs[i], encoded[i].data(), encoded[i].size());
+}
 
 template <typename T, size_t S>
 void registerSymbol(PCSX::Lua L, const char (&name)[S], const T ptr) {
@@ -69,6 +87,8 @@ void registerAllSymbols(PCSX::Lua L) {
     REGISTER(L, adpcmEncoderProcessSPUBlock);
     REGISTER(L, adpcmEncoderFinishSPU);
     REGISTER(L, adpcmEncoderProcessXABlock);
+    REGISTER(L, adpcmEncoderProcessSPUBatch);
+    REGISTER(L, adpcmEncoderProcessXABatch);
     L.settable();
     L.pop();
 }
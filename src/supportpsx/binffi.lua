@@ -43,6 +43,7 @@ struct PS1PackerOptions {
     bool raw;
     bool rom;
     bool cpe;
+    bool parallel;
 };
 
 bool binaryLoaderLoad(LuaFile* src, LuaFile* dest, struct BinaryLoaderInfo* info);
@@ -89,6 +90,7 @@ PCSX.Binary.pack = function(src, dest, addr, pc, gp, sp, options)
     opts.raw = options.raw and true or false
     opts.rom = options.rom and true or false
     opts.cpe = options.cpe and true or false
+    opts.parallel = options.parallel and true or false
     C.ps1PackerPack(src._wrapper, dest._wrapper, addr, pc, gp, sp, opts)
 end
 
@@ -26,7 +26,11 @@ SOFTWARE.
 
 #include "supportpsx/binloader.h"
 
+#include <algorithm>
+#include <filesystem>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 
 #include "elfio/elfio.hpp"
@@ -50,7 +54,7 @@ void eraseSymbolsInSpan(uint32_t low, uint32_t high, std::map<uint32_t, std::str
     }
 }
 
-bool loadCPE(IO<File> file, IO<File> dest, BinaryLoader::Info& info, std::map<uint32_t, std::string>& symbols) {
+bool indexCPE(IO<File> file, BinaryLoader::Index& index) {
     uint32_t magic = file->read<uint32_t>();
     if (magic != 0x1455043) return false;
     file->skip<uint16_t>();
@@ -66,8 +70,8 @@ bool loadCPE(IO<File> file, IO<File> dest, BinaryLoader::Info& info, std::map<ui
             case 1: {  // load
                 uint32_t addr = file->read<uint32_t>();
                 uint32_t size = file->read<uint32_t>();
-                dest->writeAt(file->read(size), addr);
-                eraseSymbolsInSpan(addr, addr + size, symbols);
+                index.segments.push_back({{}, size_t(file->rTell()), size, addr});
+                file->rSeek(size, SEEK_CUR);
             } break;
             case 2: {
                 file->read<uint32_t>();
@@ -105,7 +109,7 @@ bool loadCPE(IO<File> file, IO<File> dest, BinaryLoader::Info& info, std::map<ui
         if (setRegister) {
             switch (reg) {
                 case 0x90: {
-                    info.pc = value;
+                    index.info.pc = value;
                 } break;
             }
         }
@@ -114,14 +118,16 @@ bool loadCPE(IO<File> file, IO<File> dest, BinaryLoader::Info& info, std::map<ui
     return true;
 }
 
-bool loadPSEXE(IO<File> file, IO<File> dest, BinaryLoader::Info& info, std::map<uint32_t, std::string>& symbols) {
+// The source is what the segment will be read from, which is only different from
+// the file being parsed when it's the decompressed contents of a PSF.
+bool indexPSEXE(IO<File> file, IO<File> source, BinaryLoader::Index& index) {
     uint64_t magic = file->read<uint64_t>();
     if (magic != 0x45584520582d5350) return false;
 
     file->read<uint32_t>();
     file->read<uint32_t>();
 
-    info.pc = file->read<uint32_t>();
+    index.info.pc = file->read<uint32_t>();
     file->read<uint32_t>();
     uint32_t addr = file->read<uint32_t>();
     uint32_t size = file->read<uint32_t>();
@@ -130,26 +136,23 @@ bool loadPSEXE(IO<File> file, IO<File> dest, BinaryLoader::Info& info, std::map<
     file->read<uint32_t>();
     file->read<uint32_t>();
     const auto spInFile = file->read<uint32_t>();
-    if (spInFile != 0) info.sp = spInFile;
+    if (spInFile != 0) index.info.sp = spInFile;
     file->rSeek(0x71, SEEK_SET);
     uint8_t regionByte = file->byte();
-    file->rSeek(2048, SEEK_SET);
-    dest->writeAt(file->read(size), addr);
-    eraseSymbolsInSpan(addr, addr + size, symbols);
+    index.segments.push_back({source, 2048, size, addr});
     switch (regionByte) {
         case 'A':
         case 'J':
-            info.region = BinaryLoader::Region::NTSC;
+            index.info.region = BinaryLoader::Region::NTSC;
             break;
         case 'E':
-            info.region = BinaryLoader::Region::PAL;
+            index.info.region = BinaryLoader::Region::PAL;
             break;
     }
     return true;
 }
 
-bool loadPSF(IO<File> file, IO<File> dest, BinaryLoader::Info& info, std::map<uint32_t, std::string>& symbols,
-             bool seenRefresh = false, unsigned depth = 0) {
+bool indexPSF(IO<File> file, BinaryLoader::Index& index, bool seenRefresh = false, unsigned depth = 0) {
     if (depth >= 10) return false;
     uint32_t magic = file->read<uint32_t>();
     if (magic != 0x1465350) return false;
@@ -183,9 +186,9 @@ bool loadPSF(IO<File> file, IO<File> dest, BinaryLoader::Info& info, std::map<ui
     if (!seenRefresh && pairs.find("refresh") != pairs.end()) {
         const auto& refresh = pairs["refresh"];
         if (refresh == "50") {
-            info.region = BinaryLoader::Region::PAL;
+            index.info.region = BinaryLoader::Region::PAL;
         } else if (refresh == "60") {
-            info.region = BinaryLoader::Region::NTSC;
+            index.info.region = BinaryLoader::Region::NTSC;
         }
         seenRefresh = true;
     }
@@ -193,11 +196,18 @@ bool loadPSF(IO<File> file, IO<File> dest, BinaryLoader::Info& info, std::map<ui
     if (pairs.find("_lib") != pairs.end()) {
         std::filesystem::path subFilePath(file->filename());
         IO<File> subFile(new PosixFile(subFilePath.parent_path() / pairs["_lib"]));
-        if (!subFile->failed()) loadPSF(subFile, dest, info, symbols, seenRefresh, depth++);
+        if (!subFile->failed()) indexPSF(subFile, index, seenRefresh, depth++);
     }
 
-    IO<File> psexe(new ZReader(zpsexe));
-    loadPSEXE(psexe, dest, info, symbols);
+    // The embedded PS-EXE is compressed, so it gets inflated in memory, and
+    // that buffer becomes the source of its segment.
+    IO<File> zreader(new ZReader(zpsexe));
+    IO<File> psexe(new BufferFile(FileOps::READWRITE));
+    uint8_t buffer[16384];
+    ssize_t r;
+    while ((r = zreader->read(buffer, sizeof(buffer))) > 0) psexe->write(buffer, r);
+    psexe->rSeek(0, SEEK_SET);
+    indexPSEXE(psexe, psexe, index);
 
     unsigned libNum = 2;
 
@@ -206,13 +216,15 @@ bool loadPSF(IO<File> file, IO<File> dest, BinaryLoader::Info& info, std::map<ui
         if (pairs.find(libName) == pairs.end()) break;
         std::filesystem::path subFilePath(file->filename());
         IO<File> subFile(new PosixFile(subFilePath.parent_path() / pairs[libName]));
-        if (!subFile->failed()) loadPSF(subFile, dest, info, symbols, seenRefresh, depth++);
+        if (!subFile->failed()) indexPSF(subFile, index, seenRefresh, depth++);
     }
 
     return true;
 }
 
-bool loadELF(IO<File> file, IO<File> dest, BinaryLoader::Info& info, std::map<uint32_t, std::string>& symbols) {
+// Fallback for ELF files which aren't 32 bits little endian, which goes
+// through the full ELFIO parser, and ends up reading the whole file.
+bool indexELFIO(IO<File> file, BinaryLoader::Index& index) {
     using namespace ELFIO;
     elfio reader;
     FileIStream stream(file);
@@ -220,7 +232,7 @@ bool loadELF(IO<File> file, IO<File> dest, BinaryLoader::Info& info, std::map<ui
     if (!reader.load(stream)) return false;
     if (reader.get_class() != ELFCLASS32) return false;
 
-    info.pc = reader.get_entry();
+    index.info.pc = reader.get_entry();
 
     Elf_Half sec_num = reader.sections.size();
     for (unsigned i = 0; i < sec_num; i++) {
@@ -234,10 +246,10 @@ bool loadELF(IO<File> file, IO<File> dest, BinaryLoader::Info& info, std::map<ui
         if (type != SHT_PROGBITS) continue;
 
         auto size = psec->get_size();
-        auto data = psec->get_data();
-        auto addr = psec->get_address();
-        dest->writeAt(data, size, addr);
-        eraseSymbolsInSpan(addr, addr + size, symbols);
+        Slice slice;
+        slice.copy(psec->get_data(), size);
+        IO<File> data(new BufferFile(std::move(slice)));
+        index.segments.push_back({data, 0, uint32_t(size), uint32_t(psec->get_address())});
     }
 
     for (unsigned i = 0; i < sec_num; i++) {
@@ -256,30 +268,192 @@ bool loadELF(IO<File> file, IO<File> dest, BinaryLoader::Info& info, std::map<ui
             Elf_Half section_index;
             unsigned char other;
             symbolstab.get_symbol(s, name, value, size, bind, type, section_index, other);
-            symbols[value] = name;
+            index.symbols[value] = name;
         }
     }
 
     return true;
 }
 
+// Our own parser for the only kind of ELF files the PS1 has: 32 bits, little
+// endian. Contrary to ELFIO, which loads every single section in memory, this
+// only reads the section headers and the symbol tables, leaving the segments
+// to be streamed in when the index gets applied.
+bool indexELF(IO<File> file, BinaryLoader::Index& index) {
+    if (file->readAt<uint32_t>(0) != 0x464c457f) return false;
+    // ELFCLASS32 and ELFDATA2LSB
+    if ((file->readAt<uint8_t>(4) != 1) || (file->readAt<uint8_t>(5) != 1)) return indexELFIO(file, index);
+
+    struct SectionHeader {
+        uint32_t name;
+        uint32_t type;
+        uint32_t addr;
+        uint32_t offset;
+        uint32_t size;
+        uint32_t link;
+    };
+    uint32_t entry = file->readAt<uint32_t>(24);
+    uint32_t shoff = file->readAt<uint32_t>(32);
+    uint16_t shentsize = file->readAt<uint16_t>(46);
+    uint32_t shnum = file->readAt<uint16_t>(48);
+    uint32_t shstrndx = file->readAt<uint16_t>(50);
+    // Anything we can't make sense of, starting with files without section
+    // headers at all, is left to ELFIO, which was the only parser before.
+    if ((shoff == 0) || (shentsize < 40)) return indexELFIO(file, index);
+    auto readSectionHeader = [&](uint32_t i) {
+        size_t base = shoff + size_t(i) * shentsize;
+        SectionHeader header;
+        header.name = file->readAt<uint32_t>(base + 0);
+        header.type = file->readAt<uint32_t>(base + 4);
+        header.addr = file->readAt<uint32_t>(base + 12);
+        header.offset = file->readAt<uint32_t>(base + 16);
+        header.size = file->readAt<uint32_t>(base + 20);
+        header.link = file->readAt<uint32_t>(base + 24);
+        return header;
+    };
+    // Extended section numbering, for files with more than 0xff00 sections.
+    if (shnum == 0) shnum = readSectionHeader(0).size;
+    if (shstrndx == 0xffff) shstrndx = readSectionHeader(0).link;
+    if ((shnum == 0) || (size_t(shoff) + size_t(shnum) * shentsize > file->size())) return indexELFIO(file, index);
+
+    std::vector<SectionHeader> sections;
+    sections.reserve(shnum);
+    for (uint32_t i = 0; i < shnum; i++) sections.push_back(readSectionHeader(i));
+    auto readStrings = [&](uint32_t i) {
+        if (i >= shnum) return std::string();
+        return file->readAt(sections[i].size, sections[i].offset).asString();
+    };
+    auto getString = [](const std::string& strings, uint32_t offset) {
+        if (offset >= strings.size()) return std::string();
+        return std::string(strings.c_str() + offset);
+    };
+    std::string sectionNames = readStrings(shstrndx);
+
+    constexpr uint32_t c_progBits = 1;
+    constexpr uint32_t c_symTab = 2;
+
+    index.info.pc = entry;
+
+    for (auto& section : sections) {
+        if (section.type != c_progBits) continue;
+        auto name = getString(sectionNames, section.name);
+
+        if (StringsHelpers::endsWith(name, "_Header")) continue;
+        if (StringsHelpers::startsWith(name, ".comment")) continue;
+
+        index.segments.push_back({{}, section.offset, section.size, section.addr});
+    }
+
+    for (auto& section : sections) {
+        if (section.type != c_symTab) continue;
+        std::string names = readStrings(section.link);
+        auto symbols = file->readAt(section.size, section.offset);
+        auto data = reinterpret_cast<const uint8_t*>(symbols.data());
+        for (size_t s = 0; s + 16 <= symbols.size(); s += 16) {
+            uint32_t name = data[s + 0] | (data[s + 1] << 8) | (data[s + 2] << 16) | (data[s + 3] << 24);
+            uint32_t value = data[s + 4] | (data[s + 5] << 8) | (data[s + 6] << 16) | (data[s + 7] << 24);
+            index.symbols[value] = getString(names, name);
+        }
+    }
+
+    return true;
+}
+
+struct CachedIndex {
+    uintmax_t size;
+    std::filesystem::file_time_type mtime;
+    std::shared_ptr<const BinaryLoader::Index> index;
+};
+
+std::mutex s_cacheMutex;
+std::map<std::filesystem::path, CachedIndex> s_cache;
+constexpr size_t c_maxCachedIndexes = 16;
+
+std::shared_ptr<const BinaryLoader::Index> indexELFCached(IO<File> file) {
+    std::error_code ec;
+    auto path = file->filename();
+    uintmax_t size = 0;
+    std::filesystem::file_time_type mtime;
+    bool cacheable = !path.empty();
+    if (cacheable) {
+        path = std::filesystem::absolute(path, ec);
+        if (!ec) size = std::filesystem::file_size(path, ec);
+        if (!ec) mtime = std::filesystem::last_write_time(path, ec);
+        cacheable = !ec;
+    }
+    if (cacheable) {
+        std::unique_lock<std::mutex> lock(s_cacheMutex);
+        auto it = s_cache.find(path);
+        if ((it != s_cache.end()) && (it->second.size == size) && (it->second.mtime == mtime)) {
+            return it->second.index;
+        }
+    }
+    BinaryLoader::Index parsed;
+    if (!indexELF(file, parsed)) return nullptr;
+    // The ELFIO fallback keeps copies of the segments, so it's not worth caching.
+    for (auto& segment : parsed.segments) {
+        if (segment.source) cacheable = false;
+    }
+    auto index = std::make_shared<const BinaryLoader::Index>(std::move(parsed));
+    if (cacheable) {
+        std::unique_lock<std::mutex> lock(s_cacheMutex);
+        if (s_cache.size() >= c_maxCachedIndexes) s_cache.clear();
+        s_cache[path] = {size, mtime, index};
+    }
+    return index;
+}
+
 }  // namespace
 
 }  // namespace PCSX
 
+std::shared_ptr<const PCSX::BinaryLoader::Index> PCSX::BinaryLoader::index(IO<File> in) {
+    if (in->failed()) return nullptr;
+    Index index;
+    if (indexCPE(in, index)) return std::make_shared<const Index>(std::move(index));
+    index = {};
+    in->rSeek(0, SEEK_SET);
+    if (indexPSEXE(in, {}, index)) return std::make_shared<const Index>(std::move(index));
+    index = {};
+    in->rSeek(0, SEEK_SET);
+    if (indexPSF(in, index)) return std::make_shared<const Index>(std::move(index));
+    in->rSeek(0, SEEK_SET);
+    return indexELFCached(in);
+}
+
+void PCSX::BinaryLoader::apply(const Index& index, IO<File> in, IO<File> dest, Info& info,
+                               std::map<uint32_t, std::string>& symbols) {
+    // Segments are copied in chunks, so a large one doesn't need to be held
+    // in memory entirely on its way to the destination.
+    constexpr uint32_t c_chunkSize = 1024 * 1024;
+    for (auto& segment : index.segments) {
+        IO<File> source = segment.source ? segment.source : in;
+        for (uint32_t done = 0; done < segment.size;) {
+            uint32_t chunk = std::min(segment.size - done, c_chunkSize);
+            auto slice = source->readAt(chunk, segment.offset + done);
+            uint32_t got = slice.size();
+            if (got != 0) dest->writeAt(std::move(slice), segment.address + done);
+            if (got != chunk) break;
+            done += got;
+        }
+        eraseSymbolsInSpan(segment.address, segment.address + segment.size, symbols);
+    }
+    for (auto& [address, name] : index.symbols) symbols[address] = name;
+    if (index.info.region.has_value()) info.region = index.info.region;
+    if (index.info.pc.has_value()) info.pc = index.info.pc;
+    if (index.info.sp.has_value()) info.sp = index.info.sp;
+    if (index.info.gp.has_value()) info.gp = index.info.gp;
+}
+
 bool PCSX::BinaryLoader::load(IO<File> in, IO<File> dest, Info& info, std::map<uint32_t, std::string>& symbols) {
     {
         IO<File> ny(new PosixFile(in->filename().parent_path() / "libps.exe"));
-        if (!ny->failed()) loadPSEXE(ny, dest, info, symbols);
+        Index index;
+        if (!ny->failed() && indexPSEXE(ny, {}, index)) apply(index, ny, dest, info, symbols);
     }
 
-    if (in->failed()) return false;
-    if (loadCPE(in, dest, info, symbols)) return true;
-    in->rSeek(0, SEEK_SET);
-    if (loadPSEXE(in, dest, info, symbols)) return true;
-    in->rSeek(0, SEEK_SET);
-    if (loadPSF(in, dest, info, symbols)) return true;
-    in->rSeek(0, SEEK_SET);
-    if (loadELF(in, dest, info, symbols)) return true;
-    return false;
+    auto index = BinaryLoader::index(in);
+    if (!index) return false;
+    apply(*index, in, dest, info, symbols);
+    return true;
 }
@@ -30,8 +30,10 @@ SOFTWARE.
 
 #include <filesystem>
 #include <map>
+#include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "support/file.h"
 
@@ -47,6 +49,30 @@ struct Info {
     std::optional<uint32_t> gp;
 };
 
+// The parsed form of a binary: where each of its segments lives, and where it
+// goes in memory, along with its entry point and symbols. Building an index only
+// reads the headers and symbol tables, and applying it streams the segments
+// straight from the file, so the bulk of a debug ELF is never read at all.
+struct Segment {
+    // Where the data comes from. Empty when it's the indexed file itself, so
+    // that an index can be applied again later with a freshly opened file.
+    IO<File> source;
+    size_t offset;
+    uint32_t size;
+    uint32_t address;
+};
+struct Index {
+    Info info;
+    std::vector<Segment> segments;
+    std::map<uint32_t, std::string> symbols;
+};
+
+// Returns nullptr when the binary isn't recognized. Indexes are cached for ELF
+// files, keyed on their filename, size and modification time, as these are the
+// ones with large symbol tables, and a cache hit hands out the cached index.
+std::shared_ptr<const Index> index(IO<File> in);
+void apply(const Index& index, IO<File> in, IO<File> dest, Info& info, std::map<uint32_t, std::string>& symbols);
+
 bool load(IO<File> in, IO<File> dest, Info& info, std::map<uint32_t, std::string>& symbols);
 
 }  // namespace BinaryLoader
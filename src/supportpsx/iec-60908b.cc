@@ -27,8 +27,13 @@ SOFTWARE.
 #include "supportpsx/iec-60908b.h"
 
 #include <stdint.h>
+#include <string.h>
 
-#include "iec-60908b/edcecc.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "support/table-generator.h"
 
 // Lookup table for crc-16 subq calculation. This is a normal CRC-CCITT.
 static constexpr uint16_t crctab[256] = {
@@ -76,4 +81,166 @@ uint16_t PCSX::IEC60908b::subqCRC(const uint8_t* d, int len) {
     return ~crc;
 }
 
-void PCSX::IEC60908b::computeEDCECC(uint8_t* sector) { compute_edcecc(sector); }
+namespace {
+
+// The yellow book EDC is a reflected CRC32 with the polynomial
+// x^32 + x^31 + x^16 + x^15 + x^4 + x^3 + x + 1. The table holds 8 slices of
+// 256 entries each, so we can consume 8 bytes per round, with each slice
+// advancing the crc of its byte by one more position.
+struct EDCGenerator {
+    static consteval uint32_t base(uint32_t i) {
+        for (unsigned j = 0; j < 8; j++) i = (i >> 1) ^ (i & 1 ? 0xd8018001 : 0);
+        return i;
+    }
+    static consteval uint32_t calculateValue(std::size_t i) {
+        uint32_t crc = base(i & 0xff);
+        for (unsigned slice = 0; slice < i / 256; slice++) crc = (crc >> 8) ^ base(crc & 0xff);
+        return crc;
+    }
+};
+
+constexpr auto c_edcTable = PCSX::generateTable<256 * 8, EDCGenerator>();
+
+// Multiplication by 2 in GF(2^8), using the 0x11d polynomial.
+constexpr uint8_t gfMul2(uint8_t a) { return (a << 1) ^ (a & 0x80 ? 0x1d : 0); }
+
+struct GFDiv3Generator {
+    static consteval uint8_t calculateValue(std::size_t i) {
+        for (unsigned a = 0; a < 256; a++) {
+            if ((gfMul2(a) ^ a) == i) return a;
+        }
+        return 0;
+    }
+};
+
+constexpr auto c_gfDiv3 = PCSX::generateTable<256, GFDiv3Generator>();
+
+// The same multiplication by 2, on 8 bytes packed into a word. This is
+// what makes it possible to compute several ECC lines at once.
+constexpr uint64_t gfMul2x8(uint64_t a) {
+    return ((a & 0x7f7f7f7f7f7f7f7full) << 1) ^ (((a >> 7) & 0x0101010101010101ull) * 0x1d);
+}
+
+constexpr uint16_t gfMul2x2(uint16_t a) { return ((a & 0x7f7f) << 1) ^ (((a >> 7) & 0x0101) * 0x1d); }
+
+uint64_t load64(const uint8_t* p) {
+    uint64_t r = 0;
+    for (unsigned i = 0; i < 8; i++) r |= uint64_t(p[i]) << (i * 8);
+    return r;
+}
+
+// Each ECC line is a (N + 2, N) reed solomon code, which boils down to two
+// series: the plain sum of all the bytes in the high half, and the
+// S(n) = 2·(S(n - 1) + b) series in the low half. See the reference
+// implementation in third_party/iec-60908b for the details.
+void finishECC(uint8_t low, uint8_t high, uint8_t* dest0, uint8_t* dest1) {
+    low = c_gfDiv3[gfMul2(low) ^ high];
+    *dest0 = low;
+    *dest1 = high ^ low;
+}
+
+// The P channel is 86 lines of 24 bytes, with a stride of 86 bytes, which
+// means a row of the sector feeds 86 consecutive lines. We process 8 lines
+// per word, with the last word overlapping the previous one to cover the
+// 86 lines in 11 words.
+void computeP(uint8_t* data) {
+    static constexpr unsigned c_offsets[11] = {0, 8, 16, 24, 32, 40, 48, 56, 64, 72, 78};
+    uint64_t low[11] = {};
+    uint64_t high[11] = {};
+    for (unsigned j = 0; j < 24; j++) {
+        const uint8_t* row = data + 86 * j;
+        for (unsigned w = 0; w < 11; w++) {
+            uint64_t coeffs = load64(row + c_offsets[w]);
+            low[w] = gfMul2x8(low[w] ^ coeffs);
+            high[w] ^= coeffs;
+        }
+    }
+    for (unsigned w = 0; w < 11; w++) {
+        for (unsigned b = 0; b < 8; b++) {
+            unsigned i = c_offsets[w] + b;
+            finishECC(low[w] >> (b * 8), high[w] >> (b * 8), data + 24 * 86 + i, data + 25 * 86 + i);
+        }
+    }
+}
+
+// The Q channel is 52 lines of 43 bytes each, walking diagonally through
+// the sector. Lines go in pairs which read adjacent bytes, so we process
+// both of them at once, and track the diagonal incrementally instead of
+// doing a modulo for each byte.
+void computeQ(uint8_t* data) {
+    for (unsigned k = 0; k < 26; k++) {
+        uint16_t low = 0;
+        uint16_t high = 0;
+        unsigned word = 43 * k;
+        for (unsigned j = 0; j < 43; j++) {
+            uint16_t coeffs = data[word * 2] | (data[word * 2 + 1] << 8);
+            low = gfMul2x2(low ^ coeffs);
+            high ^= coeffs;
+            word += 44;
+            if (word >= 1118) word -= 1118;
+        }
+        finishECC(low, high, data + 43 * 26 * 2 + k * 2, data + 44 * 26 * 2 + k * 2);
+        finishECC(low >> 8, high >> 8, data + 43 * 26 * 2 + k * 2 + 1, data + 44 * 26 * 2 + k * 2 + 1);
+    }
+}
+
+}  // namespace
+
+uint32_t PCSX::IEC60908b::computeEDC(const uint8_t* data, size_t size, uint32_t edc) {
+    while (size >= 8) {
+        uint32_t a = edc ^ (data[0] | (data[1] << 8) | (data[2] << 16) | (uint32_t(data[3]) << 24));
+        uint32_t b = data[4] | (data[5] << 8) | (data[6] << 16) | (uint32_t(data[7]) << 24);
+        edc = c_edcTable[7 * 256 + (a & 0xff)] ^ c_edcTable[6 * 256 + ((a >> 8) & 0xff)] ^
+              c_edcTable[5 * 256 + ((a >> 16) & 0xff)] ^ c_edcTable[4 * 256 + (a >> 24)] ^
+              c_edcTable[3 * 256 + (b & 0xff)] ^ c_edcTable[2 * 256 + ((b >> 8) & 0xff)] ^
+              c_edcTable[1 * 256 + ((b >> 16) & 0xff)] ^ c_edcTable[b >> 24];
+        data += 8;
+        size -= 8;
+    }
+    while (size--) edc = c_edcTable[(edc ^ *data++) & 0xff] ^ (edc >> 8);
+    return edc;
+}
+
+void PCSX::IEC60908b::computeEDCECC(uint8_t* sector) {
+    if (sector[15] != 2) return;
+    uint8_t* subheader = sector + 16;
+    bool form2 = subheader[2] & 0x20;
+    // The EDC covers the subheader too.
+    size_t len = (form2 ? 2324 : 2048) + 8;
+    uint32_t edc = computeEDC(subheader, len);
+    subheader[len + 0] = edc;
+    subheader[len + 1] = edc >> 8;
+    subheader[len + 2] = edc >> 16;
+    subheader[len + 3] = edc >> 24;
+    if (form2) return;
+
+    // Mode 2 form 1 ECC is computed with the header zeroed out.
+    uint8_t* header = sector + 12;
+    uint8_t location[4];
+    memcpy(location, header, 4);
+    memset(header, 0, 4);
+    computeP(header);
+    computeQ(header);
+    memcpy(header, location, 4);
+}
+
+void PCSX::IEC60908b::computeEDCECC(uint8_t* sectors, size_t count) {
+    // Below that, spinning up threads costs more than it saves.
+    static constexpr size_t c_minSectorsPerThread = 256;
+    size_t threads = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u),
+                                      std::max<size_t>(count / c_minSectorsPerThread, 1));
+    auto work = [sectors](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) computeEDCECC(sectors + i * FRAMESIZE_RAW);
+    };
+    if (threads == 1) {
+        work(0, count);
+        return;
+    }
+    std::vector<std::thread> workers;
+    size_t chunk = (count + threads - 1) / threads;
+    for (size_t first = chunk; first < count; first += chunk) {
+        workers.emplace_back(work, first, std::min(first + chunk, count));
+    }
+    work(0, chunk);
+    for (auto& worker : workers) worker.join();
+}
@@ -145,6 +145,14 @@ struct MSF {
 // Compute the EDC and ECC for a mode2 sector.
 void computeEDCECC(uint8_t *sector);
 
+// Compute the EDC and ECC for an array of contiguous raw mode2 sectors.
+// Large batches are split across worker threads.
+void computeEDCECC(uint8_t *sectors, size_t count);
+
+// Compute the yellow book's EDC over a buffer, which is a plain CRC32 with
+// its own polynomial; it can be chained by passing the previous result.
+uint32_t computeEDC(const uint8_t *data, size_t size, uint32_t edc = 0);
+
 // Compute the CRC-16 for the SubQ channel.
 uint16_t subqCRC(const uint8_t *d, int len = 10);
 
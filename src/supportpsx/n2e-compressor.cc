@@ -0,0 +1,313 @@
+/*
+
+MIT License
+
+Copyright (c) 2024 PCSX-Redux authors
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "supportpsx/n2e-compressor.h"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <thread>
+
+namespace {
+
+constexpr unsigned c_hashBits = 16;
+constexpr uint32_t c_none = std::numeric_limits<uint32_t>::max();
+constexpr uint32_t c_maxChain = 512;
+constexpr uint32_t c_niceLength = 256;
+// Matches with offsets past this need to be at least 3 bytes long.
+constexpr uint32_t c_nearOffset = 0x500;
+constexpr size_t c_minSlice = 64 * 1024;
+// Offset prefix which, followed by 0xff, forms the end of stream marker.
+constexpr uint32_t c_endMarker = 0x1000002;
+
+struct Match {
+    uint32_t len;
+    uint32_t off;
+};
+
+// Bit costs of the various nrv2e codes. See n2e-d.S for the decoding side.
+unsigned prefixBits(uint32_t x) {
+    unsigned bits = 2;
+    while (x >= 4) {
+        x = ((x >> 1) + 2) >> 1;
+        bits += 3;
+    }
+    return bits;
+}
+
+unsigned gammaBits(uint32_t x) { return 2 * (std::bit_width(x) - 1); }
+
+unsigned lengthBits(uint32_t code) {
+    if (code <= 2) return 1;
+    if (code <= 4) return 2;
+    return 1 + gammaBits(code - 3);
+}
+
+unsigned offsetBits(uint32_t off) { return prefixBits(((off - 1) >> 7) + 3) + 8; }
+
+// The length code of a match, which is 0 if the match is too short for its offset.
+uint32_t lengthCode(uint32_t len, uint32_t off) {
+    uint32_t bias = off > c_nearOffset ? 2 : 1;
+    return len > bias ? len - bias : 0;
+}
+
+uint32_t commonLength(const uint8_t* a, const uint8_t* b, uint32_t maxLen) {
+    uint32_t len = 0;
+    while ((len < maxLen) && (a[len] == b[len])) len++;
+    return len;
+}
+
+class BitWriter {
+  public:
+    void putBit(unsigned bit) {
+        // The decoder fetches a new byte of bits only when it needs one, so its
+        // slot gets reserved in the stream at the same point.
+        if (m_bitCount == 0) {
+            m_bitPos = m_out.size();
+            m_out.push_back(0);
+        }
+        m_out[m_bitPos] |= bit << (7 - m_bitCount);
+        m_bitCount = (m_bitCount + 1) & 7;
+    }
+    void putByte(uint8_t byte) { m_out.push_back(byte); }
+    void putPrefix(uint32_t x, bool stop = true) {
+        if (x >= 4) {
+            uint32_t m = (x >> 1) + 2;
+            putPrefix(m >> 1, false);
+            putBit(m & 1);
+        }
+        putBit(x & 1);
+        putBit(stop);
+    }
+    void putGamma(uint32_t x) {
+        for (int b = std::bit_width(x) - 2; b >= 0; b--) {
+            putBit((x >> b) & 1);
+            putBit(b == 0);
+        }
+    }
+    void putLength(uint32_t code) {
+        if (code <= 2) {
+            putBit(code - 1);
+        } else if (code <= 4) {
+            putBit(1);
+            putBit(code - 3);
+        } else {
+            putBit(0);
+            putGamma(code - 3);
+        }
+    }
+    size_t size() const { return m_out.size(); }
+    std::vector<uint8_t>&& release() { return std::move(m_out); }
+
+  private:
+    std::vector<uint8_t> m_out;
+    size_t m_bitPos = 0;
+    unsigned m_bitCount = 0;
+};
+
+class MatchFinder {
+  public:
+    MatchFinder(const uint8_t* data, uint32_t size) : m_data(data), m_size(size), m_counts(size) {
+        // The hash chains are cheap to build, and need the whole input
+        // anyway, so they are done up front. Walking them is what's costly.
+        std::vector<uint32_t> head2(65536, c_none);
+        std::vector<uint32_t> head3(1 << c_hashBits, c_none);
+        m_prev2.resize(size, c_none);
+        m_prev3.resize(size, c_none);
+        for (uint32_t i = 0; i + 1 < size; i++) {
+            const uint8_t* p = data + i;
+            uint32_t key = p[0] | (p[1] << 8);
+            m_prev2[i] = head2[key];
+            head2[key] = i;
+            if (i + 2 >= size) continue;
+            uint32_t hash = ((key | (p[2] << 16)) * 2654435761u) >> (32 - c_hashBits);
+            m_prev3[i] = head3[hash];
+            head3[hash] = i;
+        }
+    }
+    void run(unsigned threads) {
+        size_t sliceSize = std::max(c_minSlice, (size_t(m_size) + threads - 1) / threads);
+        size_t slices = std::max<size_t>(1, (m_size + sliceSize - 1) / sliceSize);
+        std::vector<std::vector<Match>> results(slices);
+        std::vector<std::thread> workers;
+        for (size_t s = 0; s < slices; s++) {
+            uint32_t begin = s * sliceSize;
+            uint32_t end = std::min<size_t>(m_size, begin + sliceSize);
+            workers.emplace_back([this, begin, end, &matches = results[s]]() { find(begin, end, matches); });
+        }
+        for (auto& worker : workers) worker.join();
+        size_t total = 0;
+        for (auto& result : results) total += result.size();
+        m_matches.reserve(total);
+        for (auto& result : results) m_matches.insert(m_matches.end(), result.begin(), result.end());
+    }
+    // Each position gets a list of matches of strictly increasing lengths, and
+    // thus increasing offsets, stored back to back.
+    const std::vector<Match>& matches() const { return m_matches; }
+    const std::vector<uint16_t>& counts() const { return m_counts; }
+
+  private:
+    void find(uint32_t begin, uint32_t end, std::vector<Match>& matches) {
+        uint32_t i = begin;
+        while (i < end) {
+            size_t first = matches.size();
+            uint32_t maxLen = m_size - i;
+            uint32_t bestLen = 1;
+            const uint8_t* p = m_data + i;
+            uint32_t j = maxLen >= 2 ? m_prev2[i] : c_none;
+            if ((j != c_none) && ((i - j) <= c_nearOffset)) {
+                matches.push_back({2, i - j});
+                bestLen = 2;
+            }
+            j = maxLen >= 3 ? m_prev3[i] : c_none;
+            for (uint32_t chain = c_maxChain; (j != c_none) && chain && (bestLen < maxLen); chain--, j = m_prev3[j]) {
+                const uint8_t* q = m_data + j;
+                if (q[bestLen] != p[bestLen]) continue;
+                uint32_t len = commonLength(p, q, maxLen);
+                if ((len <= bestLen) || (len < 3)) continue;
+                matches.push_back({len, i - j});
+                bestLen = len;
+                if (len >= c_niceLength) break;
+            }
+            m_counts[i++] = matches.size() - first;
+            if (bestLen < c_niceLength) continue;
+            // Long matches are going to be taken as a whole, so there's no
+            // point searching for anything better in the middle of them.
+            Match match = matches.back();
+            for (uint32_t k = 1; (k < match.len) && (i < end); k++) {
+                uint32_t len = match.len - k;
+                bool usable = lengthCode(len, match.off) != 0;
+                if (usable) matches.push_back({len, match.off});
+                m_counts[i++] = usable ? 1 : 0;
+            }
+        }
+    }
+
+    const uint8_t* m_data;
+    const uint32_t m_size;
+    std::vector<uint32_t> m_prev2;
+    std::vector<uint32_t> m_prev3;
+    std::vector<uint16_t> m_counts;
+    std::vector<Match> m_matches;
+};
+
+}  // namespace
+
+std::vector<uint8_t> PCSX::N2E::compress(const uint8_t* data, size_t size_, unsigned threads, uint32_t* overlap) {
+    const uint32_t size = size_;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    MatchFinder finder(data, size);
+    finder.run(threads);
+    auto& matches = finder.matches();
+    auto& counts = finder.counts();
+
+    // Forward optimal parse: cost[i] is the cheapest amount of bits needed to
+    // encode the first i bytes, and the path reaching it is recorded so it can
+    // be walked back. The last offset used on that path is tracked as well, as
+    // reusing it is much cheaper than encoding a new one.
+    std::vector<uint32_t> cost(size + 1, c_none);
+    std::vector<uint32_t> stepLen(size + 1);
+    std::vector<uint32_t> stepOff(size + 1);
+    std::vector<uint32_t> lastOff(size + 1);
+    std::vector<bool> stepRep(size + 1);
+    cost[0] = 0;
+    lastOff[0] = 1;
+    auto relax = [&](uint32_t to, uint32_t bits, uint32_t len, uint32_t off, bool rep) {
+        if (bits >= cost[to]) return;
+        cost[to] = bits;
+        stepLen[to] = len;
+        stepOff[to] = off;
+        stepRep[to] = rep;
+        lastOff[to] = off ? off : lastOff[to - len];
+    };
+    size_t cursor = 0;
+    for (uint32_t i = 0; i < size; i++) {
+        const Match* candidates = matches.data() + cursor;
+        unsigned count = counts[i];
+        cursor += count;
+        uint32_t base = cost[i];
+        relax(i + 1, base + 9, 1, 0, false);
+
+        uint32_t rep = lastOff[i];
+        if (rep <= i) {
+            uint32_t len = commonLength(data + i, data + i - rep, std::min(size - i, c_niceLength));
+            for (uint32_t l = len >= c_niceLength ? len : 2; l <= len; l++) {
+                uint32_t code = lengthCode(l, rep);
+                if (code) relax(i + l, base + 4 + lengthBits(code), l, rep, true);
+            }
+        }
+
+        uint32_t l = 2;
+        for (unsigned c = 0; c < count; c++) {
+            auto& match = candidates[c];
+            uint32_t bits = base + 1 + offsetBits(match.off);
+            if (match.len >= c_niceLength) l = match.len;
+            for (; l <= match.len; l++) {
+                uint32_t code = lengthCode(l, match.off);
+                if (code) relax(i + l, bits + lengthBits(code), l, match.off, false);
+            }
+        }
+    }
+
+    std::vector<uint32_t> path;
+    for (uint32_t i = size; i > 0; i -= stepLen[i]) path.push_back(i);
+
+    BitWriter writer;
+    int64_t maxAhead = 0;
+    uint32_t pos = 0;
+    for (auto it = path.rbegin(); it != path.rend(); it++) {
+        uint32_t to = *it;
+        uint32_t len = stepLen[to];
+        uint32_t off = stepOff[to];
+        if (off == 0) {
+            writer.putBit(1);
+            writer.putByte(data[pos]);
+        } else {
+            uint32_t code = lengthCode(len, off);
+            writer.putBit(0);
+            if (stepRep[to]) {
+                writer.putPrefix(2);
+                writer.putBit(code <= 2);
+            } else {
+                uint32_t raw = ((off - 1) << 1) | (code <= 2 ? 0 : 1);
+                writer.putPrefix((raw >> 8) + 3);
+                writer.putByte(raw & 0xff);
+            }
+            writer.putLength(code);
+        }
+        pos = to;
+        maxAhead = std::max(maxAhead, int64_t(pos) - int64_t(writer.size()));
+    }
+    writer.putBit(0);
+    writer.putPrefix(c_endMarker);
+    writer.putByte(0xff);
+
+    // When decompressing in place, the output must never catch up with the
+    // compressed bytes which haven't been read yet.
+    if (overlap) *overlap = std::max<int64_t>(0, maxAhead + int64_t(writer.size()) - int64_t(size));
+    return writer.release();
+}
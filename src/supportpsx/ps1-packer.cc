@@ -29,12 +29,14 @@ SOFTWARE.
 #include <assert.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <exception>
 #include <vector>
 
 #include "mips/common/util/encoder.hh"
 #include "n2e-d.h"
 #include "support/polyfills.h"
+#include "supportpsx/n2e-compressor.h"
 #include "ucl/ucl.h"
 
 using namespace Mips::Encoder;
@@ -86,19 +88,30 @@ void PCSX::PS1Packer::pack(IO<File> src, IO<File> dest, uint32_t addr, uint32_t
     while ((dataIn.size() & 3) != 0) dataIn.push_back(0);
 
     std::vector<uint8_t> dataOut;
-    dataOut.resize(dataIn.size() * 1.2 + 2064);
-    ucl_uint outSize;
-    int r;
-
-    // Compress the binary using ucl-nrv2e, and store the compressed
-    // binary in dataOut, potentially offset by the size of our stub,
-    // if we're outputting a raw file.
-    r = ucl_nrv2e_99_compress(dataIn.data(), dataIn.size(), dataOut.data() + (options.raw ? stubSize : 0), &outSize,
-                              nullptr, 10, nullptr, nullptr);
-    if (r != UCL_E_OK) {
-        throw std::runtime_error("Fatal error during data compression.\n");
+    uint32_t overlap = 16;
+
+    // Compress the binary using ucl-nrv2e, or our own parallel nrv2e
+    // compressor when asked to, and store the compressed binary in
+    // dataOut, potentially offset by the size of our stub, if we're
+    // outputting a raw file.
+    if (!options.parallel) {
+        dataOut.resize(dataIn.size() * 1.2 + 2064);
+        ucl_uint outSize;
+        int r = ucl_nrv2e_99_compress(dataIn.data(), dataIn.size(), dataOut.data() + (options.raw ? stubSize : 0),
+                                      &outSize, nullptr, 10, nullptr, nullptr);
+        if (r != UCL_E_OK) {
+            throw std::runtime_error("Fatal error during data compression.\n");
+        }
+        dataOut.resize(outSize + (options.raw ? stubSize : 0));
+    } else {
+        auto compressed = N2E::compress(dataIn.data(), dataIn.size(), 0, &overlap);
+        dataOut.resize(options.raw ? stubSize : 0);
+        dataOut.insert(dataOut.end(), compressed.begin(), compressed.end());
+        // Our own compressor tells us exactly how much room in-place
+        // decompression needs, but we're keeping at least as much as before.
+        overlap = std::max(overlap, uint32_t(16));
+        overlap = (overlap + 3) & ~3;
     }
-    dataOut.resize(outSize + (options.raw ? stubSize : 0));
     while ((dataOut.size() & 3) != 0) {
         dataOut.push_back(0);
     }
@@ -117,8 +130,9 @@ void PCSX::PS1Packer::pack(IO<File> src, IO<File> dest, uint32_t addr, uint32_t
         // in-place decompression. We need to make sure
         // we have enough space to decompress our binary
         // in-place, and ucl-nrv2e requires 16 bytes to
-        // ensure this property.
-        newPC = addr + dataIn.size() + 16;
+        // ensure this property, or whatever our compressor
+        // told us it needs.
+        newPC = addr + dataIn.size() + overlap;
         compLoad = newPC - dataOut.size();
         uint32_t rawCompLoad = compLoad & 0x1fffffff;
         if (rawCompLoad < 0x10000) {
@@ -44,6 +44,8 @@ struct Options {
     bool raw = false;
     bool rom = false;
     bool cpe = false;
+    // Use our own parallel compressor instead of the ucl one.
+    bool parallel = false;
 };
 
 void pack(IO<File> src, IO<File> dest, uint32_t addr, uint32_t pc, uint32_t gp, uint32_t sp, const Options &);
@@ -0,0 +1,122 @@
+--   Copyright (C) 2024 PCSX-Redux authors
+--
+--   This program is free software; you can redistribute it and/or modify
+--   it under the terms of the GNU General Public License as published by
+--   the Free Software Foundation; either version 2 of the License, or
+--   (at your option) any later version.
+--
+--   This program is distributed in the hope that it will be useful,
+--   but WITHOUT ANY WARRANTY; without even the implied warranty of
+--   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+--   GNU General Public License for more details.
+--
+--   You should have received a copy of the GNU General Public License
+--   along with this program; if not, write to the
+--   Free Software Foundation, Inc.,
+--   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+local lu = require 'luaunit'
+
+TestGPU = {}
+
+local GP0 = 0x1f801810
+local GP1 = 0x1f801814
+local DPCR = 0x1f8010f0
+local MADR = 0x1f8010a0
+local BCR = 0x1f8010a4
+local CHCR = 0x1f8010a8
+-- Where the DMA packets are staged, and its physical address, for the linked list headers.
+local scratch = 0x80100000
+local scratchPhys = 0x00100000
+
+-- Each packet gets drawn in a row of three 64x64 cells, one per path, and the
+-- packets are stacked in two columns of such rows, to fit in VRAM.
+local cellSize = 64
+local rowsPerColumn = 5
+
+local function xy(x, y) return bit.bor(bit.lshift(y, 16), x) end
+
+-- One of each kind of primitive whose length is known from its header, drawn
+-- relative to the top left corner of a cell.
+local packets = {
+    { 0x20ff8033, xy(4, 4), xy(56, 16), xy(8, 56) },
+    { 0x30ff0000, xy(4, 4), 0x0000ff00, xy(56, 16), 0x000000ff, xy(8, 56) },
+    { 0x28ff8033, xy(4, 4), xy(56, 4), xy(4, 56), xy(56, 56) },
+    { 0x38ff0000, xy(4, 4), 0x0000ff00, xy(56, 4), 0x000000ff, xy(4, 56), 0x00ffffff, xy(56, 56) },
+    { 0x40ffffff, xy(4, 4), xy(58, 40) },
+    { 0x50ff0000, xy(4, 56), 0x000000ff, xy(56, 4) },
+    { 0x6033ff80, xy(8, 8), xy(48, 32) },
+    { 0x6880ff33, xy(8, 8) },
+    { 0x7033ff80, xy(8, 8) },
+    { 0x7880ff33, xy(8, 8) },
+}
+
+local function write(words)
+    for _, word in ipairs(words) do PCSX.writeMemory(GP0, word) end
+end
+
+local function moveTo(cellX, cellY)
+    local x, y = cellX * cellSize, cellY * cellSize
+    write { bit.bor(0xe5000000, bit.lshift(y, 11), x) }
+end
+
+-- The data port feeds the words one by one to the primitive's state machine.
+local function drawWithWrites(packet) write(packet) end
+
+-- A single block DMA carries the whole packet, which is then decoded in one go.
+local function drawWithBlockDMA(packet)
+    for i, word in ipairs(packet) do PCSX.writeMemory(scratch + (i - 1) * 4, word) end
+    PCSX.writeMemory(MADR, scratch)
+    PCSX.writeMemory(BCR, bit.bor(bit.lshift(1, 16), #packet))
+    PCSX.writeMemory(CHCR, 0x01000201)
+end
+
+-- A linked list DMA whose two nodes each carry half of the packet, so it
+-- starts in one buffer and ends in the next.
+local function drawWithSplitChain(packet)
+    local split = math.floor(#packet / 2)
+    local second = scratch + (split + 1) * 4
+    local secondPhys = scratchPhys + (split + 1) * 4
+    PCSX.writeMemory(scratch, bit.bor(bit.lshift(split, 24), secondPhys))
+    for i = 1, split do PCSX.writeMemory(scratch + i * 4, packet[i]) end
+    PCSX.writeMemory(second, bit.bor(bit.lshift(#packet - split, 24), 0xffffff))
+    for i = split + 1, #packet do PCSX.writeMemory(second + (i - split) * 4, packet[i]) end
+    PCSX.writeMemory(MADR, scratch)
+    PCSX.writeMemory(CHCR, 0x01000401)
+end
+
+local function readCell(cellX, cellY)
+    write { 0xc0000000, xy(cellX * cellSize, cellY * cellSize), xy(cellSize, cellSize) }
+    local words = {}
+    for i = 1, cellSize * cellSize / 2 do words[i] = PCSX.readMemory(GP0) end
+    return words
+end
+
+function TestGPU:setUp()
+    PCSX.writeMemory(GP1, 0)
+    PCSX.writeMemory(DPCR, bit.bor(PCSX.readMemory(DPCR), 0x800))
+    write { 0xe1000000, 0xe3000000, bit.bor(0xe4000000, bit.lshift(511, 10), 1023) }
+    -- One extra column of cells, so the top right one stays empty.
+    write { 0x02000000, xy(0, 0), xy(7 * cellSize, rowsPerColumn * cellSize) }
+end
+
+function TestGPU:test_packetPathsMatchWordByWordWrites()
+    local paths = { drawWithWrites, drawWithBlockDMA, drawWithSplitChain }
+    local function cell(i, p)
+        return 3 * math.floor((i - 1) / rowsPerColumn) + p - 1, (i - 1) % rowsPerColumn
+    end
+    for i, packet in ipairs(packets) do
+        for p, draw in ipairs(paths) do
+            moveTo(cell(i, p))
+            draw(packet)
+        end
+    end
+    local empty = readCell(6, 0)
+    for i, packet in ipairs(packets) do
+        local reference = readCell(cell(i, 1))
+        local name = string.format('%08x', packet[1])
+        lu.assertNotEquals(reference, empty, 'packet ' .. name .. ' drew nothing')
+        lu.assertEquals(readCell(cell(i, 2)), reference, 'packet ' .. name .. ' through block DMA')
+        lu.assertEquals(readCell(cell(i, 3)), reference, 'packet ' .. name .. ' through split chain')
+    end
+end
@@ -0,0 +1,65 @@
+--   Copyright (C) 2024 PCSX-Redux authors
+--
+--   This program is free software; you can redistribute it and/or modify
+--   it under the terms of the GNU General Public License as published by
+--   the Free Software Foundation; either version 2 of the License, or
+--   (at your option) any later version.
+--
+--   This program is distributed in the hope that it will be useful,
+--   but WITHOUT ANY WARRANTY; without even the implied warranty of
+--   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+--   GNU General Public License for more details.
+--
+--   You should have received a copy of the GNU General Public License
+--   along with this program; if not, write to the
+--   Free Software Foundation, Inc.,
+--   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+local lu = require 'luaunit'
+
+TestMemory = {}
+
+-- Nothing is mapped in this part of kuseg, so accesses fall through to the fallback handler.
+local unmapped = 0x0f000000
+
+function TestMemory:tearDown()
+    PCSX.setUnknownMemoryHooks(nil, nil)
+end
+
+function TestMemory:test_unmappedReadsAreOpenBus()
+    lu.assertEquals(PCSX.readMemory(unmapped), 0xffffffff)
+end
+
+function TestMemory:test_setUnknownMemoryHooks()
+    local written = {}
+    PCSX.setUnknownMemoryHooks(function(address, size)
+        return address + size
+    end, function(address, size, value)
+        written[#written + 1] = { address, size, value }
+        return true
+    end)
+    lu.assertEquals(PCSX.readMemory(unmapped), unmapped + 4)
+    lu.assertEquals(PCSX.readMemory(unmapped, 2), unmapped + 2)
+    PCSX.writeMemory(unmapped, 0x1234, 2)
+    lu.assertEquals(written, { { unmapped, 2, 0x1234 } })
+    PCSX.setUnknownMemoryHooks(nil, nil)
+    lu.assertEquals(PCSX.readMemory(unmapped), 0xffffffff)
+end
+
+function TestMemory:test_legacyGlobals()
+    UnknownMemoryRead = function(address, size)
+        return 0x12345678
+    end
+    lu.assertEquals(PCSX.readMemory(unmapped), 0x12345678)
+    lu.assertNil(rawget(_G, 'UnknownMemoryRead'))
+    lu.assertNil(UnknownMemoryRead)
+    UnknownMemoryRead = nil
+    lu.assertEquals(PCSX.readMemory(unmapped), 0xffffffff)
+end
+
+function TestMemory:test_undefinedGlobalsStayUndefined()
+    lu.assertNil(SomeUndefinedGlobal)
+    SomeDefinedGlobal = 42
+    lu.assertEquals(rawget(_G, 'SomeDefinedGlobal'), 42)
+    SomeDefinedGlobal = nil
+end
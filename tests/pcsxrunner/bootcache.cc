@@ -0,0 +1,118 @@
+/***************************************************************************
+ *   Copyright (C) 2024 PCSX-Redux authors                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+// Post-boot snapshot cache: the first -fastboot run captures a snapshot when reaching the shell,
+// and the next one restores it instead of going through the BIOS initialization again. The state
+// trace tells the two apart, since a restored run starts straight at the snapshot's cycle count.
+// Passing -no-bootcache alongside -fastboot opts out of the cache entirely.
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "main/main.h"
+#include "tests/pcsxrunner/statetrace.h"
+
+namespace {
+
+using namespace StateTrace;
+
+std::vector<std::filesystem::path> listCache(const std::filesystem::path& dir) {
+    std::vector<std::filesystem::path> files;
+    std::error_code ec;
+    for (auto& entry : std::filesystem::directory_iterator(dir / "bootcache", ec)) files.push_back(entry.path());
+    return files;
+}
+
+std::vector<Record> runFastboot(const std::filesystem::path& dir) {
+    auto portable = dir.string();
+    auto trace = (dir / "boot.strc").string();
+    MainInvoker invoker("-no-ui", "-run", "-bios", "src/mips/openbios/openbios.bin", "-testmode", "-interpreter",
+                        "-fastboot", "-portable", portable.c_str(), "-statetrace", trace.c_str(), "-loadexe",
+                        "src/mips/tests/basic/basic.ps-exe");
+    EXPECT_EQ(invoker.invoke(), 0);
+    auto records = StateTrace::read(trace);
+    std::filesystem::remove(trace);
+    return records;
+}
+
+std::optional<uint64_t> firstEventCheckCycle(const std::vector<Record>& records) {
+    for (auto& record : records) {
+        if (record.kind == EventCheck) return record.cycle;
+    }
+    return std::nullopt;
+}
+
+std::optional<uint64_t> shellReachedCycle(const std::vector<Record>& records) {
+    for (auto& record : records) {
+        if (record.pc == 0x80030000) return record.cycle;
+    }
+    return std::nullopt;
+}
+
+}  // namespace
+
+TEST(BootCache, CaptureAndRestore) {
+    auto dir = std::filesystem::temp_directory_path() / "pcsx-redux-bootcache";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    // First run: no cache yet, so the BIOS boots normally, and the snapshot gets captured.
+    auto cold = runFastboot(dir);
+    auto files = listCache(dir);
+    ASSERT_EQ(files.size(), 1u);
+    EXPECT_EQ(files[0].extension(), ".sstate");
+    EXPECT_GT(std::filesystem::file_size(files[0]), 0u);
+    const auto writeTime = std::filesystem::last_write_time(files[0]);
+    auto shell = shellReachedCycle(cold);
+    auto coldStart = firstEventCheckCycle(cold);
+    ASSERT_TRUE(shell.has_value());
+    ASSERT_TRUE(coldStart.has_value());
+    EXPECT_LT(coldStart.value(), shell.value());
+
+    // Second run: the snapshot is restored right after the reset, and left untouched.
+    auto warm = runFastboot(dir);
+    files = listCache(dir);
+    ASSERT_EQ(files.size(), 1u);
+    EXPECT_EQ(std::filesystem::last_write_time(files[0]), writeTime);
+    auto warmStart = firstEventCheckCycle(warm);
+    ASSERT_TRUE(warmStart.has_value());
+    EXPECT_GE(warmStart.value(), shell.value());
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(BootCache, OptOut) {
+    auto dir = std::filesystem::temp_directory_path() / "pcsx-redux-bootcache-optout";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    // -fastboot still skips the shell, but -no-bootcache keeps it from capturing anything.
+    auto portable = dir.string();
+    MainInvoker invoker("-no-ui", "-run", "-bios", "src/mips/openbios/openbios.bin", "-testmode", "-interpreter",
+                        "-fastboot", "-no-bootcache", "-portable", portable.c_str(), "-loadexe",
+                        "src/mips/tests/basic/basic.ps-exe");
+    EXPECT_EQ(invoker.invoke(), 0);
+    EXPECT_TRUE(listCache(dir).empty());
+
+    std::filesystem::remove_all(dir);
+}
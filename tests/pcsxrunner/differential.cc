@@ -0,0 +1,126 @@
+/***************************************************************************
+ *   Copyright (C) 2024 PCSX-Redux authors                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+// Differential tests: runs the same program through the interpreter and the dynarec, with state
+// tracing enabled, and cross-checks the registers and a page of RAM at every common event check. These don't
+// depend on the host architecture, so they're also the way to validate the AArch64 recompiler,
+// for instance by running the test suite under qemu-user.
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "main/main.h"
+#include "tests/pcsxrunner/statetrace.h"
+
+namespace {
+
+using namespace StateTrace;
+
+std::string runTraced(const char* cpu, const char* exe, const char* name) {
+    auto path = std::filesystem::temp_directory_path() / (std::string("pcsx-redux-") + name + ".strc");
+    std::string trace = path.string();
+    MainInvoker invoker("-no-ui", "-run", "-bios", "src/mips/openbios/openbios.bin", "-testmode", cpu, "-statetrace",
+                        trace.c_str(), "-loadexe", exe);
+    int ret = invoker.invoke();
+    EXPECT_EQ(ret, 0);
+    return trace;
+}
+
+// Synchronous exceptions are identified by where they happened; the recompiler only updates the
+// cycle counter at the end of blocks, so only interrupts get their timing compared.
+std::tuple<uint32_t, uint64_t, uint64_t> exceptionKey(const Record& record) {
+    const bool interrupt = ((record.value >> 2) & 0x1f) == 0;
+    return {record.pc, record.value, interrupt ? record.cycle : 0};
+}
+
+void compareTraces(const char* exe, const char* name) {
+    auto interpreterPath = runTraced("-interpreter", exe, (std::string(name) + "-interpreter").c_str());
+    auto dynarecPath = runTraced("-dynarec", exe, (std::string(name) + "-dynarec").c_str());
+    auto interpreter = StateTrace::read(interpreterPath);
+    auto dynarec = StateTrace::read(dynarecPath);
+    std::filesystem::remove(interpreterPath);
+    std::filesystem::remove(dynarecPath);
+    ASSERT_FALSE(interpreter.empty());
+    ASSERT_FALSE(dynarec.empty());
+
+    // Both cores check for events at different rates, which means interrupts can be serviced at
+    // different points. Once the exception histories diverge, the states can't be compared anymore.
+    std::vector<std::tuple<uint32_t, uint64_t, uint64_t>> interpreterExceptions, dynarecExceptions;
+    for (auto& record : interpreter) {
+        if (record.kind == Exception) interpreterExceptions.push_back(exceptionKey(record));
+    }
+    for (auto& record : dynarec) {
+        if (record.kind == Exception) dynarecExceptions.push_back(exceptionKey(record));
+    }
+    uint64_t synchronizedEpochs = 0;
+    while ((synchronizedEpochs < interpreterExceptions.size()) && (synchronizedEpochs < dynarecExceptions.size()) &&
+           (interpreterExceptions[synchronizedEpochs] == dynarecExceptions[synchronizedEpochs])) {
+        synchronizedEpochs++;
+    }
+
+    // Each event check is followed by the memory record taken at the same point.
+    typedef std::tuple<uint32_t, uint64_t, uint32_t, uint64_t> StateKey;
+    const auto stateKey = [](const Record& record) {
+        return std::make_tuple(record.kind, record.epoch, record.pc, record.cycle);
+    };
+    const auto comparable = [synchronizedEpochs](const Record& record) {
+        return ((record.kind == EventCheck) || (record.kind == Memory)) && (record.epoch <= synchronizedEpochs);
+    };
+    std::map<StateKey, uint64_t> states;
+    for (auto& record : interpreter) {
+        if (comparable(record)) states.emplace(stateKey(record), record.value);
+    }
+
+    unsigned compared[2] = {0, 0};
+    unsigned mismatches = 0;
+    for (auto& record : dynarec) {
+        if (!comparable(record)) continue;
+        auto state = states.find(stateKey(record));
+        if (state == states.end()) continue;
+        const bool memory = record.kind == Memory;
+        compared[memory]++;
+        if (state->second == record.value) continue;
+        // Report only the first few divergences; the rest is usually fallout from the first one.
+        if (mismatches++ < 8) {
+            ADD_FAILURE() << std::hex << (memory ? "Memory" : "Register") << " state mismatch at pc 0x" << record.pc
+                          << ", cycle 0x" << record.cycle << ", epoch 0x" << record.epoch;
+        }
+    }
+    EXPECT_EQ(mismatches, 0u);
+    EXPECT_GE(compared[0], 100u);
+    EXPECT_GE(compared[1], 100u);
+
+    // If both runs took exactly the same exceptions, the final memory contents have to match too.
+    if ((synchronizedEpochs == interpreterExceptions.size()) && (synchronizedEpochs == dynarecExceptions.size())) {
+        ASSERT_EQ(interpreter.back().kind, End);
+        ASSERT_EQ(dynarec.back().kind, End);
+        EXPECT_EQ(interpreter.back().value, dynarec.back().value);
+    }
+}
+
+}  // namespace
+
+TEST(Differential, CPU) { compareTraces("src/mips/tests/cpu/cpu.ps-exe", "cpu"); }
+
+TEST(Differential, Basic) { compareTraces("src/mips/tests/basic/basic.ps-exe", "basic"); }
@@ -0,0 +1,46 @@
+/***************************************************************************
+ *   Copyright (C) 2024 PCSX-Redux authors                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#include "core/gpu.h"
+
+#include "gtest/gtest.h"
+
+// Expected lengths, header included, indexed by the shading, shape/size and texture bits of the command.
+// The two lowest bits, semi transparency and raw texture, never change the length of a packet.
+
+TEST(GPUPacketWords, Polygons) {
+    static constexpr unsigned expected[8] = {4, 7, 5, 9, 6, 9, 8, 12};
+    for (unsigned command = 0; command < 32; command++) {
+        EXPECT_EQ(PCSX::GPU::polyPacketWords(command), expected[command >> 2]) << "command " << command;
+    }
+}
+
+TEST(GPUPacketWords, Lines) {
+    static constexpr unsigned expected[8] = {3, 3, 0, 0, 4, 4, 0, 0};
+    for (unsigned command = 0; command < 32; command++) {
+        EXPECT_EQ(PCSX::GPU::linePacketWords(command), expected[command >> 2]) << "command " << command;
+    }
+}
+
+TEST(GPUPacketWords, Rectangles) {
+    static constexpr unsigned expected[8] = {3, 4, 2, 3, 2, 3, 2, 3};
+    for (unsigned command = 0; command < 32; command++) {
+        EXPECT_EQ(PCSX::GPU::rectPacketWords(command), expected[command >> 2]) << "command " << command;
+    }
+}
@@ -17,19 +17,50 @@
  *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
  ***************************************************************************/
 
+#include <string>
+
 #include "gtest/gtest.h"
 #include "main/main.h"
 
+// Answers the queries src/mips/tests/libc/hle.c makes through its exec slot: how many
+// times an A0 call ran natively, and whether these runs are expected to happen at all.
+static std::string hleQuery(bool hle) {
+    return std::string(
+               "PCSX.execSlots[0x48] = function() "
+               "local query = ffi.cast('uint32_t*', PCSX.getScratchPtr()) "
+               "query[1] = PCSX.getHLECallCount(query[0]) "
+               "query[2] = ") +
+           (hle ? "1" : "0") + " end";
+}
+
 TEST(libc, Interpreter) {
+    auto query = hleQuery(false);
     MainInvoker invoker("-no-ui", "-run", "-bios", "src/mips/openbios/openbios.bin", "-testmode", "-interpreter",
-                        "-luacov", "-loadexe", "src/mips/tests/libc/libc.ps-exe");
+                        "-luacov", "-exec", query.c_str(), "-loadexe", "src/mips/tests/libc/libc.ps-exe");
     int ret = invoker.invoke();
     EXPECT_EQ(ret, 0);
 }
 
 TEST(libc, Dynarec) {
+    auto query = hleQuery(false);
+    MainInvoker invoker("-no-ui", "-run", "-bios", "src/mips/openbios/openbios.bin", "-testmode", "-dynarec",
+                        "-luacov", "-exec", query.c_str(), "-loadexe", "src/mips/tests/libc/libc.ps-exe");
+    int ret = invoker.invoke();
+    EXPECT_EQ(ret, 0);
+}
+
+TEST(libc, InterpreterHLE) {
+    auto query = hleQuery(true);
+    MainInvoker invoker("-no-ui", "-run", "-bios", "src/mips/openbios/openbios.bin", "-testmode", "-interpreter",
+                        "-hle", "-luacov", "-exec", query.c_str(), "-loadexe", "src/mips/tests/libc/libc.ps-exe");
+    int ret = invoker.invoke();
+    EXPECT_EQ(ret, 0);
+}
+
+TEST(libc, DynarecHLE) {
+    auto query = hleQuery(true);
     MainInvoker invoker("-no-ui", "-run", "-bios", "src/mips/openbios/openbios.bin", "-testmode", "-dynarec",
-                        "-luacov", "-loadexe", "src/mips/tests/libc/libc.ps-exe");
+                        "-hle", "-luacov", "-exec", query.c_str(), "-loadexe", "src/mips/tests/libc/libc.ps-exe");
     int ret = invoker.invoke();
     EXPECT_EQ(ret, 0);
-}
\ No newline at end of file
+}
@@ -68,3 +68,7 @@ TEST(LuaFile, Interpreter) { EXPECT_EQ(runLuaIntTest("tests.lua.file"), 0); }
 TEST(LuaFile, Dynarec) { EXPECT_EQ(runLuaDynTest("tests.lua.file"), 0); }
 TEST(LuaAdpcm, Interpreter) { EXPECT_EQ(runLuaIntTest("tests.lua.adpcm"), 0); }
 TEST(LuaAdpcm, Dynarec) { EXPECT_EQ(runLuaDynTest("tests.lua.adpcm"), 0); }
+TEST(LuaMemory, Interpreter) { EXPECT_EQ(runLuaIntTest("tests.lua.memory"), 0); }
+TEST(LuaMemory, Dynarec) { EXPECT_EQ(runLuaDynTest("tests.lua.memory"), 0); }
+TEST(LuaGPU, Interpreter) { EXPECT_EQ(runLuaIntTest("tests.lua.gpu"), 0); }
+TEST(LuaGPU, Dynarec) { EXPECT_EQ(runLuaDynTest("tests.lua.gpu"), 0); }
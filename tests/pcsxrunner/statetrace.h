@@ -0,0 +1,53 @@
+/***************************************************************************
+ *   Copyright (C) 2024 PCSX-Redux authors                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+// Reader for the files written by -statetrace: a "STRC" magic and a version,
+// followed by fixed size records, as emitted by R3000Acpu::recordState.
+namespace StateTrace {
+
+struct Record {
+    uint32_t kind;
+    uint32_t pc;
+    uint64_t cycle;
+    uint64_t epoch;
+    uint64_t value;
+};
+
+enum : uint32_t { EventCheck = 0, Exception = 1, End = 2, Memory = 3 };
+
+// Returns no records at all if the file is missing, or isn't of the version we know about.
+inline std::vector<Record> read(const std::filesystem::path& path) {
+    std::vector<Record> records;
+    std::ifstream in(path, std::ios::binary);
+    uint32_t header[2] = {0, 0};
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!in || (header[0] != 0x43525453) || (header[1] != 2)) return records;
+    Record record;
+    while (in.read(reinterpret_cast<char*>(&record), sizeof(record))) records.push_back(record);
+    return records;
+}
+
+}  // namespace StateTrace
@@ -0,0 +1,101 @@
+/***************************************************************************
+ *   Copyright (C) 2024 PCSX-Redux authors                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#include "supportpsx/adpcm.h"
+
+#include <math.h>
+#include <stdint.h>
+
+#include <numbers>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::vector<int16_t> makeSamples(size_t count, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::vector<int16_t> samples(count);
+    double frequency = 100 + gen() % 2000;
+    for (size_t i = 0; i < count; i++) {
+        double v = 12000 * sin(i * frequency * 2 * std::numbers::pi / 44100.0) + int(gen() % 1024) - 512;
+        // Sprinkle some near silence, to exercise the filter 0 shortcut.
+        if ((i / 1000) % 5 == 2) v = int(gen() % 8) - 4;
+        samples[i] = v;
+    }
+    return samples;
+}
+
+std::vector<std::vector<int16_t>> makeStreams() {
+    std::vector<std::vector<int16_t>> streams;
+    for (unsigned i = 0; i < 9; i++) streams.push_back(makeSamples(1000 + i * 4321 + (i & 1) * 13, i));
+    streams.push_back({});
+    return streams;
+}
+
+}  // namespace
+
+TEST(ADPCM, SPUBatchMatchesSerial) {
+    auto streams = makeStreams();
+    std::vector<std::span<const int16_t>> inputs(streams.begin(), streams.end());
+    auto outputs = PCSX::ADPCM::Encoder::processSPUBatch(inputs, PCSX::ADPCM::Encoder::Mode::Normal, 4);
+    ASSERT_EQ(outputs.size(), streams.size());
+    PCSX::ADPCM::Encoder encoder;
+    for (size_t i = 0; i < streams.size(); i++) {
+        auto& stream = streams[i];
+        encoder.reset();
+        std::vector<uint8_t> expected;
+        for (size_t pos = 0; pos < stream.size(); pos += 28) {
+            int16_t block[28] = {};
+            std::copy(stream.begin() + pos, stream.begin() + std::min(pos + 28, stream.size()), block);
+            uint8_t out[16];
+            encoder.processSPUBlock(block, out, PCSX::ADPCM::Encoder::BlockAttribute::OneShot);
+            expected.insert(expected.end(), out, out + 16);
+        }
+        EXPECT_EQ(outputs[i], expected);
+    }
+}
+
+TEST(ADPCM, XABatchMatchesSerial) {
+    auto streams = makeStreams();
+    std::vector<std::span<const int16_t>> inputs(streams.begin(), streams.end());
+    for (auto mode : {PCSX::ADPCM::Encoder::XAMode::FourBits, PCSX::ADPCM::Encoder::XAMode::EightBits}) {
+        for (unsigned channels = 1; channels <= 2; channels++) {
+            auto outputs = PCSX::ADPCM::Encoder::processXABatch(inputs, mode, channels, 3);
+            ASSERT_EQ(outputs.size(), streams.size());
+            size_t blockSize = mode == PCSX::ADPCM::Encoder::XAMode::FourBits ? 224 : 112;
+            PCSX::ADPCM::Encoder encoder;
+            for (size_t i = 0; i < streams.size(); i++) {
+                auto& stream = streams[i];
+                encoder.reset(PCSX::ADPCM::Encoder::Mode::XA);
+                std::vector<uint8_t> expected;
+                for (size_t pos = 0; pos < stream.size(); pos += blockSize) {
+                    int16_t block[224] = {};
+                    std::copy(stream.begin() + pos, stream.begin() + std::min(pos + blockSize, stream.size()), block);
+                    uint8_t out[128];
+                    encoder.processXABlock(block, out, mode, channels);
+                    expected.insert(expected.end(), out, out + 128);
+                }
+                EXPECT_EQ(outputs[i], expected);
+            }
+        }
+    }
+}
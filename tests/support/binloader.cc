@@ -0,0 +1,216 @@
+/***************************************************************************
+ *   Copyright (C) 2024 PCSX-Redux authors                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#include "supportpsx/binloader.h"
+
+#include <string.h>
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "elfio/elfio.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+
+void put16(std::vector<uint8_t>& data, size_t offset, uint16_t value) {
+    data[offset + 0] = value;
+    data[offset + 1] = value >> 8;
+}
+
+void put32(std::vector<uint8_t>& data, size_t offset, uint32_t value) {
+    put16(data, offset, value);
+    put16(data, offset + 2, value >> 16);
+}
+
+size_t append(std::vector<uint8_t>& data, const void* src, size_t size) {
+    size_t offset = data.size();
+    data.insert(data.end(), reinterpret_cast<const uint8_t*>(src), reinterpret_cast<const uint8_t*>(src) + size);
+    return offset;
+}
+
+constexpr uint32_t c_entry = 0x80010008;
+
+// A small MIPS executable, with two loadable sections, a comment which
+// doesn't get loaded, and a symbol table whose last symbol is at the given
+// address. Without section headers, all that remains is the entry point.
+std::vector<uint8_t> buildELF(uint32_t counter, bool sectionHeaders = true) {
+    std::vector<uint8_t> elf(52, 0);
+    const uint8_t ident[] = {0x7f, 'E', 'L', 'F', 1, 1, 1};
+    memcpy(elf.data(), ident, sizeof(ident));
+    put16(elf, 16, 2);  // ET_EXEC
+    put16(elf, 18, 8);  // EM_MIPS
+    put32(elf, 20, 1);
+    put32(elf, 24, c_entry);
+    put16(elf, 40, 52);
+    put16(elf, 42, 32);
+    put16(elf, 46, 40);
+
+    const uint8_t text[16] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+    const uint8_t data[8] = {0xde, 0xad, 0xbe, 0xef, 0xca, 0xfe, 0xba, 0xbe};
+    const char comment[] = "GCC";
+    const char strtab[] = "\0main\0counter";
+    const char shstrtab[] = "\0.text\0.data\0.comment\0.symtab\0.strtab\0.shstrtab";
+    std::vector<uint8_t> symtab(48, 0);
+    put32(symtab, 16, 1);
+    put32(symtab, 20, c_entry);
+    put32(symtab, 32, 6);
+    put32(symtab, 36, counter);
+
+    size_t textOffset = append(elf, text, sizeof(text));
+    size_t dataOffset = append(elf, data, sizeof(data));
+    size_t commentOffset = append(elf, comment, sizeof(comment));
+    size_t symtabOffset = append(elf, symtab.data(), symtab.size());
+    size_t strtabOffset = append(elf, strtab, sizeof(strtab));
+    size_t shstrtabOffset = append(elf, shstrtab, sizeof(shstrtab));
+    while ((elf.size() & 3) != 0) elf.push_back(0);
+    if (!sectionHeaders) return elf;
+
+    struct {
+        uint32_t name, type, addr;
+        size_t offset, size;
+        uint32_t link;
+    } sections[] = {
+        {0, 0, 0, 0, 0, 0},
+        {1, 1, 0x80010000, textOffset, sizeof(text), 0},
+        {7, 1, 0x80010010, dataOffset, sizeof(data), 0},
+        {13, 1, 0, commentOffset, sizeof(comment), 0},
+        {22, 2, 0, symtabOffset, symtab.size(), 5},
+        {30, 3, 0, strtabOffset, sizeof(strtab), 0},
+        {38, 3, 0, shstrtabOffset, sizeof(shstrtab), 0},
+    };
+    put32(elf, 32, elf.size());
+    put16(elf, 48, std::size(sections));
+    put16(elf, 50, 6);
+    for (auto& section : sections) {
+        size_t base = elf.size();
+        elf.resize(base + 40, 0);
+        put32(elf, base + 0, section.name);
+        put32(elf, base + 4, section.type);
+        put32(elf, base + 12, section.addr);
+        put32(elf, base + 16, section.offset);
+        put32(elf, base + 20, section.size);
+        put32(elf, base + 24, section.link);
+        if (section.type == 2) put32(elf, base + 36, 16);
+    }
+    return elf;
+}
+
+std::filesystem::path writeFixture(const char* name, const std::vector<uint8_t>& elf) {
+    auto path = std::filesystem::temp_directory_path() / name;
+    PCSX::IO<PCSX::File> out(new PCSX::PosixFile(path, PCSX::FileOps::TRUNCATE));
+    out->write(elf.data(), elf.size());
+    out->close();
+    return path;
+}
+
+std::shared_ptr<const PCSX::BinaryLoader::Index> indexFile(const std::filesystem::path& path) {
+    PCSX::IO<PCSX::File> in(new PCSX::PosixFile(path));
+    auto index = PCSX::BinaryLoader::index(in);
+    in->close();
+    return index;
+}
+
+}  // namespace
+
+TEST(BinaryLoader, ELFIndexMatchesELFIO) {
+    auto path = writeFixture("pcsx-binloader-test.elf", buildELF(0x80010010));
+    auto index = indexFile(path);
+    ASSERT_TRUE(index);
+
+    ELFIO::elfio reader;
+    ASSERT_TRUE(reader.load(path.string()));
+    EXPECT_EQ(index->info.pc, reader.get_entry());
+
+    std::vector<ELFIO::section*> loaded;
+    std::map<uint32_t, std::string> symbols;
+    for (unsigned i = 0; i < reader.sections.size(); i++) {
+        ELFIO::section* section = reader.sections[i];
+        auto type = section->get_type();
+        if ((type == ELFIO::SHT_PROGBITS) && (section->get_name() != ".comment")) loaded.push_back(section);
+        if (type != ELFIO::SHT_SYMTAB) continue;
+        const ELFIO::symbol_section_accessor accessor(reader, section);
+        for (unsigned s = 0; s < accessor.get_symbols_num(); s++) {
+            std::string name;
+            ELFIO::Elf64_Addr value;
+            ELFIO::Elf_Xword size;
+            unsigned char bind, type, other;
+            ELFIO::Elf_Half sectionIndex;
+            accessor.get_symbol(s, name, value, size, bind, type, sectionIndex, other);
+            symbols[value] = name;
+        }
+    }
+    EXPECT_EQ(index->symbols, symbols);
+
+    PCSX::IO<PCSX::File> in(new PCSX::PosixFile(path));
+    ASSERT_EQ(index->segments.size(), loaded.size());
+    for (size_t i = 0; i < loaded.size(); i++) {
+        auto& segment = index->segments[i];
+        EXPECT_FALSE(segment.source);
+        EXPECT_EQ(segment.address, loaded[i]->get_address());
+        ASSERT_EQ(segment.size, loaded[i]->get_size());
+        auto data = in->readAt(segment.size, segment.offset);
+        ASSERT_EQ(data.size(), segment.size);
+        EXPECT_EQ(memcmp(data.data(), loaded[i]->get_data(), segment.size), 0);
+    }
+    in->close();
+    std::filesystem::remove(path);
+}
+
+TEST(BinaryLoader, ELFWithoutSectionHeaders) {
+    auto path = writeFixture("pcsx-binloader-test-noshdr.elf", buildELF(0x80010010, false));
+    auto index = indexFile(path);
+    ASSERT_TRUE(index);
+    EXPECT_EQ(index->info.pc, c_entry);
+    EXPECT_TRUE(index->segments.empty());
+    EXPECT_TRUE(index->symbols.empty());
+    std::filesystem::remove(path);
+}
+
+TEST(BinaryLoader, ELFIndexCache) {
+    auto path = writeFixture("pcsx-binloader-test-cache.elf", buildELF(0x80010010));
+    auto first = indexFile(path);
+    ASSERT_TRUE(first);
+    // A hit hands out the very same index.
+    EXPECT_EQ(indexFile(path), first);
+
+    // Same size, different modification time.
+    auto mtime = std::filesystem::last_write_time(path);
+    writeFixture("pcsx-binloader-test-cache.elf", buildELF(0x80010014));
+    std::filesystem::last_write_time(path, mtime + std::chrono::seconds(1));
+    auto second = indexFile(path);
+    ASSERT_TRUE(second);
+    EXPECT_NE(second, first);
+    EXPECT_EQ(second->symbols.count(0x80010014), 1);
+    EXPECT_EQ(second->symbols.count(0x80010010), 0);
+
+    // Same modification time, different size.
+    auto elf = buildELF(0x80010018);
+    elf.resize(elf.size() + 16, 0);
+    mtime = std::filesystem::last_write_time(path);
+    writeFixture("pcsx-binloader-test-cache.elf", elf);
+    std::filesystem::last_write_time(path, mtime);
+    auto third = indexFile(path);
+    ASSERT_TRUE(third);
+    EXPECT_NE(third, second);
+    EXPECT_EQ(third->symbols.count(0x80010018), 1);
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,176 @@
+/***************************************************************************
+ *   Copyright (C) 2024 PCSX-Redux authors                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#include "cdrom/chd.h"
+
+#include <string.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "core/system.h"
+#include "gtest/gtest.h"
+
+// The fixture is generated by tests/support/chd/make-fixture.py: two tracks,
+// mode 1 data then audio with a stored pregap, over four hunks of four frames,
+// compressed with cdlz, cdzl, and cdfl twice. fixture.bin is the flat raw image
+// ChdFile is expected to present.
+
+namespace {
+
+// ChdFile reports corrupted hunks through g_system.
+class TestSystem final : public PCSX::System {
+    virtual void softReset() final override {}
+    virtual void hardReset() final override {}
+    virtual void biosPutc(int c) final override {}
+    virtual const PCSX::Arguments& getArgs() const final override { std::abort(); }
+    virtual void printf(std::string&& s) final override { m_output += s; }
+    virtual void log(PCSX::LogClass, std::string&& s) final override { m_output += s; }
+    virtual void message(std::string&& s) final override { m_output += s; }
+    virtual void luaMessage(const std::string& s, bool error) final override {}
+    virtual void update(bool vsync = false) final override {}
+    virtual void close() final override {}
+    virtual void purgeAllEvents() final override {}
+    virtual void testQuit(int code) final override {}
+
+  public:
+    std::string m_output;
+};
+
+std::vector<uint8_t> load(const std::filesystem::path& path) {
+    PCSX::IO<PCSX::File> file(new PCSX::PosixFile(path));
+    std::vector<uint8_t> data;
+    if (file->failed()) return data;
+    data.resize(file->size());
+    file->readAt(data.data(), data.size(), 0);
+    return data;
+}
+
+uint64_t get48(const uint8_t* p) {
+    uint64_t ret = 0;
+    for (unsigned i = 0; i < 6; i++) ret = (ret << 8) | p[i];
+    return ret;
+}
+
+class CHD : public testing::Test {
+  protected:
+    void SetUp() override {
+        m_oldSystem = PCSX::g_system;
+        PCSX::g_system = &m_system;
+        m_chd = load("tests/support/chd/fixture.chd");
+        m_bin = load("tests/support/chd/fixture.bin");
+        ASSERT_FALSE(m_chd.empty());
+        ASSERT_FALSE(m_bin.empty());
+    }
+    void TearDown() override { PCSX::g_system = m_oldSystem; }
+
+    PCSX::IO<PCSX::ChdFile> open(std::vector<uint8_t>& data, size_t size) {
+        return new PCSX::ChdFile(new PCSX::BufferFile(data.data(), size));
+    }
+    // The compressed hunks start at the offset stored in the map's header.
+    size_t firstHunkOffset() {
+        size_t mapOffset = 0;
+        for (unsigned i = 0; i < 8; i++) mapOffset = (mapOffset << 8) | m_chd[40 + i];
+        return get48(m_chd.data() + mapOffset + 4);
+    }
+
+    TestSystem m_system;
+    PCSX::System* m_oldSystem = nullptr;
+    std::vector<uint8_t> m_chd;
+    std::vector<uint8_t> m_bin;
+};
+
+}  // namespace
+
+TEST_F(CHD, Tracks) {
+    auto chd = open(m_chd, m_chd.size());
+    ASSERT_FALSE(chd->failed());
+    auto& tracks = chd->tracks();
+    ASSERT_EQ(tracks.size(), 2u);
+    EXPECT_EQ(tracks[0].type, PCSX::ChdFile::Track::Type::MODE1);
+    EXPECT_EQ(tracks[0].start, 0u);
+    EXPECT_EQ(tracks[0].length, 8u);
+    EXPECT_EQ(tracks[1].type, PCSX::ChdFile::Track::Type::AUDIO);
+    EXPECT_EQ(tracks[1].start, 10u);
+    EXPECT_EQ(tracks[1].pregap, 2u);
+    EXPECT_EQ(tracks[1].length, 6u);
+}
+
+TEST_F(CHD, ReadsLikeTheRawImage) {
+    auto chd = open(m_chd, m_chd.size());
+    ASSERT_FALSE(chd->failed());
+    ASSERT_EQ(chd->size(), m_bin.size());
+
+    std::vector<uint8_t> data(m_bin.size());
+    ASSERT_EQ(chd->readAt(data.data(), data.size(), 0), ssize_t(data.size()));
+    EXPECT_EQ(data, m_bin);
+
+    // Backwards, one sector at a time, so that each one comes out of the cache or a fresh decode.
+    constexpr size_t sectorSize = 2352;
+    for (size_t sector = m_bin.size() / sectorSize; sector-- > 0;) {
+        uint8_t buffer[sectorSize];
+        ASSERT_EQ(chd->readAt(buffer, sectorSize, sector * sectorSize), ssize_t(sectorSize));
+        EXPECT_EQ(memcmp(buffer, m_bin.data() + sector * sectorSize, sectorSize), 0) << "sector " << sector;
+    }
+
+    // Unaligned, straddling the boundary between the cdzl and the cdfl hunks.
+    std::vector<uint8_t> straddle(sectorSize * 2);
+    size_t offset = sectorSize * 7 + 100;
+    ASSERT_EQ(chd->readAt(straddle.data(), straddle.size(), offset), ssize_t(straddle.size()));
+    EXPECT_EQ(memcmp(straddle.data(), m_bin.data() + offset, straddle.size()), 0);
+
+    // Through the file pointer.
+    chd->rSeek(sectorSize * 3, SEEK_SET);
+    uint8_t buffer[16];
+    ASSERT_EQ(chd->read(buffer, sizeof(buffer)), ssize_t(sizeof(buffer)));
+    EXPECT_EQ(memcmp(buffer, m_bin.data() + sectorSize * 3, sizeof(buffer)), 0);
+    EXPECT_EQ(chd->rTell(), ssize_t(sectorSize * 3 + sizeof(buffer)));
+}
+
+TEST_F(CHD, HunkCRCMismatch) {
+    // Clearing the first frame's bit in the cdlz hunk's ECC map leaves its sync and
+    // parity zeroed instead of regenerated: the hunk decompresses fine, but its CRC won't match.
+    m_chd[firstHunkOffset()] &= ~1;
+    auto chd = open(m_chd, m_chd.size());
+    ASSERT_FALSE(chd->failed());
+
+    constexpr size_t sectorSize = 2352;
+    uint8_t buffer[sectorSize];
+    EXPECT_EQ(chd->readAt(buffer, sectorSize, 0), -1);
+    EXPECT_NE(m_system.m_output.find("CHD hunk 0 is corrupted"), std::string::npos);
+
+    // The other hunks aren't affected.
+    ASSERT_EQ(chd->readAt(buffer, sectorSize, sectorSize * 4), ssize_t(sectorSize));
+    EXPECT_EQ(memcmp(buffer, m_bin.data() + sectorSize * 4, sectorSize), 0);
+
+    // A read spanning the corrupted hunk stops short, or fails if nothing could be read.
+    std::vector<uint8_t> data(sectorSize * 8);
+    EXPECT_EQ(chd->readAt(data.data(), data.size(), 0), -1);
+}
+
+TEST_F(CHD, Truncated) {
+    for (size_t size : {size_t(0), size_t(64), size_t(200), firstHunkOffset() + 1000, m_chd.size() - 1}) {
+        auto chd = open(m_chd, size);
+        EXPECT_TRUE(chd->failed()) << "truncated to " << size << " bytes";
+        uint8_t buffer[16];
+        EXPECT_EQ(chd->readAt(buffer, sizeof(buffer), 0), -1);
+    }
+}
@@ -0,0 +1,273 @@
+#!/usr/bin/env python3
+# Generates the CHD v5 fixture used by tests/support/chd.cc, along with
+# the raw image it has to read back as.
+#
+# The layout follows what chdman's createcd writes: 2448 bytes units (a
+# sector followed by its subcode), tracks padded to 4 frames, a Huffman
+# coded map, and CHT2 track metadata. The hunks are kept to 4 frames so
+# the small image still goes through all three CD codecs:
+#   hunk 0: track 1, mode 1 data, cdlz
+#   hunk 1: track 1, mode 1 data, cdzl
+#   hunk 2: track 2, audio, cdfl
+#   hunk 3: track 2, audio, cdfl
+#
+# Usage: make-fixture.py <output directory>
+
+import hashlib
+import lzma
+import math
+import os
+import struct
+import sys
+import zlib
+
+SECTOR_SIZE = 2352
+SUBCODE_SIZE = 96
+FRAME_SIZE = SECTOR_SIZE + SUBCODE_SIZE
+FRAMES_PER_HUNK = 4
+HUNK_BYTES = FRAME_SIZE * FRAMES_PER_HUNK
+
+DATA_FRAMES = 8
+AUDIO_FRAMES = 8
+AUDIO_PREGAP = 2
+
+SYNC = bytes([0x00] + [0xff] * 10 + [0x00])
+
+
+def crc16(data, crc=0xffff):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xffff
+    return crc
+
+
+def edc(data):
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xd8018001 if crc & 1 else crc >> 1
+    return crc
+
+
+ECC_F = [((i << 1) ^ (0x11d if i & 0x80 else 0)) & 0xff for i in range(256)]
+ECC_B = [0] * 256
+for i in range(256):
+    ECC_B[i ^ ECC_F[i]] = i
+
+
+def ecc_block(sector, major_count, minor_count, major_mult, minor_inc, dest):
+    size = major_count * minor_count
+    for major in range(major_count):
+        index = (major >> 1) * major_mult + (major & 1)
+        ecc_a = 0
+        ecc_b = 0
+        for _ in range(minor_count):
+            temp = sector[0xc + index]
+            index += minor_inc
+            if index >= size:
+                index -= size
+            ecc_a ^= temp
+            ecc_b ^= temp
+            ecc_a = ECC_F[ecc_a]
+        ecc_a = ECC_B[ECC_F[ecc_a] ^ ecc_b]
+        sector[dest + major] = ecc_a
+        sector[dest + major + major_count] = ecc_a ^ ecc_b
+
+
+def bcd(value):
+    return ((value // 10) << 4) | (value % 10)
+
+
+def mode1_sector(lba):
+    sector = bytearray(SECTOR_SIZE)
+    sector[0:12] = SYNC
+    msf = lba + 150
+    sector[12:16] = bytes([bcd(msf // 4500), bcd(msf // 75 % 60), bcd(msf % 75), 1])
+    text = b'PCSX-Redux CHD fixture, sector %d. ' % lba
+    sector[16:16 + 2048] = (text * (2048 // len(text) + 1))[:2048]
+    sector[0x810:0x814] = struct.pack('<I', edc(sector[0:0x810]))
+    ecc_block(sector, 86, 24, 2, 86, 0x81c)
+    ecc_block(sector, 52, 43, 86, 88, 0x8c8)
+    return bytes(sector)
+
+
+def audio_sector(frame):
+    # A couple of tones, stored big endian as CHDs do.
+    samples = []
+    for i in range(SECTOR_SIZE // 4):
+        t = frame * (SECTOR_SIZE // 4) + i
+        samples.append(int(8000 * math.sin(t * 2 * math.pi * 440 / 44100)))
+        samples.append(int(6000 * math.sin(t * 2 * math.pi * 660 / 44100)))
+    return struct.pack('>%dh' % len(samples), *samples)
+
+
+class BitWriter:
+    def __init__(self):
+        self.data = bytearray()
+        self.accumulator = 0
+        self.bits = 0
+
+    def write(self, value, bits):
+        for shift in range(bits - 1, -1, -1):
+            self.accumulator = (self.accumulator << 1) | ((value >> shift) & 1)
+            self.bits += 1
+            if self.bits == 8:
+                self.data.append(self.accumulator)
+                self.accumulator = 0
+                self.bits = 0
+
+    def flush(self):
+        if self.bits:
+            self.write(0, 8 - self.bits)
+        return bytes(self.data)
+
+
+def deflate(data):
+    compressor = zlib.compressobj(9, zlib.DEFLATED, -15)
+    return compressor.compress(data) + compressor.flush()
+
+
+def flac_crc8(data):
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xff if crc & 0x80 else (crc << 1) & 0xff
+    return crc
+
+
+def flac_crc16(data):
+    crc = 0
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x8005) & 0xffff if crc & 0x8000 else (crc << 1) & 0xffff
+    return crc
+
+
+def flac_frame(left, right, number):
+    # One frame of independent stereo, with verbatim subframes.
+    bits = BitWriter()
+    bits.write(0xfff8, 16)
+    bits.write(7, 4)  # 16 bits block size at the end of the header
+    bits.write(9, 4)  # 44.1kHz
+    bits.write(1, 4)  # left/right
+    bits.write(4, 3)  # 16 bits samples
+    bits.write(0, 1)
+    bits.write(number, 8)
+    bits.write(len(left) - 1, 16)
+    header = bits.flush()
+    bits = BitWriter()
+    for channel in (left, right):
+        bits.write(0, 1)
+        bits.write(1, 6)
+        bits.write(0, 1)
+        for sample in channel:
+            bits.write(sample & 0xffff, 16)
+    frame = header + bytes([flac_crc8(header)]) + bits.flush()
+    return frame + struct.pack('>H', flac_crc16(frame))
+
+
+def compress_cd(codec, hunk):
+    sectors = bytearray()
+    subcode = bytearray()
+    ecc = bytearray((FRAMES_PER_HUNK + 7) // 8)
+    for frame in range(FRAMES_PER_HUNK):
+        sector = bytearray(hunk[frame * FRAME_SIZE:frame * FRAME_SIZE + SECTOR_SIZE])
+        subcode += hunk[frame * FRAME_SIZE + SECTOR_SIZE:(frame + 1) * FRAME_SIZE]
+        if codec != b'cdfl' and sector[0:12] == SYNC:
+            # The sync and the parity are regenerated on decompression.
+            ecc[frame // 8] |= 1 << (frame % 8)
+            sector[0:12] = bytes(12)
+            sector[0x81c:0x930] = bytes(0x930 - 0x81c)
+        sectors += sector
+    if codec == b'cdfl':
+        samples = struct.unpack('>%dh' % (len(sectors) // 2), sectors)
+        return flac_frame(samples[0::2], samples[1::2], 0) + deflate(bytes(subcode))
+    if codec == b'cdlz':
+        filters = [{'id': lzma.FILTER_LZMA1, 'dict_size': 1 << 16, 'lc': 3, 'lp': 0, 'pb': 2}]
+        base = lzma.compress(bytes(sectors), format=lzma.FORMAT_RAW, filters=filters)
+    else:
+        base = deflate(bytes(sectors))
+    return bytes(ecc) + struct.pack('>H', len(base)) + base + deflate(bytes(subcode))
+
+
+def metadata_entry(tag, text, next_offset):
+    data = text.encode() + b'\0'
+    return tag + bytes([0x01]) + struct.pack('>I', len(data))[1:] + struct.pack('>Q', next_offset) + data
+
+
+def main():
+    out = sys.argv[1] if len(sys.argv) > 1 else '.'
+
+    data = [mode1_sector(lba) for lba in range(DATA_FRAMES)]
+    audio = [audio_sector(frame) for frame in range(AUDIO_FRAMES)]
+    frames = [sector + bytes(SUBCODE_SIZE) for sector in data + audio]
+    raw = b''.join(frames)
+
+    # The flat image presents audio little endian.
+    with open(os.path.join(out, 'fixture.bin'), 'wb') as f:
+        f.write(b''.join(data))
+        for sector in audio:
+            f.write(b''.join(sector[i + 1:i + 2] + sector[i:i + 1] for i in range(0, SECTOR_SIZE, 2)))
+
+    codecs = [b'cdlz', b'cdzl', b'cdfl', b'\0\0\0\0']
+    hunk_codecs = [0, 1, 2, 2]
+    hunks = [raw[i * HUNK_BYTES:(i + 1) * HUNK_BYTES] for i in range(len(hunk_codecs))]
+    compressed = [compress_cd(codecs[codec], hunk) for codec, hunk in zip(hunk_codecs, hunks)]
+
+    tracks = [
+        'TRACK:1 TYPE:MODE1_RAW SUBTYPE:NONE FRAMES:%d PREGAP:0 PGTYPE:MODE1 PGSUB:RW POSTGAP:0' % DATA_FRAMES,
+        'TRACK:2 TYPE:AUDIO SUBTYPE:NONE FRAMES:%d PREGAP:%d PGTYPE:VAUDIO PGSUB:RW POSTGAP:0' % (AUDIO_FRAMES,
+                                                                                                  AUDIO_PREGAP),
+    ]
+    header_size = 124
+    meta = b''
+    offset = header_size
+    for i, track in enumerate(tracks):
+        entry_size = 16 + len(track) + 1
+        next_offset = offset + entry_size if i + 1 < len(tracks) else 0
+        meta += metadata_entry(b'CHT2', track, next_offset)
+        offset += entry_size
+
+    # The map: every hunk type gets a 4 bits code, then the lengths and CRCs.
+    length_bits = max(len(c) for c in compressed).bit_length()
+    first_offset = header_size + len(meta)
+    bits = BitWriter()
+    bits.write(1, 4)
+    bits.write(4, 4)
+    bits.write(13, 4)
+    for codec in hunk_codecs:
+        bits.write(codec, 4)
+    map_crc = 0xffff
+    offset = first_offset
+    for codec, hunk, data in zip(hunk_codecs, hunks, compressed):
+        crc = crc16(hunk)
+        bits.write(len(data), length_bits)
+        bits.write(crc, 16)
+        entry = bytes([codec]) + struct.pack('>I', len(data))[1:] + struct.pack('>Q', offset)[2:] + struct.pack(
+            '>H', crc)
+        map_crc = crc16(entry, map_crc)
+        offset += len(data)
+    map_data = bits.flush()
+    map_offset = offset
+    map_header = struct.pack('>I', len(map_data)) + struct.pack('>Q', first_offset)[2:] + struct.pack(
+        '>H', map_crc) + bytes([length_bits, 0, 0, 0])
+
+    raw_sha1 = hashlib.sha1(raw).digest()
+    meta_hashes = sorted(b'CHT2' + hashlib.sha1(track.encode() + b'\0').digest() for track in tracks)
+    sha1 = hashlib.sha1(raw_sha1 + b''.join(meta_hashes)).digest()
+
+    header = b'MComprHD' + struct.pack('>II', header_size, 5) + b''.join(codecs)
+    header += struct.pack('>QQQII', len(raw), map_offset, header_size, HUNK_BYTES, FRAME_SIZE)
+    header += raw_sha1 + sha1 + bytes(20)
+
+    with open(os.path.join(out, 'fixture.chd'), 'wb') as f:
+        f.write(header + meta + b''.join(compressed) + map_header + map_data)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,96 @@
+/***************************************************************************
+ *   Copyright (C) 2024 PCSX-Redux authors                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#include "support/eventbus.h"
+
+#include <memory>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+struct Ping {
+    int value;
+};
+
+struct Pong {
+    int value;
+};
+
+}  // namespace
+
+TEST(EventBus, SignalsOnlyMatchingListeners) {
+    auto bus = std::make_shared<PCSX::EventBus::EventBus>();
+    PCSX::EventBus::Listener listener(bus);
+    int pings = 0, pongs = 0;
+    listener.listen<Ping>([&pings](const Ping& event) { pings += event.value; });
+    listener.listen<Pong>([&pongs](const Pong& event) { pongs += event.value; });
+    bus->signal(Ping{2});
+    bus->signal(Ping{3});
+    bus->signal(Pong{7});
+    EXPECT_EQ(pings, 5);
+    EXPECT_EQ(pongs, 7);
+}
+
+TEST(EventBus, ListenerDestructionUnregisters) {
+    auto bus = std::make_shared<PCSX::EventBus::EventBus>();
+    int count = 0;
+    {
+        PCSX::EventBus::Listener listener(bus);
+        listener.listen<Ping>([&count](const Ping&) { count++; });
+        bus->signal(Ping{});
+    }
+    bus->signal(Ping{});
+    EXPECT_EQ(count, 1);
+}
+
+TEST(EventBus, RemovalFromWithinCallback) {
+    auto bus = std::make_shared<PCSX::EventBus::EventBus>();
+    auto first = std::make_unique<PCSX::EventBus::Listener>(bus);
+    PCSX::EventBus::Listener second(bus);
+    int firstCount = 0, secondCount = 0;
+    first->listen<Ping>([&](const Ping&) {
+        firstCount++;
+        first.reset();
+    });
+    second.listen<Ping>([&](const Ping&) { secondCount++; });
+    bus->signal(Ping{});
+    bus->signal(Ping{});
+    EXPECT_EQ(firstCount, 1);
+    EXPECT_EQ(secondCount, 2);
+}
+
+TEST(EventBus, PostedEventsDeliveredOnFlush) {
+    auto bus = std::make_shared<PCSX::EventBus::EventBus>();
+    PCSX::EventBus::Listener listener(bus);
+    int sum = 0;
+    listener.listen<Ping>([&sum](const Ping& event) { sum = sum * 10 + event.value; });
+    std::thread thread([&bus]() {
+        bus->post(Ping{1});
+        Ping ping{2};
+        bus->post(ping);
+    });
+    thread.join();
+    EXPECT_EQ(sum, 0);
+    bus->flush();
+    EXPECT_EQ(sum, 12);
+    bus->flush();
+    EXPECT_EQ(sum, 12);
+}
@@ -0,0 +1,50 @@
+/***************************************************************************
+ *   Copyright (C) 2024 PCSX-Redux authors                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#include "support/flac-decoder.h"
+
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+// A single FLAC frame of 256 stereo samples, holding two linear ramps.
+static const uint8_t s_frame[] = {
+    0xff, 0xf8, 0x89, 0x18, 0x00, 0x44, 0x15, 0x73, 0x80, 0xce, 0x64, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfc, 0x56, 0x02, 0x58, 0x03, 0xe8, 0x01, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf8, 0x50, 0xba,
+};
+
+TEST(FLACDecoder, Basic) {
+    int16_t samples[512];
+    EXPECT_EQ(PCSX::FLAC::decode(s_frame, sizeof(s_frame), samples, 256), ssize_t(sizeof(s_frame)));
+    for (int i = 0; i < 256; i++) {
+        EXPECT_EQ(samples[i * 2 + 0], i * 100 - 12800);
+        EXPECT_EQ(samples[i * 2 + 1], -i * 50 + 300);
+    }
+}
+
+TEST(FLACDecoder, Corrupted) {
+    uint8_t frame[sizeof(s_frame)];
+    memcpy(frame, s_frame, sizeof(frame));
+    frame[20] ^= 0x10;
+    int16_t samples[512];
+    EXPECT_EQ(PCSX::FLAC::decode(frame, sizeof(frame), samples, 256), -1);
+}
@@ -0,0 +1,94 @@
+/***************************************************************************
+ *   Copyright (C) 2024 PCSX-Redux authors                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#include "supportpsx/iec-60908b.h"
+
+#include <string.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "iec-60908b/edcecc.h"
+
+static std::vector<uint8_t> makeSectors(size_t count, unsigned seed) {
+    std::vector<uint8_t> sectors(count * PCSX::IEC60908b::FRAMESIZE_RAW);
+    std::mt19937 rng(seed);
+    for (auto& b : sectors) b = rng();
+    for (size_t i = 0; i < count; i++) {
+        uint8_t* sector = sectors.data() + i * PCSX::IEC60908b::FRAMESIZE_RAW;
+        static const uint8_t sync[12] = {0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00};
+        memcpy(sector, sync, sizeof(sync));
+        PCSX::IEC60908b::MSF(i + 150).toBCD(sector + 12);
+        sector[15] = 2;
+        // Alternate between form 1 and form 2 sectors.
+        sector[18] = sector[22] = (i % 3) == 0 ? 0x20 : 0x08;
+    }
+    return sectors;
+}
+
+TEST(IEC60908b, MatchesReference) {
+    auto sectors = makeSectors(64, 1);
+    auto reference = sectors;
+    for (size_t i = 0; i < 64; i++) {
+        PCSX::IEC60908b::computeEDCECC(sectors.data() + i * PCSX::IEC60908b::FRAMESIZE_RAW);
+        compute_edcecc(reference.data() + i * PCSX::IEC60908b::FRAMESIZE_RAW);
+    }
+    EXPECT_EQ(sectors, reference);
+}
+
+TEST(IEC60908b, EDCChaining) {
+    auto data = makeSectors(1, 2);
+    uint32_t whole = PCSX::IEC60908b::computeEDC(data.data(), 2331);
+    uint32_t chained = PCSX::IEC60908b::computeEDC(data.data(), 1000);
+    chained = PCSX::IEC60908b::computeEDC(data.data() + 1000, 1331, chained);
+    EXPECT_EQ(whole, chained);
+}
+
+TEST(IEC60908b, BatchMatchesSingle) {
+    auto sectors = makeSectors(2000, 3);
+    auto reference = sectors;
+    PCSX::IEC60908b::computeEDCECC(sectors.data(), 2000);
+    for (size_t i = 0; i < 2000; i++) {
+        PCSX::IEC60908b::computeEDCECC(reference.data() + i * PCSX::IEC60908b::FRAMESIZE_RAW);
+    }
+    EXPECT_EQ(sectors, reference);
+}
+
+TEST(IEC60908b, Throughput) {
+    static constexpr size_t c_count = 8192;
+    auto sectors = makeSectors(c_count, 4);
+    auto measure = [&](auto&& fn) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return double(c_count * PCSX::IEC60908b::FRAMESIZE_RAW) / elapsed.count() / (1024.0 * 1024.0);
+    };
+    double reference = measure([&]() {
+        for (size_t i = 0; i < c_count; i++) compute_edcecc(sectors.data() + i * PCSX::IEC60908b::FRAMESIZE_RAW);
+    });
+    double single = measure([&]() {
+        for (size_t i = 0; i < c_count; i++) {
+            PCSX::IEC60908b::computeEDCECC(sectors.data() + i * PCSX::IEC60908b::FRAMESIZE_RAW);
+        }
+    });
+    double batch = measure([&]() { PCSX::IEC60908b::computeEDCECC(sectors.data(), c_count); });
+    printf("EDC/ECC throughput: reference %.1f MB/s, sliced %.1f MB/s, batch %.1f MB/s\n", reference, single, batch);
+}
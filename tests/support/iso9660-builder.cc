@@ -0,0 +1,145 @@
+/***************************************************************************
+ *   Copyright (C) 2024 PCSX-Redux authors                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#include "cdrom/iso9660-builder.h"
+
+#include <string.h>
+
+#include <filesystem>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "support/mmapfile.h"
+
+namespace {
+
+struct Source {
+    Source(size_t size, unsigned seed) : data(size) {
+        std::mt19937 rng(seed);
+        for (auto& b : data) b = rng();
+    }
+    PCSX::IO<PCSX::File> file() { return new PCSX::BufferFile(data.data(), data.size()); }
+    std::vector<uint8_t> data;
+};
+
+// Writes a small disc with a data file, an interleaved stream and a CDDA track.
+template <typename Write>
+void buildDisc(PCSX::ISO9660Builder& builder, Source& data, Source& form2, Source& audio, Write write) {
+    using PCSX::SectorMode;
+    write(builder, data, 0, 600, SectorMode::M2_FORM1);
+    for (unsigned i = 0; i < 50; i++) {
+        write(builder, data, 600 + i * 2, 1, SectorMode::M2_FORM1);
+        write(builder, form2, 601 + i * 2, 1, SectorMode::M2_FORM2);
+    }
+    write(builder, audio, 700, 300, SectorMode::RAW);
+}
+
+size_t payloadSize(PCSX::SectorMode mode) {
+    switch (mode) {
+        case PCSX::SectorMode::RAW:
+            return 2352;
+        case PCSX::SectorMode::M2_FORM2:
+            return 2324;
+        default:
+            return 2048;
+    }
+}
+
+std::vector<uint8_t> buildReference(Source& data, Source& form2, Source& audio) {
+    PCSX::IO<PCSX::File> out = new PCSX::BufferFile(PCSX::FileOps::READWRITE);
+    PCSX::ISO9660Builder builder(out);
+    // Each source is consumed sequentially by the extents using it.
+    size_t offsets[3] = {0, 0, 0};
+    buildDisc(builder, data, form2, audio, [&](auto& builder, Source& source, uint32_t lba, uint32_t count, auto mode) {
+        size_t& offset = offsets[&source == &data ? 0 : &source == &form2 ? 1 : 2];
+        size_t size = payloadSize(mode);
+        for (uint32_t i = 0; i < count; i++) {
+            builder.writeSectorAt(source.data.data() + offset, PCSX::IEC60908b::MSF(lba + i + 150), mode);
+            offset += size;
+        }
+    });
+    auto slice = out.asA<PCSX::BufferFile>()->borrow();
+    return std::vector<uint8_t>(slice.data<uint8_t>(), slice.data<uint8_t>() + slice.size());
+}
+
+void buildLayout(PCSX::ISO9660Builder& builder, Source& data, Source& form2, Source& audio) {
+    size_t offsets[3] = {0, 0, 0};
+    buildDisc(builder, data, form2, audio, [&](auto& builder, Source& source, uint32_t lba, uint32_t count, auto mode) {
+        size_t& offset = offsets[&source == &data ? 0 : &source == &form2 ? 1 : 2];
+        builder.addExtent(source.file(), PCSX::IEC60908b::MSF(lba + 150), count, mode, offset);
+        offset += payloadSize(mode) * count;
+    });
+    builder.writeLayout();
+}
+
+// Same disc, with the interleaved stream as one strided extent per channel.
+void buildStridedLayout(PCSX::ISO9660Builder& builder, Source& data, Source& form2, Source& audio) {
+    using PCSX::SectorMode;
+    builder.addExtent(data.file(), PCSX::IEC60908b::MSF(0 + 150), 600, SectorMode::M2_FORM1);
+    builder.addExtent(data.file(), PCSX::IEC60908b::MSF(600 + 150), 50, SectorMode::M2_FORM1, 600 * 2048, 2);
+    builder.addExtent(form2.file(), PCSX::IEC60908b::MSF(601 + 150), 50, SectorMode::M2_FORM2, 0, 2);
+    builder.addExtent(audio.file(), PCSX::IEC60908b::MSF(700 + 150), 0, SectorMode::RAW);
+    builder.writeLayout();
+}
+
+}  // namespace
+
+TEST(ISO9660Builder, LayoutMatchesSectorWrites) {
+    Source data(650 * 2048, 1), form2(50 * 2324, 2), audio(300 * 2352, 3);
+    auto reference = buildReference(data, form2, audio);
+    ASSERT_EQ(reference.size(), 1000 * 2352);
+    // Form 2 sectors keep their whole payload.
+    EXPECT_EQ(memcmp(reference.data() + 601 * 2352 + 24, form2.data.data(), 2324), 0);
+
+    PCSX::IO<PCSX::File> out = new PCSX::BufferFile(PCSX::FileOps::READWRITE);
+    PCSX::ISO9660Builder builder(out);
+    buildLayout(builder, data, form2, audio);
+    EXPECT_EQ(builder.getCurrentLocation(), PCSX::IEC60908b::MSF(1000 + 150));
+    auto slice = out.asA<PCSX::BufferFile>()->borrow();
+    ASSERT_EQ(slice.size(), reference.size());
+    EXPECT_EQ(memcmp(slice.data(), reference.data(), reference.size()), 0);
+}
+
+TEST(ISO9660Builder, StridedLayoutMatchesSectorWrites) {
+    Source data(650 * 2048, 7), form2(50 * 2324, 8), audio(300 * 2352, 9);
+    auto reference = buildReference(data, form2, audio);
+
+    PCSX::IO<PCSX::File> out = new PCSX::BufferFile(PCSX::FileOps::READWRITE);
+    PCSX::ISO9660Builder builder(out);
+    buildStridedLayout(builder, data, form2, audio);
+    EXPECT_EQ(builder.getCurrentLocation(), PCSX::IEC60908b::MSF(1000 + 150));
+    auto slice = out.asA<PCSX::BufferFile>()->borrow();
+    ASSERT_EQ(slice.size(), reference.size());
+    EXPECT_EQ(memcmp(slice.data(), reference.data(), reference.size()), 0);
+}
+
+TEST(ISO9660Builder, LayoutIntoMmapFile) {
+    Source data(650 * 2048, 4), form2(50 * 2324, 5), audio(300 * 2352, 6);
+    auto reference = buildReference(data, form2, audio);
+
+    auto path = std::filesystem::temp_directory_path() / "pcsx-iso9660-builder-test.bin";
+    PCSX::IO<PCSX::MmapFile> out = new PCSX::MmapFile(path, PCSX::FileOps::CREATE, reference.size());
+    ASSERT_FALSE(out->failed());
+    PCSX::ISO9660Builder builder(out);
+    buildLayout(builder, data, form2, audio);
+    EXPECT_EQ(memcmp(out->data(), reference.data(), reference.size()), 0);
+    builder.close();
+    std::filesystem::remove(path);
+}
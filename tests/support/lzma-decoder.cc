@@ -0,0 +1,48 @@
+/***************************************************************************
+ *   Copyright (C) 2024 PCSX-Redux authors                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#include "support/lzma-decoder.h"
+
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+// "The quick brown fox jumps over the lazy dog. " eight times, as a raw
+// LZMA1 stream using the default lc=3, lp=0, pb=2 properties.
+static const uint8_t s_compressed[] = {
+    0x00, 0x2a, 0x1a, 0x08, 0xa2, 0x03, 0x25, 0x66, 0xf1, 0x4b, 0x78, 0xc5, 0xa2, 0x05, 0xff, 0x2e, 0xe6, 0xd9, 0xd2, 0x20,
+    0x1a, 0xad, 0x34, 0xf8, 0xe2, 0x1d, 0xe8, 0x41, 0x36, 0xfa, 0xdc, 0x06, 0x69, 0xbb, 0x3c, 0xe4, 0x10, 0x34, 0x27, 0x09,
+    0xeb, 0xb3, 0x66, 0xe3, 0xed, 0x37, 0x98, 0xed, 0x92, 0x5f, 0x6b, 0x27, 0x32, 0x3f, 0xff, 0xe9, 0xac, 0x60, 0x00,
+};
+
+TEST(LZMADecoder, Basic) {
+    std::string expected;
+    for (unsigned i = 0; i < 8; i++) expected += "The quick brown fox jumps over the lazy dog. ";
+    std::string decoded(expected.size(), '\0');
+    auto consumed = PCSX::LZMA::decode(s_compressed, sizeof(s_compressed),
+                                       reinterpret_cast<uint8_t*>(decoded.data()), decoded.size());
+    EXPECT_GT(consumed, 0);
+    EXPECT_LE(size_t(consumed), sizeof(s_compressed));
+    EXPECT_EQ(decoded, expected);
+}
+
+TEST(LZMADecoder, Truncated) {
+    uint8_t decoded[360];
+    EXPECT_EQ(PCSX::LZMA::decode(s_compressed, 20, decoded, sizeof(decoded)), -1);
+}
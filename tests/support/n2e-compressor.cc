@@ -0,0 +1,155 @@
+/***************************************************************************
+ *   Copyright (C) 2024 PCSX-Redux authors                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#include "supportpsx/n2e-compressor.h"
+
+#include <stdint.h>
+
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+// A straight port of n2e-d.S, so the streams are checked against the exact
+// decoder they're meant for. The source and destination may overlap.
+size_t decompress(const uint8_t* src, uint8_t* dst) {
+    uint32_t bb = 0;
+    auto getbit = [&]() -> uint32_t {
+        if ((bb & 0xff0000) == 0) bb = *src++ | 0xff0000;
+        uint32_t bit = (bb >> 7) & 1;
+        bb <<= 1;
+        return bit;
+    };
+    uint8_t* start = dst;
+    uint32_t lastOff = 1;
+    for (;;) {
+        while (getbit()) *dst++ = *src++;
+        uint32_t off = 1;
+        for (;;) {
+            off = off * 2 + getbit();
+            if (getbit()) break;
+            off = (off - 1) * 2 + getbit();
+        }
+        uint32_t len;
+        if (off == 2) {
+            off = lastOff;
+            len = getbit();
+        } else {
+            off = (off - 3) * 256 + *src++;
+            if (off == 0xffffffff) break;
+            len = (off ^ 0xffffffff) & 1;
+            off >>= 1;
+            lastOff = ++off;
+        }
+        if (len) {
+            len = 1 + getbit();
+        } else if (getbit()) {
+            len = 3 + getbit();
+        } else {
+            len++;
+            do {
+                len = len * 2 + getbit();
+            } while (!getbit());
+            len += 3;
+        }
+        len += (off > 0x500);
+        const uint8_t* pos = dst - off;
+        *dst++ = *pos++;
+        do {
+            *dst++ = *pos++;
+        } while (--len > 0);
+    }
+    return dst - start;
+}
+
+std::vector<uint8_t> makeData(size_t size) {
+    // Something vaguely looking like code: repeated instruction patterns with
+    // random immediates, some runs of zeroes, and a bit of noise.
+    std::mt19937 gen(1234);
+    std::vector<uint8_t> data;
+    std::vector<uint32_t> patterns;
+    for (unsigned i = 0; i < 64; i++) patterns.push_back(gen());
+    while (data.size() < size) {
+        switch (gen() % 8) {
+            case 0:
+                data.insert(data.end(), gen() % 512, 0);
+                break;
+            case 1:
+                for (unsigned i = gen() % 32; i > 0; i--) data.push_back(gen());
+                break;
+            default:
+                for (unsigned i = gen() % 16; i > 0; i--) {
+                    uint32_t word = (patterns[gen() % patterns.size()] & 0xffff0000) | (gen() % 64);
+                    for (unsigned b = 0; b < 4; b++) data.push_back(word >> (b * 8));
+                }
+                break;
+        }
+    }
+    data.resize(size);
+    return data;
+}
+
+void checkRoundTrip(const std::vector<uint8_t>& data, unsigned threads) {
+    uint32_t overlap;
+    auto compressed = PCSX::N2E::compress(data.data(), data.size(), threads, &overlap);
+    std::vector<uint8_t> decompressed(data.size() + 16);
+    EXPECT_EQ(decompress(compressed.data(), decompressed.data()), data.size());
+    decompressed.resize(data.size());
+    EXPECT_EQ(decompressed, data);
+
+    // In place, with the compressed stream ending exactly `overlap` bytes past
+    // the end of the decompressed data.
+    std::vector<uint8_t> buffer(std::max(data.size() + overlap, compressed.size()));
+    size_t offset = buffer.size() - compressed.size();
+    std::copy(compressed.begin(), compressed.end(), buffer.begin() + offset);
+    EXPECT_EQ(decompress(buffer.data() + offset, buffer.data()), data.size());
+    buffer.resize(data.size());
+    EXPECT_EQ(buffer, data);
+}
+
+}  // namespace
+
+TEST(N2ECompressor, Empty) { checkRoundTrip({}, 1); }
+
+TEST(N2ECompressor, Tiny) {
+    checkRoundTrip({42}, 1);
+    checkRoundTrip({1, 2, 1, 2, 1, 2, 1}, 1);
+}
+
+TEST(N2ECompressor, Zeroes) { checkRoundTrip(std::vector<uint8_t>(300000), 4); }
+
+TEST(N2ECompressor, Random) {
+    std::mt19937 gen(5678);
+    std::vector<uint8_t> data(100000);
+    for (auto& b : data) b = gen();
+    checkRoundTrip(data, 2);
+}
+
+TEST(N2ECompressor, CodeLike) {
+    auto data = makeData(600000);
+    checkRoundTrip(data, 1);
+    checkRoundTrip(data, 8);
+}
+
+TEST(N2ECompressor, ThreadsDontAffectOutput) {
+    auto data = makeData(400000);
+    EXPECT_EQ(PCSX::N2E::compress(data.data(), data.size(), 1), PCSX::N2E::compress(data.data(), data.size(), 6));
+}
@@ -0,0 +1,120 @@
+/***************************************************************************
+ *   Copyright (C) 2024 PCSX-Redux authors                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#include "support/protobuf.h"
+
+#include <string.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "support/typestring-wrapper.h"
+#include "support/zfile.h"
+
+namespace {
+
+typedef PCSX::Protobuf::Field<PCSX::Protobuf::UInt32, TYPESTRING("number"), 1> Number;
+typedef PCSX::Protobuf::Field<PCSX::Protobuf::String, TYPESTRING("name"), 2> Name;
+typedef PCSX::Protobuf::Message<TYPESTRING("Header"), Number, Name> Header;
+typedef PCSX::Protobuf::MessageField<Header, TYPESTRING("header"), 1> HeaderField;
+typedef PCSX::Protobuf::FieldPtr<PCSX::Protobuf::FixedBytes<100000>, TYPESTRING("payload"), 2> Payload;
+typedef PCSX::Protobuf::Field<PCSX::Protobuf::UInt64, TYPESTRING("trailer"), 3> Trailer;
+typedef PCSX::Protobuf::Message<TYPESTRING("Test"), HeaderField, Payload, Trailer> TestMessage;
+
+std::string makeMessage(uint8_t* payload) {
+    for (unsigned i = 0; i < 100000; i++) payload[i] = i * 7;
+    TestMessage test{HeaderField{Number{42}, Name{"hello"}}, Payload{payload}, Trailer{0x123456789abcdefull}};
+    PCSX::Protobuf::OutSlice slice;
+    test.serialize(&slice);
+    return slice.finalize();
+}
+
+}  // namespace
+
+TEST(Protobuf, StreamedMatchesSlice) {
+    std::vector<uint8_t> source(100000);
+    auto data = makeMessage(source.data());
+
+    std::vector<uint8_t> fromSlice(100000, 0xff);
+    TestMessage sliceTest{HeaderField{}, Payload{fromSlice.data()}, Trailer{}};
+    PCSX::Protobuf::InSlice slice(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    sliceTest.deserialize(&slice, 0);
+    // Decoded into a copy, and only written to the destination on commit.
+    EXPECT_EQ(fromSlice[1], 0xff);
+    sliceTest.commit();
+    EXPECT_EQ(fromSlice, source);
+
+    std::vector<uint8_t> fromStream(100000, 0xff);
+    TestMessage streamTest{HeaderField{}, Payload{fromStream.data()}, Trailer{}};
+    PCSX::IO<PCSX::File> file(new PCSX::BufferFile(data.data(), data.size()));
+    PCSX::Protobuf::InSlice stream(file);
+    streamTest.deserialize(&stream, 0);
+    // Decoded in place.
+    EXPECT_EQ(fromStream, source);
+    streamTest.commit();
+    EXPECT_EQ(fromStream, source);
+    EXPECT_EQ(streamTest.get<HeaderField>().get<Number>().value, 42);
+    EXPECT_EQ(streamTest.get<HeaderField>().get<Name>().value, "hello");
+    EXPECT_EQ(streamTest.get<Trailer>().value, 0x123456789abcdefull);
+}
+
+TEST(Protobuf, StreamedSkipsUnknownFields) {
+    std::vector<uint8_t> source(100000);
+    auto data = makeMessage(source.data());
+
+    // Decoding with a message which only knows about the trailer skips everything else.
+    typedef PCSX::Protobuf::Message<TYPESTRING("TrailerOnly"), Trailer> TrailerOnly;
+    TrailerOnly test;
+    PCSX::IO<PCSX::File> file(new PCSX::BufferFile(data.data(), data.size()));
+    PCSX::Protobuf::InSlice stream(file);
+    test.deserialize(&stream, 0);
+    EXPECT_EQ(test.get<Trailer>().value, 0x123456789abcdefull);
+}
+
+TEST(Protobuf, StreamedTruncated) {
+    std::vector<uint8_t> source(100000);
+    auto data = makeMessage(source.data());
+    data.resize(data.size() / 2);
+
+    std::vector<uint8_t> dest(100000);
+    TestMessage test{HeaderField{}, Payload{dest.data()}, Trailer{}};
+    PCSX::IO<PCSX::File> file(new PCSX::BufferFile(data.data(), data.size()));
+    PCSX::Protobuf::InSlice stream(file);
+    EXPECT_THROW(test.deserialize(&stream, 0), PCSX::Protobuf::OutOfBoundError);
+}
+
+TEST(Protobuf, StreamedFromCompressedFile) {
+    std::vector<uint8_t> source(100000);
+    auto data = makeMessage(source.data());
+    PCSX::IO<PCSX::File> compressed(new PCSX::BufferFile(PCSX::FileOps::READWRITE));
+    {
+        PCSX::IO<PCSX::File> writer(new PCSX::ZWriter(compressed, PCSX::ZWriter::GZIP));
+        writer->write(data.data(), data.size());
+        writer->close();
+    }
+    compressed->rSeek(0, SEEK_SET);
+
+    std::vector<uint8_t> dest(100000);
+    TestMessage test{HeaderField{}, Payload{dest.data()}, Trailer{}};
+    PCSX::IO<PCSX::File> reader(new PCSX::ZReader(compressed));
+    PCSX::Protobuf::InSlice stream(reader);
+    test.deserialize(&stream, 0);
+    EXPECT_EQ(dest, source);
+    EXPECT_EQ(test.get<Trailer>().value, 0x123456789abcdefull);
+}
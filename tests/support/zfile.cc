@@ -0,0 +1,150 @@
+/***************************************************************************
+ *   Copyright (C) 2024 PCSX-Redux authors                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.           *
+ ***************************************************************************/
+
+#include "support/zfile.h"
+
+#include <string.h>
+
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::vector<uint8_t> makeData(size_t size) {
+    // Compressible enough to get plenty of deflate blocks, random enough to not be trivial.
+    std::vector<uint8_t> data(size);
+    std::mt19937 rng(42);
+    for (size_t i = 0; i < size; i++) data[i] = (rng() % 16) + (i >> 12);
+    return data;
+}
+
+std::vector<uint8_t> compress(const std::vector<uint8_t>& data, int wbits) {
+    z_stream z = {};
+    deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, wbits, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+    std::vector<uint8_t> out(deflateBound(&z, data.size()));
+    z.next_in = const_cast<Bytef*>(data.data());
+    z.avail_in = data.size();
+    z.next_out = out.data();
+    z.avail_out = out.size();
+    deflate(&z, Z_FINISH);
+    out.resize(z.total_out);
+    deflateEnd(&z);
+    return out;
+}
+
+void checkRandomReads(PCSX::File* reader, const std::vector<uint8_t>& data) {
+    std::mt19937 rng(1234);
+    std::vector<uint8_t> buffer(100000);
+    for (unsigned i = 0; i < 200; i++) {
+        size_t ptr = rng() % data.size();
+        size_t size = rng() % buffer.size() + 1;
+        size_t expected = std::min(size, data.size() - ptr);
+        ASSERT_EQ(reader->readAt(buffer.data(), size, ptr), ssize_t(expected));
+        ASSERT_EQ(memcmp(buffer.data(), data.data() + ptr, expected), 0);
+    }
+}
+
+}  // namespace
+
+TEST(ZIndexedReader, SequentialGZip) {
+    auto data = makeData(4 * 1024 * 1024);
+    auto compressed = compress(data, MAX_WBITS + 16);
+    PCSX::IO<PCSX::File> file(new PCSX::BufferFile(compressed.data(), compressed.size()));
+    PCSX::ZIndexedReader reader(file);
+    reader.setSpan(65536);
+    std::vector<uint8_t> out(data.size());
+    size_t total = 0;
+    while (true) {
+        ssize_t r = reader.read(out.data() + total, std::min(size_t(10000), out.size() - total));
+        if (r <= 0) break;
+        total += r;
+    }
+    EXPECT_EQ(total, data.size());
+    EXPECT_EQ(out, data);
+    EXPECT_EQ(reader.size(), data.size());
+    EXPECT_TRUE(reader.eof());
+    reader.close();
+}
+
+TEST(ZIndexedReader, RandomAccessZlib) {
+    auto data = makeData(4 * 1024 * 1024);
+    auto compressed = compress(data, MAX_WBITS);
+    PCSX::IO<PCSX::File> file(new PCSX::BufferFile(compressed.data(), compressed.size()));
+    PCSX::ZIndexedReader reader(file);
+    reader.setSpan(65536);
+    checkRandomReads(&reader, data);
+    EXPECT_EQ(reader.size(), data.size());
+    reader.close();
+}
+
+TEST(ZIndexedReader, RandomAccessRawWithSize) {
+    auto data = makeData(3 * 1024 * 1024 + 123);
+    auto compressed = compress(data, -MAX_WBITS);
+    PCSX::IO<PCSX::File> file(new PCSX::BufferFile(compressed.data(), compressed.size()));
+    PCSX::ZIndexedReader reader(file, data.size(), PCSX::ZIndexedReader::RAW);
+    reader.setSpan(65536);
+    reader.buildIndex();
+    checkRandomReads(&reader, data);
+    reader.close();
+}
+
+TEST(ZIndexedReader, SavedIndex) {
+    auto data = makeData(4 * 1024 * 1024);
+    auto compressed = compress(data, MAX_WBITS + 16);
+    PCSX::IO<PCSX::File> file(new PCSX::BufferFile(compressed.data(), compressed.size()));
+    PCSX::IO<PCSX::File> index(new PCSX::BufferFile(PCSX::FileOps::READWRITE));
+    {
+        PCSX::ZIndexedReader reader(file);
+        reader.setSpan(65536);
+        reader.buildIndex();
+        reader.saveIndex(index);
+        reader.close();
+    }
+    PCSX::ZIndexedReader reader(file);
+    reader.setSpan(65536);
+    index->rSeek(0, SEEK_SET);
+    ASSERT_TRUE(reader.loadIndex(index));
+    // The size comes from the index, without inflating anything.
+    EXPECT_EQ(reader.size(), data.size());
+    checkRandomReads(&reader, data);
+    reader.close();
+
+    // An index for a different stream is rejected.
+    auto other = compress(makeData(1024 * 1024), MAX_WBITS + 16);
+    PCSX::IO<PCSX::File> otherFile(new PCSX::BufferFile(other.data(), other.size()));
+    PCSX::ZIndexedReader otherReader(otherFile);
+    index->rSeek(0, SEEK_SET);
+    EXPECT_FALSE(otherReader.loadIndex(index));
+    otherReader.close();
+}
+
+TEST(ZIndexedReader, TruncatedStream) {
+    auto data = makeData(1024 * 1024);
+    auto compressed = compress(data, MAX_WBITS);
+    compressed.resize(compressed.size() / 2);
+    PCSX::IO<PCSX::File> file(new PCSX::BufferFile(compressed.data(), compressed.size()));
+    PCSX::ZIndexedReader reader(file);
+    std::vector<uint8_t> out(data.size());
+    ssize_t r = reader.read(out.data(), out.size());
+    EXPECT_LT(r, ssize_t(data.size()));
+    EXPECT_TRUE(reader.failed());
+    reader.close();
+}
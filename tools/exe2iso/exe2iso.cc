@@ -19,9 +19,10 @@
 
 #include <stdint.h>
 
+#include <vector>
+
 #include "flags.h"
 #include "fmt/format.h"
-#include "iec-60908b/edcecc.h"
 #include "support/file.h"
 #include "supportpsx/iec-60908b.h"
 
@@ -146,7 +147,7 @@ Usage: {} input.ps-exe [-offset value] [-pad] [-regen] [-license file] -o output
                 memset(sector, 0, sizeof(sector));
                 memcpy(sector + 16, licenseData + 2336 * i, 2336);
                 makeHeader(sector, i);
-                if (regen) compute_edcecc(sector);
+                if (regen) PCSX::IEC60908b::computeEDCECC(sector);
                 out->write(sector, sizeof(sector));
             }
             wroteLicense = true;
@@ -155,7 +156,7 @@ Usage: {} input.ps-exe [-offset value] [-pad] [-regen] [-license file] -o output
             for (unsigned i = 0; i < 16; i++) {
                 memcpy(sector, licenseData + 2352 * i, 2352);
                 makeHeader(sector, i);
-                if (regen) compute_edcecc(sector);
+                if (regen) PCSX::IEC60908b::computeEDCECC(sector);
                 out->write(sector, sizeof(sector));
             }
             wroteLicense = true;
@@ -167,7 +168,7 @@ Usage: {} input.ps-exe [-offset value] [-pad] [-regen] [-license file] -o output
         for (unsigned i = 0; i < 16; i++) {
             memset(sector, 0, sizeof(sector));
             makeHeader(sector, i);
-            if (regen) compute_edcecc(sector);
+            if (regen) PCSX::IEC60908b::computeEDCECC(sector);
             out->write(sector, sizeof(sector));
         }
     }
@@ -179,31 +180,33 @@ Usage: {} input.ps-exe [-offset value] [-pad] [-regen] [-license file] -o output
         // This function will fill the sector with the right data, as
         // necessary for the PS1 bios.
         getSector(sector + 24, i, exeSize, exeOffset);
-        if (regen) compute_edcecc(sector);
+        if (regen) PCSX::IEC60908b::computeEDCECC(sector);
         out->write(sector, sizeof(sector));
     }
     // Potential padding before the start of the exe.
     for (unsigned i = 19; i < exeOffset; i++) {
         memset(sector, 0, sizeof(sector));
         makeHeader(sector, i);
-        if (regen) compute_edcecc(sector);
+        if (regen) PCSX::IEC60908b::computeEDCECC(sector);
         out->write(sector, sizeof(sector));
     }
     unsigned LBA = exeOffset;
-    // The actual exe.
+    // The actual exe. It's the bulk of the output, so its sectors are built
+    // all at once, and the EDC/ECC gets computed over the whole batch.
+    std::vector<uint8_t> exeSectors(exeSize / 2048 * 2352);
     for (unsigned i = 0; i < exeSize; i += 2048) {
-        memset(sector, 0, sizeof(sector));
-        makeHeader(sector, LBA++);
-        file->read(sector + 24, 2048);
-        if (regen) compute_edcecc(sector);
-        out->write(sector, sizeof(sector));
+        uint8_t* exeSector = exeSectors.data() + i / 2048 * 2352;
+        makeHeader(exeSector, LBA++);
+        file->read(exeSector + 24, 2048);
     }
+    if (regen) PCSX::IEC60908b::computeEDCECC(exeSectors.data(), exeSize / 2048);
+    out->write(exeSectors.data(), exeSectors.size());
     if (pad) {
         // 150 sectors padding.
         for (unsigned i = 0; i < 150; i++) {
             memset(sector, 0, sizeof(sector));
             makeHeader(sector, LBA++);
-            if (regen) compute_edcecc(sector);
+            if (regen) PCSX::IEC60908b::computeEDCECC(sector);
             out->write(sector, sizeof(sector));
         }
     }
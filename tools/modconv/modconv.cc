@@ -19,8 +19,9 @@
 
 #include <algorithm>
 #include <cctype>
-#include <memory>
+#include <span>
 #include <string_view>
+#include <vector>
 
 #include "flags.h"
 #include "fmt/format.h"
@@ -139,9 +140,21 @@ both the pattern and sample data.
 
     constexpr uint8_t silentLoopBlock[16] = {0, 7, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 
-    std::unique_ptr<PCSX::ADPCM::Encoder> encoder(new PCSX::ADPCM::Encoder);
+    // All of the samples are read first, so they can be encoded in parallel, as
+    // they are independent from each other.
+    std::vector<std::vector<int16_t>> pcmSamples(31);
+    for (unsigned i = 0; i < 31; i++) {
+        auto length = modFile.get<ModSamples>()[i].get<SampleLength>().value;
+        if (length == 0) continue;
+        file->skip<uint16_t>();
+        auto& pcm = pcmSamples[i];
+        pcm.resize((length - 1) * 2);
+        for (auto& p : pcm) p = int16_t(file->read<int8_t>()) * amplification;
+    }
+    std::vector<std::span<const int16_t>> pcmSpans(pcmSamples.begin(), pcmSamples.end());
+    auto spuSamples = PCSX::ADPCM::Encoder::processSPUBatch(pcmSpans);
+
     for (unsigned i = 0; i < 31; i++) {
-        encoder->reset();
         auto& sample = modFile.get<ModSamples>()[i];
         fmt::print("Sample {:2} [{:22}] - ", i + 1, sample.get<SampleName>().value);
         auto length = sample.get<SampleLength>().value;
@@ -152,46 +165,25 @@ both the pattern and sample data.
             fmt::print("Empty\n");
             continue;
         }
-        int16_t input[28];
-        uint8_t spuBlock[16];
-        file->skip<uint16_t>();
-        length--;
-        length *= 2;
+        auto& spuSample = spuSamples[i];
+        size_t pcmLength = pcmSamples[i].size();
         unsigned position = 2;
         loopStart *= 2;
-        unsigned loopEnd = loopStart + loopLength * 2;
         unsigned encodedLength = 0;
-        while (length >= 28) {
-            for (unsigned j = 0; j < 28; j++) {
-                input[j] = int16_t(file->read<int8_t>()) * amplification;
-            }
-            length -= 28;
-            encoder->processSPUBlock(input, spuBlock, PCSX::ADPCM::Encoder::BlockAttribute::OneShot);
+        for (size_t b = 0; b < spuSample.size() / 16; b++) {
+            uint8_t* spuBlock = spuSample.data() + b * 16;
             uint8_t blockAttribute = 0;
-            if (length == 0) {
-                blockAttribute |= 1;
-            }
-            if (hasLoop && (loopStart <= position)) {
-                blockAttribute |= 2;
-                if (position < (loopStart + 28)) {
-                    blockAttribute |= 4;
+            if ((b + 1) * 28 <= pcmLength) {
+                if ((b + 1) * 28 == pcmLength) {
+                    blockAttribute |= 1;
                 }
-            }
-            spuBlock[1] = blockAttribute;
-            position += 28;
-            encodedSamples->write(spuBlock, 16);
-            encodedLength += 16;
-        }
-        if (length != 0) {
-            for (unsigned j = 0; j < length; j++) {
-                input[j] = int16_t(file->read<int8_t>()) * amplification;
-            }
-            for (unsigned j = length; j < 28; j++) {
-                input[j] = 0;
-            }
-            encoder->processSPUBlock(input, spuBlock, PCSX::ADPCM::Encoder::BlockAttribute::OneShot);
-            uint8_t blockAttribute = 0;
-            if (hasLoop) {
+                if (hasLoop && (loopStart <= position)) {
+                    blockAttribute |= 2;
+                    if (position < (loopStart + 28)) {
+                        blockAttribute |= 4;
+                    }
+                }
+            } else if (hasLoop) {
                 blockAttribute = 3;
                 if (position < (loopStart + 28)) {
                     blockAttribute |= 4;
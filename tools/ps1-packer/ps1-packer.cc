@@ -19,6 +19,8 @@
 
 #include "supportpsx/ps1-packer.h"
 
+#include <chrono>
+
 #include "flags.h"
 #include "fmt/format.h"
 #include "support/file.h"
@@ -47,10 +49,12 @@ https://github.com/grumpycoders/pcsx-redux/tree/main/tools/ps1-packer/
     const bool rom = args.get<bool>("rom").value_or(false);
     const bool cpe = args.get<bool>("cpe").value_or(false);
     const bool nopad = args.get<bool>("nopad").value_or(false);
+    const bool parallel = args.get<bool>("parallel").value_or(false);
+    const bool bench = args.get<bool>("bench").value_or(false);
     unsigned outputTypeCount = (raw ? 1 : 0) + (booty ? 1 : 0) + (rom ? 1 : 0) + (cpe ? 1 : 0);
     if (asksForHelp || !oneInput || !hasOutput || (outputTypeCount > 1)) {
         fmt::print(R"(
-Usage: {} input.ps-exe [-h] [-tload addr] [-shell] [-nokernel] [-resetstack] [-raw | -booty | -rom | -cpe] -o output.ps-exe
+Usage: {} input.ps-exe [-h] [-tload addr] [-shell] [-nokernel] [-resetstack] [-parallel] [-bench] [-raw | -booty | -rom | -cpe] -o output.ps-exe
   input.ps-exe      mandatory: specify the input binary file.
   -o output.ps-exe  mandatory: name of the output file.
   -h                displays this help information and exit.
@@ -59,6 +63,8 @@ Usage: {} input.ps-exe [-h] [-tload addr] [-shell] [-nokernel] [-resetstack] [-r
   -nokernel         avoids calling into the kernel.
   -resetstack       resets the stack pointer to the top of the memory.
   -nopad            disables padding of the output file to 2048 bytes. Only for PS-EXE output.
+  -parallel         uses the experimental parallel compressor instead of the ucl one.
+  -bench            compresses using both compressors, and displays their ratio and timings.
 
 These options control the output format, and are mutually exclusive:
   -raw              outputs a raw file.
@@ -107,6 +113,24 @@ Valid input binary files can be in the following formats:
     options.nokernel = nokernel;
     options.tload = tload;
     options.nopad = nopad;
+    options.parallel = parallel;
+
+    if (bench) {
+        auto src = [&memory]() { return new PCSX::SubFile(memory, memory->lowestAddress(), memory->actualSize()); };
+        for (bool useParallel : {false, true}) {
+            PCSX::IO<PCSX::File> result(new PCSX::BufferFile(PCSX::FileOps::READWRITE));
+            options.parallel = useParallel;
+            auto start = std::chrono::steady_clock::now();
+            PCSX::PS1Packer::pack(src(), result, memory->lowestAddress(), info.pc.value_or(0), info.gp.value_or(0),
+                                  info.sp.value_or(0), options);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            fmt::print("{:>9}: {} -> {} bytes ({:.2f}%) in {:.3f}s\n", useParallel ? "parallel" : "ucl",
+                       memory->actualSize(), result->size(), 100.0 * result->size() / memory->actualSize(),
+                       elapsed.count());
+        }
+        options.parallel = parallel;
+    }
+
     PCSX::IO<PCSX::File> out(new PCSX::PosixFile(output.value().c_str(), PCSX::FileOps::TRUNCATE));
     PCSX::PS1Packer::pack(new PCSX::SubFile(memory, memory->lowestAddress(), memory->actualSize()), out,
                           memory->lowestAddress(), info.pc.value_or(0), info.gp.value_or(0), info.sp.value_or(0),